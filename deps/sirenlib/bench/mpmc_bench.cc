@@ -0,0 +1,138 @@
+// MpmcQueue vs BlockingQueue over a producers x consumers matrix.
+//
+// Every producer puts <items> integers with the blocking put(), consumers
+// take() until they have seen all of them. "spin" uses tryPut()/tryTake()
+// in a yield loop, the non-blocking path. Reports million items per second
+// through the queue for each pair.
+//
+//   ./mpmc_bench [-p 1,2,4,8] [-c 1,2,4,8] [-n items] [-q capacity]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "siren/base/BlockingQueue.h"
+#include "siren/base/MpmcQueue.h"
+
+using namespace siren;
+
+namespace {
+
+int g_items = 1000000;
+size_t g_capacity = 1024;
+std::vector<int> g_producers = {1, 2, 4, 8};
+std::vector<int> g_consumers = {1, 2, 4, 8};
+
+enum Mode { kBlockingQueue, kMpmcBlocking, kMpmcSpin };
+
+// consumers stop on a negative item, one per consumer after the producers
+template <typename Queue>
+void put(Queue& queue, Mode mode, int x) {
+    if (mode == kMpmcSpin) {
+        while (!queue.tryPut(x)) std::this_thread::yield();
+    } else {
+        queue.put(x);
+    }
+}
+
+template <typename Queue>
+int take(Queue& queue, Mode mode) {
+    if (mode == kMpmcSpin) {
+        int x;
+        while (!queue.tryTake(x)) std::this_thread::yield();
+        return x;
+    }
+    return queue.take();
+}
+
+template <typename Queue>
+double run(Queue& queue, Mode mode, int producers, int consumers) {
+    std::atomic<long long> sum(0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            long long local = 0;
+            for (;;) {
+                int x = take(queue, mode);
+                if (x < 0) break;
+                local += x;
+            }
+            sum.fetch_add(local, std::memory_order_relaxed);
+        });
+    }
+    std::vector<std::thread> producing;
+    for (int p = 0; p < producers; ++p) {
+        producing.emplace_back([&, p] {
+            for (int i = p; i < g_items; i += producers) put(queue, mode, i);
+        });
+    }
+    for (std::thread& t : producing) t.join();
+    for (int c = 0; c < consumers; ++c) put(queue, mode, -1);
+    for (std::thread& t : threads) t.join();
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sum.load() != static_cast<long long>(g_items) * (g_items - 1) / 2) {
+        fprintf(stderr, "lost items\n");
+        _exit(1);
+    }
+    return g_items / seconds / 1e6;
+}
+
+// BlockingQueue has no tryPut/tryTake, the spin mode never uses them on it
+struct Blocking : BlockingQueue<int> {
+    bool tryPut(int) { return false; }
+    bool tryTake(int&) { return false; }
+};
+
+void parseList(const char* arg, std::vector<int>* list) {
+    list->clear();
+    std::string s(arg);
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        int n = atoi(s.substr(pos, comma - pos).c_str());
+        if (n > 0) list->push_back(n);
+        pos = comma + 1;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "p:c:n:q:")) != -1) {
+        switch (opt) {
+            case 'p': parseList(optarg, &g_producers); break;
+            case 'c': parseList(optarg, &g_consumers); break;
+            case 'n': g_items = std::max(1, atoi(optarg)); break;
+            case 'q': g_capacity = static_cast<size_t>(std::max(2, atoi(optarg))); break;
+            default:
+                fprintf(stderr, "see the header of mpmc_bench.cc for options\n");
+                return 1;
+        }
+    }
+    printf("%u cpus, %d items, MpmcQueue capacity %zu\n", std::thread::hardware_concurrency(),
+           g_items, MpmcQueue<int>(g_capacity).capacity());
+    printf("%4s %4s  %14s %14s %14s\n", "prod", "cons", "BlockingQueue", "Mpmc put/take",
+           "Mpmc tryPut");
+    for (int producers : g_producers) {
+        for (int consumers : g_consumers) {
+            Blocking blocking;
+            MpmcQueue<int> mpmc(g_capacity);
+            double b = run(blocking, kBlockingQueue, producers, consumers);
+            double m = run(mpmc, kMpmcBlocking, producers, consumers);
+            double s = run(mpmc, kMpmcSpin, producers, consumers);
+            printf("%4d %4d  %10.2f M/s %10.2f M/s %10.2f M/s\n", producers, consumers, b, m, s);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
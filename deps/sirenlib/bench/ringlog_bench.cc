@@ -0,0 +1,148 @@
+// Caller-side cost of a log call, spdlog's async logger with the block
+// overflow policy vs RingLogSink, with a fast and with a slow disk.
+//
+// <threads> threads each log <count> info lines shaped like
+// TcpServer::newConnection's. "fast" writes to /dev/null; "slow" writes
+// into a pipe whose reader takes <rate> KiB per second, a stand-in for a
+// disk that cannot keep up. Reports per-call latency on the logging threads
+// and how many records the ring backend dropped.
+//
+//   ./ringlog_bench [-t threads] [-n count] [-r rate_kib]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/spdlog.h>
+
+#include "siren/base/RingLogSink.h"
+
+using namespace siren;
+
+namespace {
+
+int g_threads = 4;
+int g_count = 200000;
+int g_rateKib = 2048;
+
+// drains a pipe at about g_rateKib per second, then at full speed until
+// every writer has closed it
+class SlowReader {
+   public:
+    SlowReader() : throttled_(true) {
+        if (::pipe(fds_) != 0) abort();
+        thread_ = std::thread([this] {
+            char buf[4096];
+            const auto pause = std::chrono::microseconds(4 * 1000000LL / std::max(1, g_rateKib));
+            while (::read(fds_[0], buf, sizeof buf) > 0) {
+                if (throttled_.load(std::memory_order_relaxed)) std::this_thread::sleep_for(pause);
+            }
+        });
+    }
+    ~SlowReader() {
+        throttled_ = false;
+        ::close(fds_[1]);
+        thread_.join();
+        ::close(fds_[0]);
+    }
+    std::string path() const { return "/dev/fd/" + std::to_string(fds_[1]); }
+
+   private:
+    int fds_[2];
+    std::atomic<bool> throttled_;
+    std::thread thread_;
+};
+
+void run(const char* name, spdlog::logger& logger, const RingLogBackend* backend) {
+    std::vector<std::vector<int64_t>> perThread(g_threads);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < g_threads; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<int64_t>& samples = perThread[t];
+            samples.reserve(g_count);
+            for (int i = 0; i < g_count; ++i) {
+                auto before = std::chrono::steady_clock::now();
+                logger.info("TcpServer::newConnection [{}] - new connection [{}-127.0.0.1:{}#{}] from 127.0.0.1:{}",
+                            "bench", "bench", 2007, i, 40000 + t);
+                samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - before)
+                                      .count());
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int64_t> all;
+    for (auto& samples : perThread) all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+    double sum = 0;
+    for (int64_t v : all) sum += static_cast<double>(v);
+    auto pct = [&](double p) {
+        return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))] / 1000.0;
+    };
+    printf("  %-22s %8.0f calls/s  avg %8.2f us  p99 %8.2f us  max %9.2f us", name,
+           all.size() / seconds, sum / all.size() / 1000.0, pct(0.99), all.back() / 1000.0);
+    if (backend != nullptr) {
+        printf("  dropped %llu", static_cast<unsigned long long>(backend->dropped()));
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+void runSpdlog(const char* name, const std::string& path) {
+    auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path);
+    // async_logger hands itself to the pool with shared_from_this()
+    auto logger = std::make_shared<spdlog::async_logger>("async", sink, spdlog::thread_pool(),
+                                                         spdlog::async_overflow_policy::block);
+    run(name, *logger, nullptr);
+}
+
+void runRing(const char* name, const std::string& path) {
+    auto backend = std::make_shared<RingLogBackend>(path);
+    backend->start();
+    spdlog::logger logger("ring", std::make_shared<RingLogSink>(backend));
+    run(name, logger, backend.get());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "t:n:r:")) != -1) {
+        switch (opt) {
+            case 't': g_threads = std::max(1, atoi(optarg)); break;
+            case 'n': g_count = std::max(1, atoi(optarg)); break;
+            case 'r': g_rateKib = std::max(1, atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of ringlog_bench.cc for options\n");
+                return 1;
+        }
+    }
+    // the queue size spdlog's default thread pool has
+    spdlog::init_thread_pool(8192, 1);
+    printf("%d threads x %d records, slow reader %d KiB/s\n", g_threads, g_count, g_rateKib);
+    printf("fast (/dev/null):\n");
+    runSpdlog("spdlog async, block", "/dev/null");
+    runRing("RingLogSink", "/dev/null");
+    printf("slow (pipe):\n");
+    {
+        SlowReader reader;
+        runSpdlog("spdlog async, block", reader.path());
+    }
+    {
+        SlowReader reader;
+        runRing("RingLogSink", reader.path());
+    }
+    return 0;
+}
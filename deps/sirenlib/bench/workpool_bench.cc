@@ -0,0 +1,161 @@
+// WorkStealingPool vs a BlockingQueue shared by the same number of threads.
+//
+// flat: one outside thread submits <tasks> tasks of <work> spin iterations.
+// fork: a binary tree of <depth> levels, every task submits its two
+//       children from inside the pool, the shape of recursive splitting.
+// Reports tasks per second for each thread count.
+//
+//   ./workpool_bench [-t 1,2,4,8,16] [-n tasks] [-w work] [-d depth]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "siren/base/BlockingQueue.h"
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/WorkStealingPool.h"
+
+using namespace siren;
+
+namespace {
+
+int g_tasks = 200000;
+int g_work = 200;
+int g_depth = 16;
+std::vector<int> g_threads = {1, 2, 4, 8, 16};
+
+std::atomic<uint64_t> g_sink(0);
+
+void spin(int iterations) {
+    uint64_t x = 0;
+    for (int i = 0; i < iterations; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    g_sink.fetch_add(x & 1, std::memory_order_relaxed);
+}
+
+// the mutex+condvar pool this replaces
+class QueuePool {
+   public:
+    typedef std::function<void()> Task;
+
+    explicit QueuePool(int threads) {
+        for (int i = 0; i < threads; ++i) {
+            threads_.emplace_back([this] {
+                for (;;) {
+                    Task task = queue_.take();
+                    if (!task) break;
+                    task();
+                }
+            });
+        }
+    }
+    ~QueuePool() {
+        for (size_t i = 0; i < threads_.size(); ++i) queue_.put(Task());
+        for (std::thread& t : threads_) t.join();
+    }
+    void submit(Task task) { queue_.put(std::move(task)); }
+
+   private:
+    BlockingQueue<Task> queue_;
+    std::vector<std::thread> threads_;
+};
+
+template <typename Pool>
+double runFlat(Pool& pool) {
+    std::atomic<int> remaining(g_tasks);
+    CountDownLatch done(1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < g_tasks; ++i) {
+        pool.submit([&] {
+            spin(g_work);
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) done.countDown();
+        });
+    }
+    done.wait();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Pool>
+void forkNode(Pool& pool, int depth, std::atomic<int>& remaining, CountDownLatch& done) {
+    spin(g_work);
+    if (depth > 1) {
+        for (int k = 0; k < 2; ++k) {
+            pool.submit([&pool, depth, &remaining, &done] {
+                forkNode(pool, depth - 1, remaining, done);
+            });
+        }
+    }
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) done.countDown();
+}
+
+template <typename Pool>
+double runFork(Pool& pool, int* nodes) {
+    *nodes = (1 << g_depth) - 1;
+    std::atomic<int> remaining(*nodes);
+    CountDownLatch done(1);
+    auto start = std::chrono::steady_clock::now();
+    pool.submit([&] { forkNode(pool, g_depth, remaining, done); });
+    done.wait();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void parseThreads(const char* arg) {
+    g_threads.clear();
+    std::string list(arg);
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        int n = atoi(list.substr(pos, comma - pos).c_str());
+        if (n > 0) g_threads.push_back(n);
+        pos = comma + 1;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "t:n:w:d:")) != -1) {
+        switch (opt) {
+            case 't': parseThreads(optarg); break;
+            case 'n': g_tasks = std::max(1, atoi(optarg)); break;
+            case 'w': g_work = std::max(0, atoi(optarg)); break;
+            case 'd': g_depth = std::max(1, std::min(24, atoi(optarg))); break;
+            default:
+                fprintf(stderr, "see the header of workpool_bench.cc for options\n");
+                return 1;
+        }
+    }
+    printf("%u cpus, work %d\n", std::thread::hardware_concurrency(), g_work);
+    printf("%7s  %16s %16s  %16s %16s\n", "threads", "flat queue", "flat stealing",
+           "fork queue", "fork stealing");
+    for (int threads : g_threads) {
+        int nodes = 0;
+        double flatQueue, forkQueue, flatSteal, forkSteal;
+        {
+            QueuePool pool(threads);
+            flatQueue = runFlat(pool);
+            forkQueue = runFork(pool, &nodes);
+        }
+        {
+            WorkStealingPool pool("bench");
+            pool.start(threads);
+            flatSteal = runFlat(pool);
+            forkSteal = runFork(pool, &nodes);
+        }
+        printf("%7d  %12.0f t/s %12.0f t/s  %12.0f t/s %12.0f t/s\n", threads,
+               g_tasks / flatQueue, g_tasks / flatSteal, nodes / forkQueue, nodes / forkSteal);
+        fflush(stdout);
+    }
+    return g_sink.load() == 42 ? 1 : 0;
+}
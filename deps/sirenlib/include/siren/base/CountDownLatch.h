@@ -1,9 +1,16 @@
 #pragma once
 
-#include <mutex>
-#include<condition_variable>
+#include <atomic>
+#include <cstdint>
 
 namespace siren {
+/**
+ * @brief One-shot latch on a futex word.
+ *
+ * countDown() is a CAS and only enters the kernel when the count reaches
+ * zero while someone is waiting, wait() returns without a syscall once it
+ * is zero. The count never goes below zero.
+ */
 class CountDownLatch {
 public:
     explicit CountDownLatch(int count);
@@ -12,8 +19,10 @@ public:
     int getCount() const;
 
 private:
-    mutable std::mutex mutex_;
-    std::condition_variable condition_;
-    int count_;
+    // low 31 bits are the count, the top bit says a waiter may be asleep
+    static const uint32_t kWaiters = 1u << 31;
+    static const uint32_t kCountMask = kWaiters - 1;
+
+    std::atomic<uint32_t> state_;
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "siren/base/Futex.h"
+#include "siren/base/noncopyable.h"
+
+namespace siren {
+
+/**
+ * @brief Manual-reset event on a futex word.
+ *
+ * set() publishes everything written before it to the threads returning
+ * from wait(). It only makes a syscall when a waiter has gone to sleep,
+ * and wait() on a set event is a single load.
+ */
+class Event : noncopyable {
+   public:
+    Event() : state_(kUnset) {}
+
+    void set() {
+        if (state_.exchange(kSet, std::memory_order_release) == kWaiting) {
+            futexWakeAll(&state_);
+        }
+    }
+
+    void wait() {
+        uint32_t state = state_.load(std::memory_order_acquire);
+        while (state != kSet) {
+            if (state == kUnset &&
+                !state_.compare_exchange_weak(state, kWaiting, std::memory_order_acquire)) {
+                continue;
+            }
+            futexWait(&state_, kWaiting);
+            state = state_.load(std::memory_order_acquire);
+        }
+    }
+
+    bool isSet() const { return state_.load(std::memory_order_acquire) == kSet; }
+
+    /// Not thread safe, nobody may be waiting.
+    void reset() { state_.store(kUnset, std::memory_order_relaxed); }
+
+   private:
+    static const uint32_t kUnset = 0;
+    static const uint32_t kWaiting = 1;
+    static const uint32_t kSet = 2;
+
+    std::atomic<uint32_t> state_;
+};
+
+}  // namespace siren
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+
+namespace siren {
+
+/**
+ * @brief Thin wrappers of futex(2) on a 32-bit atomic word.
+ *
+ * Private futexes, the word must not be shared across processes.
+ */
+
+/// Sleeps while *word == expected. Returns on a wake, on a value change
+/// before sleeping, on a signal or after @c timeout (nullptr waits forever);
+/// callers re-check their condition either way.
+inline void futexWait(std::atomic<uint32_t>* word, uint32_t expected,
+                      const struct timespec* timeout = nullptr) {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word is 32 bits");
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE, expected,
+              timeout, nullptr, 0);
+}
+
+/// Wakes up to @c count sleepers on @c word.
+inline void futexWake(std::atomic<uint32_t>* word, int count = 1) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE, count, nullptr,
+              nullptr, 0);
+}
+
+inline void futexWakeAll(std::atomic<uint32_t>* word) {
+    futexWake(word, INT_MAX);
+}
+
+}  // namespace siren
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "siren/base/noncopyable.h"
+
+namespace siren {
+
+/**
+ * @brief Spin-then-park mutex on a futex word.
+ *
+ * Ulrich Drepper's three-state mutex from "Futexes Are Tricky": an
+ * uncontended lock/unlock is one atomic each way with no syscall. A
+ * contended lock spins a little, since critical sections here are short,
+ * then sleeps in the kernel; unlock only wakes when someone may be asleep.
+ * Meets BasicLockable, so std::lock_guard and std::unique_lock work.
+ * Smaller than std::mutex (4 bytes) but not recursive and not fair.
+ */
+class FutexMutex : noncopyable {
+   public:
+    FutexMutex() : state_(kUnlocked) {}
+
+    void lock() {
+        uint32_t expected = kUnlocked;
+        if (!state_.compare_exchange_strong(expected, kLocked, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+            lockSlow();
+        }
+    }
+
+    bool try_lock() {
+        uint32_t expected = kUnlocked;
+        return state_.compare_exchange_strong(expected, kLocked, std::memory_order_acquire,
+                                              std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        if (state_.exchange(kUnlocked, std::memory_order_release) == kContended) {
+            wakeOne();
+        }
+    }
+
+   private:
+    static const uint32_t kUnlocked = 0;
+    static const uint32_t kLocked = 1;
+    static const uint32_t kContended = 2;  // locked, and a waiter may sleep
+
+    void lockSlow();
+    void wakeOne();
+
+    std::atomic<uint32_t> state_;
+};
+
+}  // namespace siren
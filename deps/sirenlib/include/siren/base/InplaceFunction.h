@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace siren {
+
+template <typename Signature, size_t Capacity = 48>
+class InplaceFunction;
+
+/**
+ * @brief Move-only std::function with a fixed inline buffer.
+ *
+ * Callables up to Capacity bytes are stored in the object itself, so a
+ * queueInLoop(std::bind(&X::f, shared_from_this())) never allocates.
+ * libstdc++'s std::function only keeps two pointers inline. Bigger
+ * callables still work, they go to the heap like std::function does.
+ *
+ * @tparam Capacity inline bytes. The default 48 fits a bound std::function
+ * plus a shared_ptr, and with the vtable pointer the object is one cache line.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+    static_assert(Capacity >= sizeof(void*), "room for the heap pointer");
+
+   public:
+    static const size_t kCapacity = Capacity;
+
+    /// true if F is stored without an allocation
+    template <typename F>
+    static constexpr bool storedInline() {
+        return sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+    InplaceFunction() noexcept : vtable_(nullptr) {}
+    InplaceFunction(std::nullptr_t) noexcept : vtable_(nullptr) {}
+
+    template <typename F,
+              typename D = typename std::decay<F>::type,
+              typename = typename std::enable_if<
+                  !std::is_same<D, InplaceFunction>::value &&
+                  std::is_invocable_r<R, D&, Args...>::value>::type>
+    InplaceFunction(F&& f) : vtable_(nullptr) {
+        // a function reference decays to a pointer but can never be null
+        using Held = typename std::remove_cv<typename std::remove_reference<F>::type>::type;
+        if constexpr (std::is_pointer<Held>::value || std::is_member_pointer<Held>::value ||
+                      IsStdFunction<Held>::value) {
+            if (!f) return;  // stays empty, like std::function
+        }
+        if constexpr (storedInline<D>()) {
+            ::new (storage_) D(std::forward<F>(f));
+            vtable_ = &Inline<D>::kVTable;
+        } else {
+            *reinterpret_cast<D**>(storage_) = new D(std::forward<F>(f));
+            vtable_ = &Heap<D>::kVTable;
+        }
+    }
+
+    InplaceFunction(InplaceFunction&& rhs) noexcept : vtable_(rhs.vtable_) {
+        if (vtable_) {
+            vtable_->move(storage_, rhs.storage_);
+            rhs.vtable_ = nullptr;
+        }
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& rhs) noexcept {
+        if (this != &rhs) {
+            reset();
+            if (rhs.vtable_) {
+                rhs.vtable_->move(storage_, rhs.storage_);
+                vtable_ = rhs.vtable_;
+                rhs.vtable_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction&) = delete;
+    InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+    ~InplaceFunction() { reset(); }
+
+    explicit operator bool() const noexcept { return vtable_ != nullptr; }
+
+    /// const like std::function's, the target itself may be mutable
+    R operator()(Args... args) const {
+        if (!vtable_) throw std::bad_function_call();
+        return vtable_->invoke(const_cast<unsigned char*>(storage_), std::forward<Args>(args)...);
+    }
+
+    void swap(InplaceFunction& rhs) noexcept {
+        InplaceFunction tmp(std::move(rhs));
+        rhs = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+   private:
+    struct VTable {
+        R (*invoke)(void* storage, Args&&... args);
+        // move constructs into dst and destroys src
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename T>
+    struct IsStdFunction : std::false_type {};
+    template <typename S>
+    struct IsStdFunction<std::function<S>> : std::true_type {};
+
+    template <typename F>
+    struct Inline {
+        static R invoke(void* storage, Args&&... args) {
+            return std::invoke(*static_cast<F*>(storage), std::forward<Args>(args)...);
+        }
+        static void move(void* dst, void* src) noexcept {
+            ::new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        }
+        static void destroy(void* storage) noexcept { static_cast<F*>(storage)->~F(); }
+        static constexpr VTable kVTable = {&invoke, &move, &destroy};
+    };
+
+    template <typename F>
+    struct Heap {
+        static R invoke(void* storage, Args&&... args) {
+            return std::invoke(**static_cast<F**>(storage), std::forward<Args>(args)...);
+        }
+        static void move(void* dst, void* src) noexcept {
+            *static_cast<F**>(dst) = *static_cast<F**>(src);
+        }
+        static void destroy(void* storage) noexcept { delete *static_cast<F**>(storage); }
+        static constexpr VTable kVTable = {&invoke, &move, &destroy};
+    };
+
+    void reset() noexcept {
+        if (vtable_) {
+            vtable_->destroy(storage_);
+            vtable_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[Capacity];
+    const VTable* vtable_;
+};
+
+template <typename R, typename... Args, size_t Capacity>
+const size_t InplaceFunction<R(Args...), Capacity>::kCapacity;
+
+}  // namespace siren
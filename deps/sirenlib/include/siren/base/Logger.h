@@ -7,15 +7,41 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/spdlog.h>
 #include <fmt/std.h>
+#include <atomic>
 #include "spdlog/sinks/rotating_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+// Compile-time level filter, the same numbering as spdlog::level. LOG_*
+// calls below SIREN_ACTIVE_LEVEL expand to dead code: their arguments are
+// never evaluated, but still compiled, so a variable only logged stays used
+// and format strings stay checked. Set it with -DSIREN_ACTIVE_LEVEL=<n> (the CMake cache
+// variable of the same name); LOG_TRACE is compiled out by default, debug
+// and above can still be switched at runtime with set_level().
+#define SIREN_LEVEL_TRACE 0
+#define SIREN_LEVEL_DEBUG 1
+#define SIREN_LEVEL_INFO 2
+#define SIREN_LEVEL_WARN 3
+#define SIREN_LEVEL_ERROR 4
+#define SIREN_LEVEL_CRITICAL 5
+#define SIREN_LEVEL_OFF 6
+
+#ifndef SIREN_ACTIVE_LEVEL
+#define SIREN_ACTIVE_LEVEL SIREN_LEVEL_DEBUG
+#endif
+
 class Logger {
    public:
     static Logger &getInstance();
 
     spdlog::logger &getLogger();
 
+    /// The logger behind LOG_*. After the first call it is a single load,
+    /// no function-local static guard.
+    static spdlog::logger *handle() {
+        spdlog::logger *logger = handle_.load(std::memory_order_acquire);
+        return logger != nullptr ? logger : &getInstance().getLogger();
+    }
+
    private:
     Logger();
     
@@ -24,25 +50,53 @@ class Logger {
     void useASyncLogger();
 
     std::shared_ptr<spdlog::logger> logger_;
+    static inline std::atomic<spdlog::logger *> handle_{nullptr};
 };
 
 // 在任何地方使用日志记录器
+// The runtime level is checked before the arguments are evaluated, so a
+// disabled LOG_DEBUG costs one relaxed load and a compare.
+#define SIREN_LOG_(level, ...)                                         \
+    do {                                                               \
+        spdlog::logger *sirenLogger_ = Logger::handle();               \
+        if (sirenLogger_->should_log(level)) {                         \
+            sirenLogger_->log(level, __VA_ARGS__);                     \
+        }                                                              \
+    } while (0)
 
-#define ASYNC_LOGGER
-#ifdef ASYNC_LOGGER
-#define LOG_TRACE(...) Logger::getInstance().getLogger().trace(__VA_ARGS__)
-#define LOG_DEBUG(...) Logger::getInstance().getLogger().debug(__VA_ARGS__)
-#define LOG_INFO(...) Logger::getInstance().getLogger().info(__VA_ARGS__)
-#define LOG_WARN(...) Logger::getInstance().getLogger().warn(__VA_ARGS__)
-#define LOG_CRITICAL(...) \
-    Logger::getInstance().getLogger().critical(__VA_ARGS__)
-#define LOG_ERROR(...) Logger::getInstance().getLogger().error(__VA_ARGS__)
+// a compiled-out level: odr-uses the arguments without evaluating them
+#define SIREN_LOG_DISABLED_(level, ...)                                \
+    do {                                                               \
+        if (false) SIREN_LOG_(level, __VA_ARGS__);                     \
+    } while (0)
+
+#if SIREN_ACTIVE_LEVEL <= SIREN_LEVEL_TRACE
+#define LOG_TRACE(...) SIREN_LOG_(spdlog::level::trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) SIREN_LOG_DISABLED_(spdlog::level::trace, __VA_ARGS__)
+#endif
+#if SIREN_ACTIVE_LEVEL <= SIREN_LEVEL_DEBUG
+#define LOG_DEBUG(...) SIREN_LOG_(spdlog::level::debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) SIREN_LOG_DISABLED_(spdlog::level::debug, __VA_ARGS__)
+#endif
+#if SIREN_ACTIVE_LEVEL <= SIREN_LEVEL_INFO
+#define LOG_INFO(...) SIREN_LOG_(spdlog::level::info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) SIREN_LOG_DISABLED_(spdlog::level::info, __VA_ARGS__)
+#endif
+#if SIREN_ACTIVE_LEVEL <= SIREN_LEVEL_WARN
+#define LOG_WARN(...) SIREN_LOG_(spdlog::level::warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) SIREN_LOG_DISABLED_(spdlog::level::warn, __VA_ARGS__)
+#endif
+#if SIREN_ACTIVE_LEVEL <= SIREN_LEVEL_ERROR
+#define LOG_ERROR(...) SIREN_LOG_(spdlog::level::err, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) SIREN_LOG_DISABLED_(spdlog::level::err, __VA_ARGS__)
+#endif
+#if SIREN_ACTIVE_LEVEL <= SIREN_LEVEL_CRITICAL
+#define LOG_CRITICAL(...) SIREN_LOG_(spdlog::level::critical, __VA_ARGS__)
 #else
-#define LOG_TRACE SPDLOG_LOGGER_TRACE
-#define LOG_DEBUG SPDLOG_LOGGER_DEBUG
-#define LOG_INFO SPDLOG_LOGGER_INFO
-#define LOG_WARN SPDLOG_LOGGER_WARN
-#define LOG_CRITICAL SPDLOG_LOGGER_CRITICAL
-#define LOG_ERROR SPDLOG_LOGGER_ERROR
+#define LOG_CRITICAL(...) SIREN_LOG_DISABLED_(spdlog::level::critical, __VA_ARGS__)
 #endif
-// #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
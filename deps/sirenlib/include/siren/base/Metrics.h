@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "siren/base/noncopyable.h"
+
+namespace siren {
+namespace metrics {
+
+/// 每个指标被拆分成 kShards 个分片，线程按照 threadShard() 写入自己的分片，
+/// 读取时把所有分片相加，因此写入端不会在同一条 cache line 上竞争。
+static const int kShards = 16;
+
+namespace detail {
+inline std::atomic<int> g_nextShard{0};
+inline thread_local int t_shard = -1;
+}  // namespace detail
+
+/**
+ * @brief 当前线程对应的分片编号
+ * @note 线程第一次调用时分配，之后只是一次 TLS 读取
+ */
+inline int threadShard() {
+    if (detail::t_shard < 0) {
+        detail::t_shard =
+            detail::g_nextShard.fetch_add(1, std::memory_order_relaxed) %
+            kShards;
+    }
+    return detail::t_shard;
+}
+
+struct alignas(64) PaddedInt64 {
+    std::atomic<int64_t> value{0};
+};
+
+class Metric : noncopyable {
+   public:
+    enum Type { kCounter, kGauge, kHistogram };
+
+    Metric(Type type, std::string name, std::string help, std::string labels)
+        : type_(type),
+          name_(std::move(name)),
+          help_(std::move(help)),
+          labels_(std::move(labels)) {}
+    virtual ~Metric() = default;
+
+    Type type() const { return type_; }
+    const std::string& name() const { return name_; }
+    const std::string& help() const { return help_; }
+    /// e.g. server="echo", 不含大括号
+    const std::string& labels() const { return labels_; }
+
+    /// 以 Prometheus 文本格式输出样本行（不含 HELP/TYPE）
+    virtual void render(std::string* out) const = 0;
+
+   private:
+    const Type type_;
+    const std::string name_;
+    const std::string help_;
+    const std::string labels_;
+};
+
+/// 单调递增计数器，写入只做一次 relaxed fetch_add
+class Counter : public Metric {
+   public:
+    Counter(std::string name, std::string help, std::string labels)
+        : Metric(kCounter, std::move(name), std::move(help),
+                 std::move(labels)) {}
+
+    void inc(int64_t n = 1) {
+        shards_[threadShard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    int64_t value() const;
+    void render(std::string* out) const override;
+
+   private:
+    PaddedInt64 shards_[kShards];
+};
+
+/// 可增可减的仪表，可以由 inc/dec 维护，也可以在渲染时由回调计算
+class Gauge : public Metric {
+   public:
+    using ValueCallback = std::function<double()>;
+
+    Gauge(std::string name, std::string help, std::string labels,
+          ValueCallback cb = ValueCallback())
+        : Metric(kGauge, std::move(name), std::move(help), std::move(labels)),
+          callback_(std::move(cb)) {}
+
+    void inc(int64_t n = 1) {
+        shards_[threadShard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    void dec(int64_t n = 1) { inc(-n); }
+
+    double value() const;
+    void render(std::string* out) const override;
+
+   private:
+    PaddedInt64 shards_[kShards];
+    const ValueCallback callback_;
+};
+
+/// 固定桶边界的直方图，bounds 为各个桶的上界（升序，不含 +Inf）
+class Histogram : public Metric {
+   public:
+    Histogram(std::string name, std::string help, std::string labels,
+              std::vector<double> bounds);
+
+    void observe(double v);
+    void render(std::string* out) const override;
+
+   private:
+    struct alignas(64) Shard {
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+        std::atomic<uint64_t> count{0};
+        std::atomic<double> sum{0.0};
+    };
+
+    const std::vector<double> bounds_;
+    Shard shards_[kShards];
+};
+
+///
+/// 全局指标注册表
+///
+/// 注册（通常在启动或第一次使用时）与渲染会持有注册表自己的锁，
+/// 但不会触碰任何 EventLoop 的锁；写入端完全无锁。
+/// 同名同标签的指标重复注册会返回同一个对象。
+class MetricsRegistry : noncopyable {
+   public:
+    static MetricsRegistry& instance();
+
+    Counter& counter(const std::string& name, const std::string& help,
+                     const std::string& labels = std::string());
+    Gauge& gauge(const std::string& name, const std::string& help,
+                 const std::string& labels = std::string());
+    /// 渲染时调用 cb 取值，cb 不应该加锁等待 IO 线程
+    Gauge& gauge(const std::string& name, const std::string& help,
+                 const std::string& labels, Gauge::ValueCallback cb);
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         std::vector<double> bounds,
+                         const std::string& labels = std::string());
+
+    /// Prometheus text exposition format 0.0.4
+    std::string render() const;
+
+   private:
+    Metric* find(const std::string& name, const std::string& labels) const;
+    template <typename T, typename... Args>
+    T& getOrCreate(const std::string& name, const std::string& labels,
+                   Args&&... args);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Metric>> metrics_;
+};
+
+inline Counter& counter(const std::string& name, const std::string& help,
+                        const std::string& labels = std::string()) {
+    return MetricsRegistry::instance().counter(name, help, labels);
+}
+
+inline Gauge& gauge(const std::string& name, const std::string& help,
+                    const std::string& labels = std::string()) {
+    return MetricsRegistry::instance().gauge(name, help, labels);
+}
+
+inline Histogram& histogram(const std::string& name, const std::string& help,
+                            std::vector<double> bounds,
+                            const std::string& labels = std::string()) {
+    return MetricsRegistry::instance().histogram(name, help, std::move(bounds),
+                                                 labels);
+}
+
+}  // namespace metrics
+}  // namespace siren
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "siren/base/Futex.h"
+#include "siren/base/noncopyable.h"
+
+namespace siren {
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer queue.
+ *
+ * Dmitry Vyukov's ring: every cell carries a sequence number telling
+ * producers and consumers whose turn it is, so a put or take is one CAS
+ * on its own cache line plus the cell, and nobody holds a lock. Unlike
+ * BlockingQueue it is bounded: tryPut() fails when full, which gives
+ * producers backpressure.
+ *
+ * put()/take() block on a futex after a short spin, and only pay for a
+ * wake syscall when the other side actually sleeps.
+ *
+ * @note capacity is rounded up to a power of two
+ */
+template <typename T>
+class MpmcQueue : noncopyable {
+   public:
+    explicit MpmcQueue(size_t capacity)
+        : mask_(roundUp(capacity) - 1),
+          cells_(new Cell[mask_ + 1]),
+          enqueuePos_(0),
+          dequeuePos_(0),
+          notEmpty_(0),
+          notFull_(0),
+          takeWaiters_(0),
+          putWaiters_(0) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcQueue() {
+        T item;
+        while (tryTake(item)) {
+        }
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /// a snapshot, may be stale by the time it returns
+    size_t sizeApprox() const {
+        size_t tail = enqueuePos_.load(std::memory_order_relaxed);
+        size_t head = dequeuePos_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    /// @return false if the queue is full, @c x is untouched then
+    template <typename U>
+    bool tryPut(U&& x) {
+        Cell* cell;
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // a lap behind, full
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        ::new (cell->storage()) T(std::forward<U>(x));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        wake(&notEmpty_, &takeWaiters_);
+        return true;
+    }
+
+    /// @return false if the queue is empty
+    bool tryTake(T& out) {
+        Cell* cell;
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // not written yet, empty
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        T* item = cell->item();
+        out = std::move(*item);
+        item->~T();
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        wake(&notFull_, &putWaiters_);
+        return true;
+    }
+
+    /// blocks while the queue is full
+    template <typename U>
+    void put(U&& x) {
+        while (!tryPut(std::forward<U>(x))) {
+            wait(&notFull_, &putWaiters_, [this] { return sizeApprox() < capacity(); });
+        }
+    }
+
+    /// blocks while the queue is empty
+    T take() {
+        T item;
+        while (!tryTake(item)) {
+            wait(&notEmpty_, &takeWaiters_, [this] { return sizeApprox() > 0; });
+        }
+        return item;
+    }
+
+   private:
+    static const int kSpinTries = 64;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type data;
+
+        void* storage() { return &data; }
+        T* item() { return std::launder(reinterpret_cast<T*>(&data)); }
+    };
+
+    static size_t roundUp(size_t n) {
+        size_t capacity = 2;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+    // the waiter registers, then re-checks; the waker publishes, then
+    // checks for waiters; the fences keep one of them from missing the other
+    template <typename Ready>
+    void wait(std::atomic<uint32_t>* word, std::atomic<int>* waiters, Ready ready) {
+        for (int i = 0; i < kSpinTries; ++i) {
+            if (ready()) return;
+            std::this_thread::yield();
+        }
+        uint32_t seen = word->load(std::memory_order_relaxed);
+        waiters->fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready()) futexWait(word, seen);
+        waiters->fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void wake(std::atomic<uint32_t>* word, std::atomic<int>* waiters) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters->load(std::memory_order_relaxed) > 0) {
+            word->fetch_add(1, std::memory_order_relaxed);
+            futexWake(word, 1);
+        }
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    // producers and consumers each spin on their own line
+    alignas(64) std::atomic<size_t> enqueuePos_;
+    alignas(64) std::atomic<size_t> dequeuePos_;
+    alignas(64) std::atomic<uint32_t> notEmpty_;
+    std::atomic<uint32_t> notFull_;
+    std::atomic<int> takeWaiters_;
+    std::atomic<int> putWaiters_;
+};
+
+}  // namespace siren
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "siren/base/noncopyable.h"
+
+struct iovec;
+
+namespace siren {
+
+/**
+ * @brief Log output that never blocks the thread writing the record.
+ *
+ * Every thread appending gets its own single-producer single-consumer byte
+ * ring, registered on its first append(). A record is copied in whole or
+ * not at all: when the ring is full it is dropped and counted, the caller
+ * never waits for the disk. One flusher thread drains all rings with
+ * writev(2) into the file, rotating it by size, and reports the drop count
+ * in the log itself.
+ *
+ * Records of one thread keep their order, records of different threads
+ * may be interleaved by batch; each carries its own timestamp. Use
+ * RingLogSink to put it behind spdlog.
+ */
+class RingLogBackend : noncopyable {
+   public:
+    static const size_t kDefaultRingBytes = 256 * 1024;
+    static const int kDefaultFlushIntervalMs = 10;
+
+    /// @param path file appended to, its directory is created if missing
+    /// @param ringBytes size of each thread's ring, rounded up to a power of two
+    explicit RingLogBackend(std::string path, size_t ringBytes = kDefaultRingBytes);
+    ~RingLogBackend();  // stop()
+
+    /// Keep at most @c maxFiles old files of @c maxBytes each, named like
+    /// spdlog's rotating sink: log.log, log.1.log, log.2.log ...
+    /// Not thread safe, call it before start().
+    void setRotation(size_t maxBytes, int maxFiles);
+    /// Also write everything to @c fd, e.g. STDOUT_FILENO; -1 for none.
+    /// Not thread safe, call it before start().
+    void setEchoFd(int fd) { echoFd_ = fd; }
+    /// Longest time a record waits in a ring while the flusher is idle.
+    /// Not thread safe, call it before start().
+    void setFlushInterval(int ms) { flushIntervalMs_ = ms; }
+
+    void start();
+    /// Joins the flusher, then drains every ring. Records appended after
+    /// that are written by the appending thread itself, so shutdown logs
+    /// still reach the file.
+    void stop();
+
+    /// Thread safe, wait free after the calling thread's first call until
+    /// stop(), blocking on the file after it.
+    /// @return false if the record was dropped
+    bool append(const char* data, size_t len);
+
+    /// Asks the flusher to drain now, does not wait for it.
+    void wakeup();
+
+    /// records dropped so far because a ring was full
+    uint64_t dropped() const;
+
+    const std::string& path() const { return path_; }
+
+   private:
+    struct Ring;
+
+    Ring* ringOfThisThread();
+    void flusherLoop();
+    size_t drainOnce();
+    bool backlogged() const;
+    void appendAfterStop(const char* data, size_t len);
+    void writeAll(int fd, struct iovec* iov, int iovcnt);
+    void openFile();
+    void rotate();
+    void reportDropped();
+
+    const std::string path_;
+    const size_t ringBytes_;
+    const uint64_t id_;  // tells this backend's rings apart in a thread
+    size_t maxFileBytes_;
+    int maxFiles_;
+    int echoFd_;
+    int flushIntervalMs_;
+
+    std::atomic<bool> running_;
+    std::atomic<bool> stopped_;  // flusher joined, append() writes through
+    std::thread flusher_;
+    std::mutex stoppedMutex_;  // once stopped_, stands in for the flusher thread
+
+    mutable std::mutex ringsMutex_;  // registration only, never held while writing
+    std::vector<std::shared_ptr<Ring>> rings_;
+    std::atomic<uint64_t> ringsVersion_;
+    std::atomic<uint64_t> droppedRetired_;  // drops of rings already released
+
+    // flusher parking; a producer wakes it when its ring passes half full
+    std::atomic<uint32_t> wakeups_;
+    std::atomic<bool> sleeping_;
+
+    // flusher thread only, or under stoppedMutex_ once stopped_
+    int fd_;
+    size_t fileBytes_;
+    uint64_t droppedReported_;
+    std::vector<std::shared_ptr<Ring>> active_;  // copy of rings_
+    uint64_t activeVersion_;
+};
+
+}  // namespace siren
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "siren/base/RingLogBackend.h"
+
+namespace siren {
+
+/**
+ * @brief spdlog sink handing preformatted records to a RingLogBackend.
+ *
+ * The record is formatted on the logging thread, with a per-thread clone
+ * of the sink's formatter so no lock is taken, and copied into that
+ * thread's ring. Unlike spdlog's async logger with
+ * async_overflow_policy::block, a slow disk makes records drop instead of
+ * stalling the caller; the drops are counted and reported in the log.
+ */
+class RingLogSink : public spdlog::sinks::sink {
+   public:
+    explicit RingLogSink(std::shared_ptr<RingLogBackend> backend);
+
+    void log(const spdlog::details::log_msg& msg) override;
+    /// wakes the flusher, does not wait for the disk
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override;
+
+    const std::shared_ptr<RingLogBackend>& backend() const { return backend_; }
+
+   private:
+    std::shared_ptr<RingLogBackend> backend_;
+    std::mutex formatterMutex_;  // taken when a thread refreshes its clone
+    std::unique_ptr<spdlog::formatter> formatter_;
+    std::atomic<uint64_t> formatterVersion_;
+};
+
+}  // namespace siren
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "siren/base/InplaceFunction.h"
+#include "siren/base/noncopyable.h"
+
+namespace siren {
+
+namespace detail {
+
+/**
+ * @brief Chase-Lev work-stealing deque of pointers.
+ *
+ * The owner pushes and pops at the bottom without locks, thieves take
+ * from the top with one CAS. The ring doubles when full; old rings are
+ * kept until the deque dies because a thief may still be reading one.
+ * Follows Lê, Pop, Cohen, Zappa Nardelli, "Correct and Efficient
+ * Work-Stealing for Weak Memory Models", PPoPP 2013.
+ */
+template <typename T>
+class WorkStealingDeque : noncopyable {
+   public:
+    explicit WorkStealingDeque(size_t capacity = 256)
+        : top_(0), bottom_(0), array_(new Array(capacity)) {
+        garbage_.emplace_back(array_.load(std::memory_order_relaxed));
+    }
+
+    /// owner thread only
+    void push(T* item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->capacity()) - 1) {
+            a = grow(a, b, t);
+        }
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /// owner thread only, newest first
+    T* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = a->get(b);
+        if (t == b) {
+            // the last one, race the thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /// any thread, oldest first; nullptr when empty or lost a race
+    T* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+        Array* a = array_.load(std::memory_order_acquire);
+        T* item = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    /// a snapshot, exact only on the owner thread
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    class Array {
+       public:
+        explicit Array(size_t capacity)
+            : mask_(capacity - 1), slots_(new std::atomic<T*>[capacity]) {}
+        size_t capacity() const { return mask_ + 1; }
+        // acquire/release on the slot costs nothing on x86 and lets a
+        // thief see the task the pointer points to without the fences
+        T* get(int64_t i) const {
+            return slots_[static_cast<size_t>(i) & mask_].load(std::memory_order_acquire);
+        }
+        void put(int64_t i, T* item) {
+            slots_[static_cast<size_t>(i) & mask_].store(item, std::memory_order_release);
+        }
+
+       private:
+        const size_t mask_;
+        std::unique_ptr<std::atomic<T*>[]> slots_;
+    };
+
+    Array* grow(Array* old, int64_t b, int64_t t) {
+        Array* a = new Array(old->capacity() * 2);
+        for (int64_t i = t; i < b; ++i) a->put(i, old->get(i));
+        garbage_.emplace_back(a);
+        array_.store(a, std::memory_order_release);
+        return a;
+    }
+
+    // top_ and bottom_ are written by different threads
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> garbage_;  // owner only
+};
+
+}  // namespace detail
+
+/**
+ * @brief CPU worker pool with one work-stealing deque per worker.
+ *
+ * A task submitted from a worker goes to the bottom of that worker's own
+ * deque, anything else goes to the shared injection queue. An idle worker
+ * pops its own deque, then takes from the injection queue, then steals the
+ * oldest task of a random victim, and parks after a short spin. Workers
+ * never contend on one lock while there is local work, unlike a
+ * BlockingQueue shared by every thread.
+ *
+ * Use net/ComputePool.h to hand a result back to an EventLoop.
+ */
+class WorkStealingPool : noncopyable {
+   public:
+    typedef InplaceFunction<void()> Task;
+
+    explicit WorkStealingPool(const std::string& name = "WorkStealingPool");
+    ~WorkStealingPool();  // stop()
+
+    /// Not thread safe, call it once.
+    void start(int numThreads);
+    /// Runs what was already submitted, then joins the workers.
+    void stop();
+
+    /// Thread safe. Before start() or after stop() it runs @c task inline.
+    void submit(Task task);
+
+    const std::string& name() const { return name_; }
+    size_t numThreads() const { return workers_.size(); }
+
+    /// the pool whose worker is calling, nullptr on other threads
+    static WorkStealingPool* current();
+
+   private:
+    struct Worker {
+        detail::WorkStealingDeque<Task> deque;
+        std::thread thread;
+    };
+
+    void workerLoop(size_t index);
+    Task* findTask(size_t index, uint64_t* seed);
+    Task* takeInjected();
+    bool hasWork() const;
+    void notifyOne();
+
+    const std::string name_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> running_;
+
+    std::mutex injectMutex_;
+    std::deque<Task*> injected_;
+    std::atomic<size_t> injectedCount_;
+
+    // parking, sleepers_ tells submit() whether anyone needs a wakeup
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCond_;
+    std::atomic<int> sleepers_;
+    uint64_t wakeups_;  // guarded by sleepMutex_
+};
+
+}  // namespace siren
@@ -1,18 +1,24 @@
 #include "siren/base/CountDownLatch.h"
 
+#include "siren/base/Futex.h"
+
 /**
  * @brief Construct a new siren::Count Down Latch::Count Down Latch object
  *
  * @param count 计数器初始值
  */
 siren::CountDownLatch::CountDownLatch(int count)
-    : count_(count), mutex_(), condition_() {}
+    : state_(count > 0 ? static_cast<uint32_t>(count) & kCountMask : 0) {}
 
 void siren::CountDownLatch::wait() {
-    std::unique_lock<std::mutex> lock(mutex_);
-
-    while (count_ > 0) {
-        condition_.wait(lock);
+    uint32_t state = state_.load(std::memory_order_acquire);
+    while ((state & kCountMask) != 0) {
+        if (!(state & kWaiters) &&
+            !state_.compare_exchange_weak(state, state | kWaiters, std::memory_order_acquire)) {
+            continue;
+        }
+        futexWait(&state_, state | kWaiters);
+        state = state_.load(std::memory_order_acquire);
     }
 }
 
@@ -21,12 +27,16 @@ void siren::CountDownLatch::wait() {
  *
  */
 void siren::CountDownLatch::countDown() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    count_--;
-    if (count_ == 0) condition_.notify_all();
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    do {
+        if ((state & kCountMask) == 0) return;
+    } while (!state_.compare_exchange_weak(state, state - 1, std::memory_order_acq_rel,
+                                           std::memory_order_relaxed));
+    if ((state & kCountMask) == 1 && (state & kWaiters)) {
+        futexWakeAll(&state_);
+    }
 }
 
 int siren::CountDownLatch::getCount() const {
-    std::unique_lock<std::mutex> lock(mutex_);
-    return count_;
-}
\ No newline at end of file
+    return static_cast<int>(state_.load(std::memory_order_acquire) & kCountMask);
+}
@@ -0,0 +1,38 @@
+#include "siren/base/FutexMutex.h"
+
+#include "siren/base/Futex.h"
+
+namespace {
+// tries before parking, each a few dozen cycles
+const int kSpinTries = 100;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+}  // namespace
+
+void siren::FutexMutex::lockSlow() {
+    for (int i = 0; i < kSpinTries; ++i) {
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        if (state == kUnlocked &&
+            state_.compare_exchange_weak(state, kLocked, std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+            return;
+        }
+        if (state == kContended) break;  // somebody already sleeps, join them
+        cpuRelax();
+    }
+    // whoever takes it from here on cannot tell whether others sleep, so it
+    // marks the word contended and its unlock() wakes one
+    while (state_.exchange(kContended, std::memory_order_acquire) != kUnlocked) {
+        futexWait(&state_, kContended);
+    }
+}
+
+void siren::FutexMutex::wakeOne() {
+    futexWake(&state_, 1);
+}
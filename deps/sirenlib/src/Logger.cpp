@@ -1,5 +1,9 @@
 #include "siren/base/Logger.h"
 
+#include <unistd.h>
+
+#include "siren/base/RingLogSink.h"
+
 
 spdlog::logger& Logger::getLogger() {
     // TODO: insert return statement here
@@ -18,6 +22,7 @@ Logger::Logger() {
         useASyncLogger();
         spdlog::set_level(spdlog::level::info);
     }
+    handle_.store(logger_.get(), std::memory_order_release);
 }
 
 void Logger::useSyncLogger() {
@@ -38,19 +43,17 @@ void Logger::useSyncLogger() {
 }
 
 void Logger::useASyncLogger() {
-    auto stdout_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-    auto rotating_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-        "logs/log.log", 1024 * 1024 * 10, 3);
-
-    auto async_file = spdlog::basic_logger_mt<spdlog::async_factory>(
-        "async_file_logger", "logs/async_log.txt");
-
-    std::vector<spdlog::sink_ptr> sinks{stdout_sink, rotating_sink};
-    auto logger = std::make_shared<spdlog::async_logger>(
-        "defualt_logger", sinks.begin(), sinks.end(), spdlog::thread_pool(),
-        spdlog::async_overflow_policy::block);
+    // per-thread rings drained by one flusher thread; a slow disk drops and
+    // counts records instead of blocking the IO loops
+    auto backend = std::make_shared<siren::RingLogBackend>("logs/log.log");
+    backend->setRotation(1024 * 1024 * 10, 3);
+    backend->setEchoFd(STDOUT_FILENO);
+    backend->start();
+
+    auto sink = std::make_shared<siren::RingLogSink>(backend);
+    auto logger = std::make_shared<spdlog::logger>("defualt_logger", sink);
     spdlog::register_logger(logger);
     logger_ = logger;
 
     spdlog::set_level(spdlog::level::trace);
-}
\ No newline at end of file
+}
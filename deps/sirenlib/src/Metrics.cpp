@@ -0,0 +1,203 @@
+#include "siren/base/Metrics.h"
+
+#include <assert.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
+#include "siren/base/Singleton.h"
+
+using namespace siren;
+using namespace siren::metrics;
+
+namespace {
+
+void appendSample(std::string* out, const std::string& name,
+                  const std::string& labels, double value) {
+    if (labels.empty()) {
+        fmt::format_to(std::back_inserter(*out), "{} {}\n", name, value);
+    } else {
+        fmt::format_to(std::back_inserter(*out), "{}{{{}}} {}\n", name, labels,
+                       value);
+    }
+}
+
+void appendSample(std::string* out, const std::string& name,
+                  const std::string& labels, int64_t value) {
+    if (labels.empty()) {
+        fmt::format_to(std::back_inserter(*out), "{} {}\n", name, value);
+    } else {
+        fmt::format_to(std::back_inserter(*out), "{}{{{}}} {}\n", name, labels,
+                       value);
+    }
+}
+
+const char* typeToString(Metric::Type type) {
+    switch (type) {
+        case Metric::kCounter:
+            return "counter";
+        case Metric::kGauge:
+            return "gauge";
+        case Metric::kHistogram:
+            return "histogram";
+        default:
+            return "untyped";
+    }
+}
+
+}  // namespace
+
+int64_t siren::metrics::Counter::value() const {
+    int64_t sum = 0;
+    for (const auto& shard : shards_) {
+        sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void siren::metrics::Counter::render(std::string* out) const {
+    appendSample(out, name(), labels(), value());
+}
+
+double siren::metrics::Gauge::value() const {
+    if (callback_) {
+        return callback_();
+    }
+    int64_t sum = 0;
+    for (const auto& shard : shards_) {
+        sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return static_cast<double>(sum);
+}
+
+void siren::metrics::Gauge::render(std::string* out) const {
+    appendSample(out, name(), labels(), value());
+}
+
+siren::metrics::Histogram::Histogram(std::string name, std::string help,
+                                     std::string labels,
+                                     std::vector<double> bounds)
+    : Metric(kHistogram, std::move(name), std::move(help), std::move(labels)),
+      bounds_(std::move(bounds)) {
+    assert(std::is_sorted(bounds_.begin(), bounds_.end()));
+    for (auto& shard : shards_) {
+        // 最后一个桶是 +Inf
+        shard.buckets.reset(new std::atomic<uint64_t>[bounds_.size() + 1]);
+        for (size_t i = 0; i <= bounds_.size(); ++i) {
+            shard.buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void siren::metrics::Histogram::observe(double v) {
+    Shard& shard = shards_[threadShard()];
+    size_t idx = std::lower_bound(bounds_.begin(), bounds_.end(), v) -
+                 bounds_.begin();
+    shard.buckets[idx].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    // 同一分片基本只有一个写者，CAS 几乎不会失败
+    double old = shard.sum.load(std::memory_order_relaxed);
+    while (!shard.sum.compare_exchange_weak(old, old + v,
+                                            std::memory_order_relaxed)) {
+    }
+}
+
+void siren::metrics::Histogram::render(std::string* out) const {
+    const std::string bucketName = name() + "_bucket";
+    const std::string prefix = labels().empty() ? "" : labels() + ",";
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        for (const auto& shard : shards_) {
+            cumulative += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        std::string le = i < bounds_.size() ? fmt::format("{}", bounds_[i])
+                                            : std::string("+Inf");
+        fmt::format_to(std::back_inserter(*out), "{}{{{}le=\"{}\"}} {}\n",
+                       bucketName, prefix, le, cumulative);
+    }
+
+    double sum = 0.0;
+    int64_t count = 0;
+    for (const auto& shard : shards_) {
+        sum += shard.sum.load(std::memory_order_relaxed);
+        count += static_cast<int64_t>(
+            shard.count.load(std::memory_order_relaxed));
+    }
+    appendSample(out, name() + "_sum", labels(), sum);
+    appendSample(out, name() + "_count", labels(), count);
+}
+
+MetricsRegistry& siren::metrics::MetricsRegistry::instance() {
+    return Singleton<MetricsRegistry>::instance();
+}
+
+Metric* siren::metrics::MetricsRegistry::find(const std::string& name,
+                                              const std::string& labels) const {
+    for (const auto& metric : metrics_) {
+        if (metric->name() == name && metric->labels() == labels) {
+            return metric.get();
+        }
+    }
+    return nullptr;
+}
+
+template <typename T, typename... Args>
+T& siren::metrics::MetricsRegistry::getOrCreate(const std::string& name,
+                                                const std::string& labels,
+                                                Args&&... args) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Metric* metric = find(name, labels);
+    if (metric == nullptr) {
+        metrics_.emplace_back(new T(std::forward<Args>(args)...));
+        metric = metrics_.back().get();
+    }
+    assert(dynamic_cast<T*>(metric) != nullptr && "metric type mismatch");
+    return *static_cast<T*>(metric);
+}
+
+Counter& siren::metrics::MetricsRegistry::counter(const std::string& name,
+                                                  const std::string& help,
+                                                  const std::string& labels) {
+    return getOrCreate<Counter>(name, labels, name, help, labels);
+}
+
+Gauge& siren::metrics::MetricsRegistry::gauge(const std::string& name,
+                                              const std::string& help,
+                                              const std::string& labels) {
+    return getOrCreate<Gauge>(name, labels, name, help, labels);
+}
+
+Gauge& siren::metrics::MetricsRegistry::gauge(const std::string& name,
+                                              const std::string& help,
+                                              const std::string& labels,
+                                              Gauge::ValueCallback cb) {
+    return getOrCreate<Gauge>(name, labels, name, help, labels, std::move(cb));
+}
+
+Histogram& siren::metrics::MetricsRegistry::histogram(
+    const std::string& name, const std::string& help,
+    std::vector<double> bounds, const std::string& labels) {
+    return getOrCreate<Histogram>(name, labels, name, help, labels,
+                                  std::move(bounds));
+}
+
+std::string siren::metrics::MetricsRegistry::render() const {
+    std::string out;
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::unordered_set<std::string> rendered;
+    // 同名不同标签的指标属于同一个 family，HELP/TYPE 只输出一次
+    for (const auto& head : metrics_) {
+        if (!rendered.insert(head->name()).second) continue;
+        fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} {}\n",
+                       head->name(), head->help(), head->name(),
+                       typeToString(head->type()));
+        for (const auto& metric : metrics_) {
+            if (metric->name() == head->name()) {
+                metric->render(&out);
+            }
+        }
+    }
+    return out;
+}
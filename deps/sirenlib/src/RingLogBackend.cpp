@@ -0,0 +1,373 @@
+#include "siren/base/RingLogBackend.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "siren/base/Futex.h"
+
+namespace {
+// iovecs per writev, two per ring at most
+const int kMaxIov = 256;
+
+std::atomic<uint64_t> g_nextBackendId(1);
+
+size_t roundUpPowerOfTwo(size_t n) {
+    size_t size = 4096;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+void createParentDirs(const std::string& path) {
+    for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1)) {
+        ::mkdir(path.substr(0, pos).c_str(), 0755);  // EEXIST is fine
+    }
+}
+
+// spdlog's rotating sink naming, logs/log.log -> logs/log.1.log
+std::string rotatedName(const std::string& path, int index) {
+    size_t slash = path.rfind('/');
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos || dot == 0 || (slash != std::string::npos && dot < slash + 2)) {
+        return path + "." + std::to_string(index);
+    }
+    return path.substr(0, dot) + "." + std::to_string(index) + path.substr(dot);
+}
+}  // namespace
+
+/// SPSC byte ring, the producer is the thread that registered it, the
+/// consumer is the flusher.
+struct siren::RingLogBackend::Ring {
+    explicit Ring(size_t capacity)
+        : mask(capacity - 1),
+          data(new char[capacity]),
+          head(0),
+          cachedTail(0),
+          dropped(0),
+          closed(false),
+          tail(0) {}
+
+    size_t capacity() const { return mask + 1; }
+
+    const size_t mask;
+    std::unique_ptr<char[]> data;
+    // producer side
+    alignas(64) std::atomic<uint64_t> head;
+    uint64_t cachedTail;
+    std::atomic<uint64_t> dropped;
+    std::atomic<bool> closed;  // the producer thread exited
+    // consumer side
+    alignas(64) std::atomic<uint64_t> tail;
+};
+
+siren::RingLogBackend::RingLogBackend(std::string path, size_t ringBytes)
+    : path_(std::move(path)),
+      ringBytes_(roundUpPowerOfTwo(ringBytes)),
+      id_(g_nextBackendId.fetch_add(1, std::memory_order_relaxed)),
+      maxFileBytes_(0),
+      maxFiles_(0),
+      echoFd_(-1),
+      flushIntervalMs_(kDefaultFlushIntervalMs),
+      running_(false),
+      stopped_(false),
+      ringsVersion_(0),
+      droppedRetired_(0),
+      wakeups_(0),
+      sleeping_(false),
+      fd_(-1),
+      fileBytes_(0),
+      droppedReported_(0),
+      activeVersion_(0) {}
+
+siren::RingLogBackend::~RingLogBackend() {
+    stop();
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void siren::RingLogBackend::setRotation(size_t maxBytes, int maxFiles) {
+    maxFileBytes_ = maxBytes;
+    maxFiles_ = std::max(0, maxFiles);
+}
+
+void siren::RingLogBackend::start() {
+    assert(!running_);
+    openFile();
+    stopped_ = false;
+    running_ = true;
+    flusher_ = std::thread([this] { flusherLoop(); });
+    ::pthread_setname_np(flusher_.native_handle(), "RingLogFlusher");
+}
+
+void siren::RingLogBackend::stop() {
+    if (!running_.exchange(false)) return;
+    wakeup();
+    flusher_.join();
+    std::lock_guard<std::mutex> lock(stoppedMutex_);
+    stopped_.store(true, std::memory_order_release);
+    // records that landed after the flusher's last drain
+    while (drainOnce() > 0) {
+    }
+    reportDropped();
+}
+
+void siren::RingLogBackend::wakeup() {
+    wakeups_.fetch_add(1, std::memory_order_relaxed);
+    futexWake(&wakeups_, 1);
+}
+
+siren::RingLogBackend::Ring* siren::RingLogBackend::ringOfThisThread() {
+    // the rings this thread writes, marked closed when it exits so the
+    // flusher can release them once drained
+    struct Owned {
+        uint64_t backendId;
+        std::shared_ptr<Ring> ring;
+    };
+    struct ThreadRings {
+        std::vector<Owned> owned;
+        ~ThreadRings() {
+            for (Owned& o : owned) o.ring->closed.store(true, std::memory_order_release);
+        }
+    };
+    static thread_local ThreadRings t_rings;
+
+    for (Owned& o : t_rings.owned) {
+        if (o.backendId == id_) return o.ring.get();
+    }
+    auto ring = std::make_shared<Ring>(ringBytes_);
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings_.push_back(ring);
+        ringsVersion_.fetch_add(1, std::memory_order_release);
+    }
+    t_rings.owned.push_back(Owned{id_, ring});
+    return ring.get();
+}
+
+bool siren::RingLogBackend::append(const char* data, size_t len) {
+    if (stopped_.load(std::memory_order_acquire)) {
+        appendAfterStop(data, len);
+        return true;
+    }
+    Ring* ring = ringOfThisThread();
+    const size_t capacity = ring->capacity();
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head + len - ring->cachedTail > capacity) {
+        ring->cachedTail = ring->tail.load(std::memory_order_acquire);
+        if (head + len - ring->cachedTail > capacity) {
+            ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+            return false;
+        }
+    }
+    const size_t offset = static_cast<size_t>(head) & ring->mask;
+    const size_t first = std::min(len, capacity - offset);
+    memcpy(ring->data.get() + offset, data, first);
+    memcpy(ring->data.get(), data + first, len - first);
+    ring->head.store(head + len, std::memory_order_release);
+
+    if (head + len - ring->cachedTail > capacity / 2) {
+        ring->cachedTail = ring->tail.load(std::memory_order_acquire);
+        if (head + len - ring->cachedTail > capacity / 2) {
+            // pairs with the fence in flusherLoop: either it sees the
+            // backlog or we see it sleeping
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping_.load(std::memory_order_relaxed)) wakeup();
+        }
+    }
+    return true;
+}
+
+// No flusher any more: write the record here, after whatever is still in
+// the rings so each thread's records keep their order.
+void siren::RingLogBackend::appendAfterStop(const char* data, size_t len) {
+    std::lock_guard<std::mutex> lock(stoppedMutex_);
+    while (drainOnce() > 0) {
+    }
+    struct iovec iov = {const_cast<char*>(data), len};
+    if (fd_ >= 0) writeAll(fd_, &iov, 1);
+    iov = {const_cast<char*>(data), len};
+    if (echoFd_ >= 0) writeAll(echoFd_, &iov, 1);
+    fileBytes_ += len;
+    if (maxFileBytes_ > 0 && fileBytes_ >= maxFileBytes_) rotate();
+}
+
+uint64_t siren::RingLogBackend::dropped() const {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    uint64_t total = droppedRetired_.load(std::memory_order_relaxed);
+    for (const auto& ring : rings_) total += ring->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+void siren::RingLogBackend::flusherLoop() {
+    const struct timespec interval = {flushIntervalMs_ / 1000,
+                                      (flushIntervalMs_ % 1000) * 1000 * 1000L};
+    while (running_.load(std::memory_order_acquire)) {
+        drainOnce();
+        reportDropped();
+
+        // sleep out the interval so the next writev carries a batch, unless
+        // a ring passes half full first
+        const uint32_t seen = wakeups_.load(std::memory_order_relaxed);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!backlogged() && running_.load(std::memory_order_acquire)) {
+            futexWait(&wakeups_, seen, &interval);
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+    while (drainOnce() > 0) {
+    }
+    reportDropped();
+}
+
+bool siren::RingLogBackend::backlogged() const {
+    for (const auto& ring : active_) {
+        uint64_t used = ring->head.load(std::memory_order_relaxed) -
+                        ring->tail.load(std::memory_order_relaxed);
+        if (used > ring->capacity() / 2) return true;
+    }
+    return false;
+}
+
+size_t siren::RingLogBackend::drainOnce() {
+    if (activeVersion_ != ringsVersion_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        active_ = rings_;
+        activeVersion_ = ringsVersion_.load(std::memory_order_relaxed);
+    }
+
+    struct iovec iov[kMaxIov];
+    struct Span {
+        Ring* ring;
+        uint64_t head;
+    };
+    Span spans[kMaxIov];
+    int iovcnt = 0;
+    int spancnt = 0;
+    size_t batch = 0;
+    size_t total = 0;
+
+    auto writeBatch = [&] {
+        if (iovcnt == 0) return;
+        struct iovec echo[kMaxIov];
+        if (echoFd_ >= 0) std::copy(iov, iov + iovcnt, echo);
+        if (fd_ >= 0) writeAll(fd_, iov, iovcnt);
+        if (echoFd_ >= 0) writeAll(echoFd_, echo, iovcnt);
+        for (int i = 0; i < spancnt; ++i) {
+            spans[i].ring->tail.store(spans[i].head, std::memory_order_release);
+        }
+        fileBytes_ += batch;
+        total += batch;
+        iovcnt = spancnt = 0;
+        batch = 0;
+        if (maxFileBytes_ > 0 && fileBytes_ >= maxFileBytes_) rotate();
+    };
+
+    bool retire = false;
+    for (const auto& ring : active_) {
+        // read closed first, a closed ring's head is final
+        const bool closed = ring->closed.load(std::memory_order_acquire);
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        if (head == tail) {
+            retire |= closed;
+            continue;
+        }
+        if (iovcnt + 2 > kMaxIov) writeBatch();
+        const size_t len = static_cast<size_t>(head - tail);
+        const size_t offset = static_cast<size_t>(tail) & ring->mask;
+        const size_t first = std::min(len, ring->capacity() - offset);
+        iov[iovcnt++] = {ring->data.get() + offset, first};
+        if (len > first) iov[iovcnt++] = {ring->data.get(), len - first};
+        spans[spancnt++] = {ring.get(), head};
+        batch += len;
+        retire |= closed;
+    }
+    writeBatch();
+
+    if (retire) {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        auto dead = [this](const std::shared_ptr<Ring>& ring) {
+            if (!ring->closed.load(std::memory_order_acquire) ||
+                ring->head.load(std::memory_order_acquire) !=
+                    ring->tail.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            droppedRetired_.fetch_add(ring->dropped.load(std::memory_order_relaxed),
+                                      std::memory_order_relaxed);
+            return true;
+        };
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), dead), rings_.end());
+        ringsVersion_.fetch_add(1, std::memory_order_release);
+    }
+    return total;
+}
+
+void siren::RingLogBackend::writeAll(int fd, struct iovec* iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = ::writev(fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;  // nowhere to report it, the records are lost
+        }
+        size_t left = static_cast<size_t>(n);
+        while (iovcnt > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+}
+
+void siren::RingLogBackend::openFile() {
+    createParentDirs(path_);
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        fprintf(stderr, "RingLogBackend: cannot open %s: %s\n", path_.c_str(), strerror(errno));
+        fileBytes_ = 0;
+        return;
+    }
+    struct stat st;
+    fileBytes_ = ::fstat(fd_, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+}
+
+void siren::RingLogBackend::rotate() {
+    if (fd_ >= 0) ::close(fd_);
+    if (maxFiles_ == 0) {
+        ::unlink(path_.c_str());
+    } else {
+        for (int i = maxFiles_; i > 1; --i) {
+            ::rename(rotatedName(path_, i - 1).c_str(), rotatedName(path_, i).c_str());
+        }
+        ::rename(path_.c_str(), rotatedName(path_, 1).c_str());
+    }
+    openFile();
+}
+
+void siren::RingLogBackend::reportDropped() {
+    uint64_t total = dropped();
+    if (total == droppedReported_) return;
+    char line[128];
+    int len = snprintf(line, sizeof line, "RingLogBackend: dropped %llu log records, %llu in total\n",
+                       static_cast<unsigned long long>(total - droppedReported_),
+                       static_cast<unsigned long long>(total));
+    droppedReported_ = total;
+    struct iovec iov = {line, static_cast<size_t>(len)};
+    if (fd_ >= 0) writeAll(fd_, &iov, 1);
+    iov = {line, static_cast<size_t>(len)};
+    if (echoFd_ >= 0) writeAll(echoFd_, &iov, 1);
+    fileBytes_ += static_cast<size_t>(len);
+}
@@ -0,0 +1,50 @@
+#include "siren/base/RingLogSink.h"
+
+#include <spdlog/pattern_formatter.h>
+
+namespace {
+// bumped by every set_formatter() of any sink, so one number tells a
+// thread whether its formatter clone is still the right one
+std::atomic<uint64_t> g_formatterVersion(1);
+
+// one clone per thread, a thread alternating between several sinks
+// re-clones on every switch
+struct ThreadFormatter {
+    uint64_t version = 0;
+    std::unique_ptr<spdlog::formatter> formatter;
+    spdlog::memory_buf_t buf;
+};
+thread_local ThreadFormatter t_formatter;
+}  // namespace
+
+siren::RingLogSink::RingLogSink(std::shared_ptr<RingLogBackend> backend)
+    : backend_(std::move(backend)),
+      formatter_(new spdlog::pattern_formatter()),
+      formatterVersion_(g_formatterVersion.fetch_add(1, std::memory_order_relaxed)) {}
+
+void siren::RingLogSink::log(const spdlog::details::log_msg& msg) {
+    ThreadFormatter& local = t_formatter;
+    if (local.version != formatterVersion_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(formatterMutex_);
+        local.formatter = formatter_->clone();
+        local.version = formatterVersion_.load(std::memory_order_relaxed);
+    }
+    local.buf.clear();
+    local.formatter->format(msg, local.buf);
+    backend_->append(local.buf.data(), local.buf.size());
+}
+
+void siren::RingLogSink::flush() {
+    backend_->wakeup();
+}
+
+void siren::RingLogSink::set_pattern(const std::string& pattern) {
+    set_formatter(std::unique_ptr<spdlog::formatter>(new spdlog::pattern_formatter(pattern)));
+}
+
+void siren::RingLogSink::set_formatter(std::unique_ptr<spdlog::formatter> formatter) {
+    std::lock_guard<std::mutex> lock(formatterMutex_);
+    formatter_ = std::move(formatter);
+    formatterVersion_.store(g_formatterVersion.fetch_add(1, std::memory_order_relaxed),
+                            std::memory_order_release);
+}
@@ -0,0 +1,164 @@
+#include "siren/base/WorkStealingPool.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+
+namespace {
+thread_local siren::WorkStealingPool* t_pool = nullptr;
+thread_local size_t t_index = 0;
+
+// rounds of stealing before a worker parks
+const int kSpinRounds = 64;
+
+uint64_t nextRandom(uint64_t* state) {
+    // xorshift64, victims only need to be spread out
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+}  // namespace
+
+siren::WorkStealingPool::WorkStealingPool(const std::string& name)
+    : name_(name), running_(false), injectedCount_(0), sleepers_(0), wakeups_(0) {}
+
+siren::WorkStealingPool::~WorkStealingPool() {
+    stop();
+}
+
+void siren::WorkStealingPool::start(int numThreads) {
+    assert(workers_.empty() && numThreads > 0);
+    running_ = true;
+    for (int i = 0; i < numThreads; ++i) {
+        workers_.emplace_back(new Worker);
+    }
+    // every deque exists before any worker may steal from it
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i]->thread = std::thread([this, i] { workerLoop(i); });
+        // room for any index, then cut to the 15 characters the kernel keeps
+        char buf[32];
+        snprintf(buf, sizeof buf, "%.11s%zu", name_.c_str(), i);
+        buf[15] = '\0';
+        ::pthread_setname_np(workers_[i]->thread.native_handle(), buf);
+    }
+}
+
+void siren::WorkStealingPool::stop() {
+    if (!running_.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        ++wakeups_;
+    }
+    sleepCond_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+    // a submit() racing with stop() may have injected after the workers left
+    while (Task* task = takeInjected()) {
+        (*task)();
+        delete task;
+    }
+}
+
+siren::WorkStealingPool* siren::WorkStealingPool::current() {
+    return t_pool;
+}
+
+void siren::WorkStealingPool::submit(Task task) {
+    if (t_pool == this) {
+        workers_[t_index]->deque.push(new Task(std::move(task)));
+    } else if (running_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(injectMutex_);
+        injected_.push_back(new Task(std::move(task)));
+        injectedCount_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        task();
+        return;
+    }
+    notifyOne();
+}
+
+void siren::WorkStealingPool::notifyOne() {
+    // pairs with the fence in workerLoop: either the sleeper sees the task
+    // or we see the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            ++wakeups_;
+        }
+        sleepCond_.notify_one();
+    }
+}
+
+siren::WorkStealingPool::Task* siren::WorkStealingPool::takeInjected() {
+    if (injectedCount_.load(std::memory_order_relaxed) == 0) return nullptr;
+    std::lock_guard<std::mutex> lock(injectMutex_);
+    if (injected_.empty()) return nullptr;
+    Task* task = injected_.front();
+    injected_.pop_front();
+    injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+bool siren::WorkStealingPool::hasWork() const {
+    if (injectedCount_.load(std::memory_order_relaxed) > 0) return true;
+    for (const auto& worker : workers_) {
+        if (!worker->deque.empty()) return true;
+    }
+    return false;
+}
+
+siren::WorkStealingPool::Task* siren::WorkStealingPool::findTask(size_t index, uint64_t* seed) {
+    if (Task* task = workers_[index]->deque.pop()) return task;
+    if (Task* task = takeInjected()) return task;
+    const size_t n = workers_.size();
+    if (n > 1) {
+        size_t start = static_cast<size_t>(nextRandom(seed) % n);
+        for (size_t k = 0; k < n; ++k) {
+            size_t victim = (start + k) % n;
+            if (victim == index) continue;
+            if (Task* task = workers_[victim]->deque.steal()) return task;
+        }
+    }
+    return nullptr;
+}
+
+void siren::WorkStealingPool::workerLoop(size_t index) {
+    t_pool = this;
+    t_index = index;
+    uint64_t seed = 0x9e3779b97f4a7c15ULL * (index + 1);
+    int idle = 0;
+    for (;;) {
+        if (Task* task = findTask(index, &seed)) {
+            idle = 0;
+            (*task)();
+            delete task;
+            continue;
+        }
+        if (++idle < kSpinRounds) {
+            std::this_thread::yield();
+            continue;
+        }
+        idle = 0;
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (hasWork()) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (!running_.load(std::memory_order_acquire)) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+        const uint64_t seen = wakeups_;
+        sleepCond_.wait(lock, [this, seen] { return wakeups_ != seen; });
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    t_pool = nullptr;
+}
@@ -0,0 +1,166 @@
+// Fan-out cost: per-connection copies vs SharedPayload.
+//
+// <clients> loopback connections with a small receive buffer are opened to
+// an in-process TcpServer and do not read while <messages> messages of
+// <size> bytes are sent to all of them, so most bytes wait in the server.
+// Then the clients drain. Reports the RSS growth of the server side while
+// the messages wait, plus wall and CPU time until everything arrives.
+//
+//   ./broadcast_bench -m copy|shared [-c clients] [-n messages] [-s size] [-t threads]
+//                     [-p port]
+//
+// copy:   conn->send(string) for every connection, from the broadcasting thread
+// shared: broadcast(conns, SharedPayload), one task per loop, no copies
+
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThread.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/SharedPayload.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+string g_mode = "shared";
+int g_clients = 500;
+int g_messages = 128;
+size_t g_size = 8192;
+int g_threads = 2;
+uint16_t g_port = 9878;
+
+long residentKiB() {
+    long pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f) {
+        if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+double cpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+int connectSmallWindow(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int rcvbuf = 4096;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) < 0) {
+        perror("connect");
+        exit(1);
+    }
+    return fd;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "m:c:n:s:t:p:")) != -1) {
+        switch (opt) {
+            case 'm': g_mode = optarg; break;
+            case 'c': g_clients = std::max(1, atoi(optarg)); break;
+            case 'n': g_messages = std::max(1, atoi(optarg)); break;
+            case 's': g_size = static_cast<size_t>(std::max(1, atoi(optarg))); break;
+            case 't': g_threads = atoi(optarg); break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    EventLoopThread serverThread;
+    EventLoop* serverLoop = serverThread.startLoop();
+    InetAddress listenAddr(g_port, true);
+    TcpServer server(serverLoop, listenAddr, "BroadcastBench");
+    server.setThreadNum(g_threads);
+
+    std::mutex mutex;
+    std::vector<TcpConnectionPtr> conns;
+    CountDownLatch connected(g_clients);
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            conns.push_back(conn);
+            connected.countDown();
+        }
+    });
+    serverLoop->runInLoop([&server] { server.start(); });
+    sleep(1);
+    uint16_t port = g_port;
+
+    std::vector<int> fds;
+    for (int i = 0; i < g_clients; ++i) fds.push_back(connectSmallWindow(port));
+    connected.wait();
+
+    const string message(g_size, 'm');
+    long rssBefore = residentKiB();
+    double cpuBefore = cpuSeconds();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int m = 0; m < g_messages; ++m) {
+        if (g_mode == "copy") {
+            for (const TcpConnectionPtr& conn : conns) conn->send(message);
+        } else {
+            broadcast(conns, SharedPayload::copyOf(message));
+        }
+    }
+    // wait until every loop has run its share
+    CountDownLatch queued(static_cast<int>(conns.size()));
+    runPerLoop(conns, [&queued](const std::vector<TcpConnectionPtr>& targets) {
+        for (size_t i = 0; i < targets.size(); ++i) queued.countDown();
+    });
+    queued.wait();
+    long rssQueued = residentKiB();
+
+    // drain
+    const size_t expected = g_size * static_cast<size_t>(g_messages);
+    std::vector<char> buf(64 * 1024);
+    for (int fd : fds) {
+        size_t received = 0;
+        while (received < expected) {
+            ssize_t n = ::read(fd, buf.data(), buf.size());
+            if (n <= 0) {
+                perror("read");
+                exit(1);
+            }
+            received += static_cast<size_t>(n);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double cpu = cpuSeconds() - cpuBefore;
+
+    printf("%s: %d clients x %d messages x %zu bytes: rss +%ld MiB while queued, "
+           "%.3f s wall, %.3f s cpu\n",
+           g_mode.c_str(), g_clients, g_messages, g_size, (rssQueued - rssBefore) / 1024, seconds,
+           cpu);
+    fflush(stdout);
+    _exit(0);
+}
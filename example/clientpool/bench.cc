@@ -0,0 +1,112 @@
+// TcpClientPool throughput demo.
+//
+// One process runs an echo TcpServer and a TcpClientPool with <connections>
+// warm connections over <loops> client loops. <workers> plain threads
+// borrow connections from the pool and send <requests> 16-byte messages
+// each; the run ends when every byte has been echoed back.
+//
+//   ./clientpool_bench [connections] [loops] [workers] [requests] [port]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClientPool.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+constexpr size_t kMessageSize = 16;
+
+std::atomic<int64_t> g_received(0);
+
+void onServerMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf);
+}
+
+void onClientMessage(const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+    g_received.fetch_add(static_cast<int64_t>(buf->readableBytes()));
+    buf->retrieveAll();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int connections = argc > 1 ? atoi(argv[1]) : 8;
+    int loops = argc > 2 ? atoi(argv[2]) : 2;
+    int workers = argc > 3 ? atoi(argv[3]) : 4;
+    int requests = argc > 4 ? atoi(argv[4]) : 100000;
+    uint16_t port = static_cast<uint16_t>(argc > 5 ? atoi(argv[5]) : 12346);
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    EventLoop loop;
+    InetAddress listenAddr(port);
+    TcpServer server(&loop, listenAddr, "EchoServer");
+    server.setMessageCallback(onServerMessage);
+    server.setThreadNum(1);
+    server.start();
+
+    EventLoopThreadPool clientLoops(&loop, "client");
+    clientLoops.setThreadNum(loops);
+    clientLoops.start();
+
+    InetAddress serverAddr("127.0.0.1", port);
+    TcpClientPool pool(&clientLoops, serverAddr, "pool", connections);
+    pool.setConnectionCallback([](const TcpConnectionPtr& conn) {
+        if (conn->connected()) conn->setTcpNoDelay(true);
+    });
+    pool.setMessageCallback(onClientMessage);
+    pool.start();
+
+    const int64_t expected = static_cast<int64_t>(workers) * requests * kMessageSize;
+    std::atomic<int64_t> misses(0);
+    std::thread driver([&] {
+        while (pool.connectedCount() < pool.size()) {
+            usleep(1000);
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int w = 0; w < workers; ++w) {
+            threads.emplace_back([&] {
+                const string message(kMessageSize, 'x');
+                for (int i = 0; i < requests;) {
+                    TcpClientPool::Lease lease = pool.acquire();
+                    if (!lease) {
+                        misses.fetch_add(1);
+                        continue;
+                    }
+                    lease->send(message);
+                    ++i;
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        while (g_received.load() < expected) {
+            usleep(100);
+        }
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+        printf("connections=%d loops=%d workers=%d: %.0f msg/s, misses=%lld\n",
+               connections, loops, workers,
+               static_cast<double>(workers) * requests / seconds,
+               static_cast<long long>(misses.load()));
+        fflush(stdout);
+        _exit(0);
+    });
+
+    loop.loop();
+    driver.join();
+}
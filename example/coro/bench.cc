@@ -0,0 +1,164 @@
+// Line-protocol pingpong written with coroutines vs the same with callbacks.
+//
+// The client sends "<seq>\r\n" and waits for the echo, <count> times over
+// one connection; the server echoes every line. -m coro runs both ends as
+// coroutines on AsyncConnection, -m callback is the MessageCallback form.
+// Reports round trips per second.
+//
+//   ./coro_bench [-m coro|callback] [-n count] [-p port]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/Coroutine.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThread.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+std::string g_mode = "coro";
+int g_count = 100000;
+uint16_t g_port = 9885;
+std::chrono::steady_clock::time_point g_start;
+
+void report() {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_start).count();
+    printf("%-8s %d round trips in %.3f s, %.0f rt/s\n", g_mode.c_str(), g_count, seconds,
+           g_count / seconds);
+    fflush(stdout);
+    _exit(0);  // skip tearing down both loops
+}
+
+Task<void> echoSession(AsyncConnection conn) {
+    for (;;) {
+        std::string line = co_await conn.readUntil("\r\n");
+        if (line.empty()) co_return;
+        if (!co_await conn.write(line)) co_return;
+    }
+}
+
+Task<size_t> roundTrip(AsyncConnection& conn, int seq) {
+    std::string line = std::to_string(seq) + "\r\n";
+    co_await conn.write(line);
+    std::string echo = co_await conn.readUntil("\r\n");
+    co_return echo == line ? 1 : 0;
+}
+
+Task<void> client(EventLoop* loop, InetAddress addr) {
+    AsyncClient client(loop, addr, "CoroBenchClient");
+    AsyncConnection conn = co_await client.connect();
+    if (!conn.connected()) {
+        fprintf(stderr, "connect failed\n");
+        _exit(1);
+    }
+    conn.connection()->setTcpNoDelay(true);
+    // the server side is up once the connection is, give it a tick anyway
+    co_await sleep(loop, 0.01);
+    g_start = std::chrono::steady_clock::now();
+    size_t ok = 0;
+    for (int i = 0; i < g_count; ++i) ok += co_await roundTrip(conn, i);
+    if (ok != static_cast<size_t>(g_count)) fprintf(stderr, "%zu mismatched\n", g_count - ok);
+    report();
+}
+
+// length of the first line with its CRLF, 0 if none is complete
+int lineLength(const Buffer* buf) {
+    const char* end = buf->peek() + buf->readableBytes();
+    const char* crlf = std::search(buf->peek(), end, "\r\n", "\r\n" + 2);
+    return crlf == end ? 0 : static_cast<int>(crlf + 2 - buf->peek());
+}
+
+void onServerMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    while (int len = lineLength(buf)) {
+        conn->send(buf->peek(), len);
+        buf->retrieve(len);
+    }
+}
+
+int g_seq = 0;
+std::string g_line;
+
+void sendNext(const TcpConnectionPtr& conn) {
+    g_line = std::to_string(g_seq) + "\r\n";
+    conn->send(g_line);
+}
+
+void onClientMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    while (int len = lineLength(buf)) {
+        buf->retrieve(len);
+        if (++g_seq == g_count) report();
+        sendNext(conn);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "m:n:p:")) != -1) {
+        switch (opt) {
+            case 'm': g_mode = optarg; break;
+            case 'n': g_count = std::max(1, atoi(optarg)); break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+    InetAddress addr("127.0.0.1", g_port);
+    const bool coro = g_mode == "coro";
+
+    EventLoopThread serverThread;
+    EventLoop* serverLoop = serverThread.startLoop();
+    TcpServer server(serverLoop, addr, "CoroBench");
+    if (coro) {
+        server.setConnectionCallback([](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                conn->setTcpNoDelay(true);
+                spawn(echoSession(AsyncConnection(conn)));
+            }
+        });
+    } else {
+        server.setConnectionCallback([](const TcpConnectionPtr& conn) {
+            if (conn->connected()) conn->setTcpNoDelay(true);
+        });
+        server.setMessageCallback(onServerMessage);
+    }
+    CountDownLatch started(1);
+    serverLoop->runInLoop([&] {
+        server.start();
+        started.countDown();
+    });
+    started.wait();
+
+    EventLoop loop;
+    if (coro) {
+        loop.runInLoop([&] { spawn(client(&loop, addr)); });
+        loop.loop();
+    } else {
+        TcpClient client(&loop, addr, "CoroBenchClient");
+        client.setConnectionCallback([](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                conn->setTcpNoDelay(true);
+                g_start = std::chrono::steady_clock::now();
+                sendNext(conn);
+            }
+        });
+        client.setMessageCallback(onClientMessage);
+        client.connect();
+        loop.loop();
+    }
+}
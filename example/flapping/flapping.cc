@@ -0,0 +1,212 @@
+// Reconnect storm against a flapping listener.
+//
+// A TcpServer is opened for <upMs>, torn down (dropping every connection)
+// for <downMs>, and reopened, <cycles> times. <clients> TcpClients with
+// retry enabled reconnect through Connector's jittered backoff and circuit
+// breaker. After each reopen the accepted connections are bucketed per
+// 100ms: with jitter the reconnects spread out instead of arriving in one
+// burst, and attempts made while the breaker is open never reach the
+// kernel. Halfway through every open window the client calls connect()
+// again, which the breaker must refuse up front.
+//
+// Exits non-zero if any of this does not hold: a cycle whose busiest bucket
+// has more than half of its accepted connections, a client that connected
+// or failed a real attempt inside its open window, failed fast outside one,
+// or a run in which nothing failed fast at all.
+//
+//   ./flapping_test [-c clients] [-u upMs] [-d downMs] [-n cycles]
+//                   [-i initMs] [-m maxMs] [-k failures] [-o openMs] [-p port]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+int g_clients = 200;
+int g_upMs = 1500;
+int g_downMs = 2000;
+int g_cycles = 3;
+int g_initMs = 100;
+int g_maxMs = 2000;
+int g_breakerFailures = 4;
+int g_breakerOpenMs = 1000;
+uint16_t g_port = 12347;
+
+constexpr int kBucketMs = 100;
+// callbacks run a little after the breaker's own deadline is set
+constexpr auto kBreakerSlack = std::chrono::milliseconds(5);
+
+// one per client, only touched in the client's loop
+struct BreakerWindow {
+    std::chrono::steady_clock::time_point openUntil;
+};
+
+std::atomic<int64_t> g_failedAttempts(0);
+std::atomic<int64_t> g_failFast(0);
+std::atomic<int> g_connected(0);
+std::atomic<int64_t> g_attemptsWhileOpen(0);
+std::atomic<int64_t> g_failFastWhileClosed(0);
+bool g_clustered = false;
+std::atomic<bool> g_stopping(false);
+
+EventLoop* g_loop;
+std::unique_ptr<TcpServer> g_server;
+std::chrono::steady_clock::time_point g_openedAt;
+std::vector<int> g_buckets;
+int g_cycle = 0;
+
+void onServerConnection(const TcpConnectionPtr& conn) {
+    if (!conn->connected()) return;
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - g_openedAt)
+                  .count();
+    size_t bucket = static_cast<size_t>(ms / kBucketMs);
+    if (bucket >= g_buckets.size()) g_buckets.resize(bucket + 1);
+    ++g_buckets[bucket];
+}
+
+void openServer();
+
+void report() {
+    int total = 0;
+    int peak = 0;
+    for (int n : g_buckets) {
+        total += n;
+        peak = std::max(peak, n);
+    }
+    bool clustered = total == 0 || peak * 2 > total;
+    g_clustered = g_clustered || clustered;
+    printf("cycle %d: %d/%d accepted, peak %d per %dms%s, failed %lld, fail-fast %lld\n",
+           g_cycle, total, g_clients, peak, kBucketMs, clustered ? " (CLUSTERED)" : "",
+           static_cast<long long>(g_failedAttempts.load()),
+           static_cast<long long>(g_failFast.load()));
+    for (size_t i = 0; i < g_buckets.size(); ++i) {
+        if (g_buckets[i] == 0) continue;
+        printf("  %5zums %4d %s\n", i * kBucketMs, g_buckets[i],
+               string(std::min(g_buckets[i], 60), '#').c_str());
+    }
+    fflush(stdout);
+}
+
+void closeServer() {
+    report();
+    g_server.reset();
+    if (++g_cycle > g_cycles) {
+        g_loop->quit();
+        return;
+    }
+    g_loop->runAfter(g_downMs / 1000.0, openServer);
+}
+
+void openServer() {
+    g_buckets.clear();
+    g_openedAt = std::chrono::steady_clock::now();
+    g_server.reset(new TcpServer(g_loop, InetAddress(g_port), "Flapping"));
+    g_server->setConnectionCallback(onServerConnection);
+    g_server->start();
+    g_loop->runAfter(g_upMs / 1000.0, closeServer);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "c:u:d:n:i:m:k:o:p:")) != -1) {
+        switch (opt) {
+            case 'c': g_clients = atoi(optarg); break;
+            case 'u': g_upMs = atoi(optarg); break;
+            case 'd': g_downMs = atoi(optarg); break;
+            case 'n': g_cycles = atoi(optarg); break;
+            case 'i': g_initMs = atoi(optarg); break;
+            case 'm': g_maxMs = atoi(optarg); break;
+            case 'k': g_breakerFailures = atoi(optarg); break;
+            case 'o': g_breakerOpenMs = atoi(optarg); break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of flapping.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::critical);
+
+    EventLoop loop;
+    g_loop = &loop;
+
+    EventLoopThreadPool clientLoops(&loop, "client");
+    clientLoops.setThreadNum(2);
+    clientLoops.start();
+
+    InetAddress serverAddr("127.0.0.1", g_port);
+    std::vector<std::unique_ptr<TcpClient>> clients;
+    std::vector<BreakerWindow> windows(g_clients);
+    for (int i = 0; i < g_clients; ++i) {
+        char name[32];
+        snprintf(name, sizeof name, "client%d", i);
+        clients.emplace_back(new TcpClient(clientLoops.getNextLoop(), serverAddr, name));
+        TcpClient* client = clients.back().get();
+        client->enableRetry();
+        client->setRetryDelay(g_initMs, g_maxMs);
+        client->setCircuitBreaker(g_breakerFailures, g_breakerOpenMs);
+        BreakerWindow* window = &windows[i];
+        client->setConnectionCallback([window](const TcpConnectionPtr& conn) {
+            if (conn->connected() &&
+                std::chrono::steady_clock::now() + kBreakerSlack < window->openUntil) {
+                g_attemptsWhileOpen.fetch_add(1);
+            }
+            g_connected.fetch_add(conn->connected() ? 1 : -1);
+        });
+        client->setConnectFailedCallback([window, client](int failures, bool circuitOpen) {
+            auto now = std::chrono::steady_clock::now();
+            if (circuitOpen) {
+                if (now > window->openUntil) g_failFastWhileClosed.fetch_add(1);
+                g_failFast.fetch_add(1);
+                return;
+            }
+            if (now + kBreakerSlack < window->openUntil) g_attemptsWhileOpen.fetch_add(1);
+            if (g_breakerFailures > 0 && failures >= g_breakerFailures) {
+                window->openUntil = now + std::chrono::milliseconds(g_breakerOpenMs);
+                // an impatient caller: must fail fast without touching the kernel
+                client->getLoop()->runAfter(g_breakerOpenMs / 2000.0, [client] {
+                    if (!g_stopping) client->connect();
+                });
+            }
+            g_failedAttempts.fetch_add(1);
+        });
+    }
+
+    // clients start while the listener is down, as after a backend restart
+    for (auto& client : clients) client->connect();
+    loop.runAfter(g_downMs / 1000.0, openServer);
+    loop.loop();
+
+    g_stopping = true;
+    for (auto& client : clients) client->stop();
+    // without a breaker there is nothing to fail fast
+    bool failedFast = g_breakerFailures <= 0 || g_failFast > 0;
+    bool ok = !g_clustered && g_attemptsWhileOpen == 0 && g_failFastWhileClosed == 0 &&
+              failedFast;
+    printf("%s: attempts while open %lld, fail-fast %lld (%lld while closed), %s\n",
+           ok ? "PASS" : "FAIL", static_cast<long long>(g_attemptsWhileOpen.load()),
+           static_cast<long long>(g_failFast.load()),
+           static_cast<long long>(g_failFastWhileClosed.load()),
+           g_clustered ? "reconnects clustered" : "reconnects spread");
+    fflush(stdout);
+    _exit(ok ? 0 : 1);
+}
@@ -0,0 +1,150 @@
+// Post-and-run cost of loop functors, std::function vs InplaceFunction.
+//
+// "queue" stores <count> callables of each capture shape in a vector and
+// runs them, the way EventLoop::doPendingFunctors() does, once with
+// std::function<void()> (the old Functor) and once with InplaceFunction.
+// "loop" posts the same shapes through EventLoop::queueInLoop() from the
+// loop thread and times until the last one ran. Heap allocations per
+// callable are counted with a replaced operator new.
+//
+//   ./functor_bench [-n count] [-r rounds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "siren/base/InplaceFunction.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+std::atomic<uint64_t> g_allocs(0);
+
+}  // namespace
+
+void* operator new(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+namespace {
+
+int g_count = 100000;
+int g_rounds = 5;
+uint64_t g_sink = 0;
+
+struct Conn : std::enable_shared_from_this<Conn> {
+    void onWrite() { ++g_sink; }
+    void onMessage(const std::string& s) { g_sink += s.size(); }
+};
+
+// the shapes TcpConnection and TimerQueue post
+template <typename F>
+F makeShape(int shape, const std::shared_ptr<Conn>& conn, const std::function<void(const std::shared_ptr<Conn>&)>& cb) {
+    switch (shape) {
+        case 0:  // this + one pointer
+            return F([c = conn.get()] { c->onWrite(); });
+        case 1:  // std::bind(&Conn::f, shared_from_this())
+            return F(std::bind(&Conn::onWrite, conn));
+        case 2:  // std::bind(writeCompleteCallback_, shared_from_this())
+            return F(std::bind(cb, conn));
+        default:  // shared_ptr plus a short string, as sendInLoop posts
+            return F([conn, s = std::string("hello")] { conn->onMessage(s); });
+    }
+}
+
+const char* kShapeNames[] = {"raw ptr", "bind(mem_fn, shared_ptr)",
+                             "bind(std::function, shared_ptr)", "shared_ptr + string"};
+
+template <typename F>
+void benchQueue(const char* name, int shape, const std::shared_ptr<Conn>& conn,
+                const std::function<void(const std::shared_ptr<Conn>&)>& cb) {
+    double best = 1e30;
+    uint64_t allocs = 0;
+    for (int r = 0; r < g_rounds; ++r) {
+        std::vector<F> pending;
+        pending.reserve(static_cast<size_t>(g_count));
+        uint64_t before = g_allocs.load();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < g_count; ++i) pending.push_back(makeShape<F>(shape, conn, cb));
+        std::vector<F> running;
+        running.swap(pending);
+        for (const F& f : running) f();
+        running.clear();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        allocs = g_allocs.load() - before;
+        best = std::min(best, ns / g_count);
+    }
+    printf("  %-16s %-34s %7.1f ns  %.2f allocs\n", name, kShapeNames[shape], best,
+           static_cast<double>(allocs) / g_count);
+}
+
+void benchLoop(EventLoop* loop, int shape, const std::shared_ptr<Conn>& conn,
+               const std::function<void(const std::shared_ptr<Conn>&)>& cb) {
+    double best = 1e30;
+    uint64_t allocs = 0;
+    for (int r = 0; r < g_rounds; ++r) {
+        uint64_t before = g_allocs.load();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < g_count; ++i) loop->queueInLoop(makeShape<Functor>(shape, conn, cb));
+        // runs after everything queued above
+        loop->queueInLoop([&, before, start] {
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            allocs = g_allocs.load() - before;
+            best = std::min(best, ns / g_count);
+            loop->quit();
+        });
+        loop->wakeup();  // queued before loop(), nothing else would wake it
+        loop->loop();
+    }
+    printf("  %-16s %-34s %7.1f ns  %.2f allocs\n", "queueInLoop", kShapeNames[shape], best,
+           static_cast<double>(allocs) / g_count);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch (opt) {
+            case 'n': g_count = std::max(1, atoi(optarg)); break;
+            case 'r': g_rounds = std::max(1, atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+    auto conn = std::make_shared<Conn>();
+    std::function<void(const std::shared_ptr<Conn>&)> cb = [](const std::shared_ptr<Conn>& c) {
+        c->onWrite();
+    };
+
+    printf("post-and-run per callable, best of %d rounds of %d\n", g_rounds, g_count);
+    printf("vector of pending functors:\n");
+    for (int shape = 0; shape < 4; ++shape) {
+        benchQueue<std::function<void()>>("std::function", shape, conn, cb);
+        benchQueue<InplaceFunction<void()>>("InplaceFunction", shape, conn, cb);
+    }
+    printf("EventLoop, Functor = InplaceFunction<void(), %zu>:\n", Functor::kCapacity);
+    EventLoop loop;
+    for (int shape = 0; shape < 4; ++shape) benchLoop(&loop, shape, conn, cb);
+    printf("sink %llu\n", static_cast<unsigned long long>(g_sink));
+    fflush(stdout);
+    _exit(0);
+}
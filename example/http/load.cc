@@ -0,0 +1,192 @@
+// wrk-style HTTP/1.1 load generator.
+//
+// <connections> keep-alive connections spread over <threads> loops. Each
+// connection keeps <pipeline> GET requests in flight: once all responses
+// of a batch are in, the next batch is sent. Latency is measured from the
+// batch's send to each response.
+//
+//   ./http_load [-c connections] [-t threads] [-d seconds] [-P pipeline]
+//               [-H host] [-p port] [-u path]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+int g_connections = 64;
+int g_threads = 2;
+int g_seconds = 5;
+int g_pipeline = 1;
+string g_host = "127.0.0.1";
+uint16_t g_port = 8000;
+string g_path = "/";
+
+std::atomic<bool> g_stop(false);
+std::mutex g_mutex;
+std::vector<int64_t> g_latencies;  // microseconds
+int64_t g_errors = 0;
+
+class Session : noncopyable {
+   public:
+    Session(EventLoop* loop, const InetAddress& addr, const string& name)
+        : client_(loop, addr, name) {
+        client_.setConnectionCallback(std::bind(&Session::onConnection, this, _1));
+        client_.setMessageCallback(std::bind(&Session::onMessage, this, _1, _2, _3));
+        string request = "GET " + g_path + " HTTP/1.1\r\nHost: " + g_host + "\r\n\r\n";
+        for (int i = 0; i < g_pipeline; ++i) batch_ += request;
+        latencies_.reserve(1 << 16);
+    }
+
+    void start() { client_.connect(); }
+    EventLoop* getLoop() const { return client_.getLoop(); }
+
+    void collect() {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_latencies.insert(g_latencies.end(), latencies_.begin(), latencies_.end());
+        g_errors += errors_;
+    }
+
+   private:
+    void onConnection(const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            conn->setTcpNoDelay(true);
+            sendBatch(conn);
+        }
+    }
+
+    void sendBatch(const TcpConnectionPtr& conn) {
+        if (g_stop) return;
+        outstanding_ = g_pipeline;
+        sentAt_ = std::chrono::steady_clock::now();
+        conn->send(batch_);
+    }
+
+    void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+        while (true) {
+            const char* begin = buf->peek();
+            const char* end = begin + buf->readableBytes();
+            const char* headerEnd = static_cast<const char*>(
+                memmem(begin, buf->readableBytes(), "\r\n\r\n", 4));
+            if (headerEnd == nullptr) break;
+            headerEnd += 4;
+
+            size_t contentLength = 0;
+            for (const char* p = begin; p < headerEnd;) {
+                const char* eol = static_cast<const char*>(memmem(p, headerEnd - p, "\r\n", 2));
+                if (eol - p > 15 && strncasecmp(p, "Content-Length:", 15) == 0) {
+                    contentLength = strtoul(p + 15, nullptr, 10);
+                }
+                p = eol + 2;
+            }
+            if (static_cast<size_t>(end - headerEnd) < contentLength) break;
+            if (strncmp(begin, "HTTP/1.1 200", 12) != 0) ++errors_;
+            buf->retrieve(static_cast<int>(headerEnd - begin + contentLength));
+
+            latencies_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now() - sentAt_)
+                                     .count());
+            if (--outstanding_ == 0) {
+                sendBatch(conn);
+            }
+        }
+    }
+
+    TcpClient client_;
+    string batch_;
+    int outstanding_ = 0;
+    std::chrono::steady_clock::time_point sentAt_;
+    std::vector<int64_t> latencies_;
+    int64_t errors_ = 0;
+};
+
+int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[index];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "c:t:d:P:H:p:u:")) != -1) {
+        switch (opt) {
+            case 'c': g_connections = atoi(optarg); break;
+            case 't': g_threads = atoi(optarg); break;
+            case 'd': g_seconds = atoi(optarg); break;
+            case 'P': g_pipeline = std::max(1, atoi(optarg)); break;
+            case 'H': g_host = optarg; break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            case 'u': g_path = optarg; break;
+            default:
+                fprintf(stderr, "see the header of load.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, "load");
+    pool.setThreadNum(g_threads);
+    pool.start();
+
+    InetAddress serverAddr(g_host, g_port);
+    std::vector<std::unique_ptr<Session>> sessions;
+    for (int i = 0; i < g_connections; ++i) {
+        char name[32];
+        snprintf(name, sizeof name, "load%d", i);
+        sessions.emplace_back(new Session(pool.getNextLoop(), serverAddr, name));
+        sessions.back()->start();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    loop.runAfter(g_seconds, [&] {
+        g_stop = true;
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        // sessions are only touched by their own loops, collect there
+        CountDownLatch latch(static_cast<int>(sessions.size()));
+        for (auto& session : sessions) {
+            Session* s = session.get();
+            s->getLoop()->runInLoop([s, &latch] {
+                s->collect();
+                latch.countDown();
+            });
+        }
+        latch.wait();
+
+        std::sort(g_latencies.begin(), g_latencies.end());
+        printf("%d connections, %d threads, pipeline %d, %ds\n", g_connections, g_threads,
+               g_pipeline, g_seconds);
+        printf("  requests %zu, errors %lld, %.0f req/s\n", g_latencies.size(),
+               static_cast<long long>(g_errors),
+               static_cast<double>(g_latencies.size()) / seconds);
+        printf("  latency us: p50 %lld  p90 %lld  p99 %lld  max %lld\n",
+               static_cast<long long>(percentile(g_latencies, 0.50)),
+               static_cast<long long>(percentile(g_latencies, 0.90)),
+               static_cast<long long>(percentile(g_latencies, 0.99)),
+               static_cast<long long>(g_latencies.empty() ? 0 : g_latencies.back()));
+        fflush(stdout);
+        _exit(0);
+    });
+    loop.loop();
+}
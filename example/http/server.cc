@@ -0,0 +1,48 @@
+// Hello-world HttpServer, the target for http_load.
+//
+//   ./http_server [threads] [port]
+//
+// GET /        -> "hello, world!\n"
+// GET /echo?x  -> the query string
+// POST /echo   -> the request body
+
+#include <stdlib.h>
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/http/HttpRequest.h"
+#include "siren/net/http/HttpResponse.h"
+#include "siren/net/http/HttpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+void onRequest(const HttpRequest& req, HttpResponse* resp) {
+    if (req.path() == "/") {
+        resp->setStatusCode(HttpResponse::k200Ok);
+        resp->setContentType("text/plain");
+        resp->setBody("hello, world!\n");
+    } else if (req.path() == "/echo") {
+        resp->setStatusCode(HttpResponse::k200Ok);
+        resp->setContentType("text/plain");
+        resp->setBody(req.method() == HttpRequest::kPost ? req.body() : req.query());
+    } else {
+        resp->setStatusCode(HttpResponse::k404NotFound);
+        resp->setContentType("text/plain");
+        resp->setBody("not found\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : 0;
+    uint16_t port = static_cast<uint16_t>(argc > 2 ? atoi(argv[2]) : 8000);
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    EventLoop loop;
+    HttpServer server(&loop, InetAddress(port), "HttpServer");
+    server.setHttpCallback(onRequest);
+    server.setThreadNum(threads);
+    server.start();
+    loop.loop();
+}
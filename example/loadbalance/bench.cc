@@ -0,0 +1,214 @@
+// Skewed-load benchmark for EventLoopThreadPool strategies.
+//
+// One process runs a TcpServer with <threads> IO loops and a client pool.
+// Every <heavyEvery>-th connection is "heavy": the server burns <heavyUs>
+// of CPU per request, other connections cost <lightUs>. Connections are
+// opened one by one, so with round-robin all heavy connections land on the
+// same loop. Each connection runs a closed-loop request/response and the
+// RTT of the light connections is reported. "hash" keys on the peer IP,
+// so here, with every client on 127.0.0.1, all connections share one loop.
+//
+//   for s in rr lc cpu hash; do ./loadbalance_bench -s $s; done
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "siren/base/Logger.h"
+#include "siren/net/Endian.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+int g_threads = 4;
+int g_sessions = 32;
+int g_heavyEvery = 4;
+int g_heavyUs = 500;
+int g_lightUs = 20;
+int g_seconds = 5;
+uint16_t g_port = 12345;
+EventLoopThreadPool::Strategy g_strategy = EventLoopThreadPool::kRoundRobin;
+
+void burn(int micros) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(micros);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+// request: 4-byte cost in microseconds, response: the same 4 bytes
+void onServerMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    while (buf->readableBytes() >= sizeof(uint32_t)) {
+        uint32_t be;
+        memcpy(&be, buf->peek(), sizeof be);
+        burn(static_cast<int>(sockets::networkToHost32(be)));
+        conn->send(buf->peek(), sizeof be);
+        buf->retrieve(sizeof be);
+    }
+}
+
+class Session : noncopyable {
+   public:
+    Session(EventLoop* loop, const InetAddress& addr, const string& name, int cost, bool measure)
+        : client_(loop, addr, name), cost_(cost), measure_(measure) {
+        client_.setConnectionCallback(std::bind(&Session::onConnection, this, _1));
+        client_.setMessageCallback(std::bind(&Session::onMessage, this, _1, _2, _3));
+    }
+
+    void start() { client_.connect(); }
+    void stop() { stopped_ = true; }
+    bool connected() const { return connected_; }
+    const std::vector<int64_t>& rtts() const { return rtts_; }
+
+   private:
+    void onConnection(const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            conn->setTcpNoDelay(true);
+            connected_ = true;
+            sendRequest(conn);
+        }
+    }
+
+    void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+        while (buf->readableBytes() >= sizeof(uint32_t)) {
+            buf->retrieve(sizeof(uint32_t));
+            if (measure_) {
+                rtts_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                    std::chrono::steady_clock::now() - sent_)
+                                    .count());
+            }
+            if (!stopped_) sendRequest(conn);
+        }
+    }
+
+    void sendRequest(const TcpConnectionPtr& conn) {
+        uint32_t be = sockets::hostToNetwork32(static_cast<uint32_t>(cost_));
+        sent_ = std::chrono::steady_clock::now();
+        conn->send(&be, sizeof be);
+    }
+
+    TcpClient client_;
+    const int cost_;
+    const bool measure_;
+    std::atomic<bool> stopped_{false};
+    std::atomic<bool> connected_{false};
+    std::chrono::steady_clock::time_point sent_;
+    std::vector<int64_t> rtts_;
+};
+
+const char* strategyName(EventLoopThreadPool::Strategy s) {
+    switch (s) {
+        case EventLoopThreadPool::kLeastConnections:
+            return "least-connections";
+        case EventLoopThreadPool::kLeastCpuTime:
+            return "least-cpu-time";
+        case EventLoopThreadPool::kConsistentHash:
+            return "consistent-hash";
+        default:
+            return "round-robin";
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int c;
+    while ((c = getopt(argc, argv, "s:t:n:e:H:L:d:p:")) != -1) {
+        switch (c) {
+            case 's':
+                if (strcmp(optarg, "lc") == 0)
+                    g_strategy = EventLoopThreadPool::kLeastConnections;
+                else if (strcmp(optarg, "cpu") == 0)
+                    g_strategy = EventLoopThreadPool::kLeastCpuTime;
+                else if (strcmp(optarg, "hash") == 0)
+                    g_strategy = EventLoopThreadPool::kConsistentHash;
+                else
+                    g_strategy = EventLoopThreadPool::kRoundRobin;
+                break;
+            case 't': g_threads = atoi(optarg); break;
+            case 'n': g_sessions = atoi(optarg); break;
+            case 'e': g_heavyEvery = atoi(optarg); break;
+            case 'H': g_heavyUs = atoi(optarg); break;
+            case 'L': g_lightUs = atoi(optarg); break;
+            case 'd': g_seconds = atoi(optarg); break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            default:
+                fprintf(stderr,
+                        "Usage: %s [-s rr|lc|cpu|hash] [-t threads] [-n sessions] "
+                        "[-e heavyEvery] [-H heavyUs] [-L lightUs] [-d seconds] [-p port]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    EventLoop loop;
+    InetAddress addr("127.0.0.1", g_port);
+    TcpServer server(&loop, addr, "lb");
+    server.setThreadNum(g_threads);
+    server.setLoopStrategy(g_strategy);
+    server.setMessageCallback(onServerMessage);
+    server.start();
+
+    EventLoopThreadPool clientPool(&loop, "lb-client");
+    clientPool.setThreadNum(2);
+    clientPool.start();
+
+    std::vector<std::unique_ptr<Session>> sessions;
+    for (int i = 0; i < g_sessions; ++i) {
+        char name[32];
+        snprintf(name, sizeof name, "S%04d", i);
+        bool heavy = g_heavyEvery > 0 && i % g_heavyEvery == 0;
+        sessions.emplace_back(new Session(clientPool.getNextLoop(), addr, name,
+                                          heavy ? g_heavyUs : g_lightUs, !heavy));
+    }
+
+    // open connections one by one so that the accept order is deterministic
+    const double kRampInterval = 0.02;
+    for (int i = 0; i < g_sessions; ++i) {
+        Session* session = sessions[i].get();
+        loop.runAfter(kRampInterval * (i + 1), [session] { session->start(); });
+    }
+
+    double ramp = kRampInterval * (g_sessions + 1);
+    loop.runAfter(ramp + g_seconds, [&] {
+        for (auto& session : sessions) session->stop();
+        loop.runAfter(0.5, [&] { loop.quit(); });
+    });
+    loop.loop();
+
+    std::vector<int64_t> all;
+    for (const auto& session : sessions) {
+        all.insert(all.end(), session->rtts().begin(), session->rtts().end());
+    }
+    std::sort(all.begin(), all.end());
+    auto pct = [&all](double p) -> int64_t {
+        if (all.empty()) return 0;
+        size_t idx = std::min(all.size() - 1, static_cast<size_t>(p * all.size()));
+        return all[idx];
+    };
+
+    std::vector<int> perLoop;
+    for (EventLoop* ioLoop : server.threadPool()->getAllLoops()) {
+        perLoop.push_back(ioLoop->connectionCount());
+    }
+    printf("%-18s light requests %8zu  p50 %6ld us  p99 %6ld us  p99.9 %6ld us  max %6ld us\n",
+           strategyName(g_strategy), all.size(), pct(0.50), pct(0.99), pct(0.999),
+           all.empty() ? 0L : all.back());
+    printf("connections per loop:");
+    for (int n : perLoop) printf(" %d", n);
+    printf("\n");
+    fflush(stdout);
+    _exit(0);  // skip tearing down the client/server loops
+}
@@ -0,0 +1,141 @@
+// Cost of LOG_* calls that end up discarded.
+//
+// "call": ns per call of a disabled trace statement with three integer
+// arguments and with a string built for it (Channel logs reventsToString()
+// that way), written the old way through Logger::getInstance().getLogger(),
+// through the cached handle with the level check first, and as LOG_TRACE
+// at this build's SIREN_ACTIVE_LEVEL.
+// "pingpong": 64-byte round trips over loopback between two loops in this
+// process; reports round trips per second and process CPU time per round
+// trip, which covers every poll, channel and timer event on both sides.
+// Compare builds configured with -DSIREN_ACTIVE_LEVEL=0 and the default.
+//
+//   ./logcost_bench [-n calls] [-r roundtrips] [-p port]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThread.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+int g_calls = 10000000;
+int g_roundTrips = 100000;
+uint16_t g_port = 23457;
+
+int g_done = 0;
+std::string g_message(64, 'x');
+std::chrono::steady_clock::time_point g_start;
+double g_cpuStart = 0;
+
+double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+std::string eventsString(int i) {
+    return "fd " + std::to_string(i) + ": IN ";
+}
+
+template <typename F>
+void timeCalls(const char* name, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < g_calls; ++i) f(i);
+    double ns =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("  %-44s %7.2f ns\n", name, ns / g_calls);
+}
+
+void onClientConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        conn->setTcpNoDelay(true);
+        g_start = std::chrono::steady_clock::now();
+        g_cpuStart = cpuSeconds();
+        conn->send(g_message);
+    }
+}
+
+void onClientMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    if (buf->readableBytes() < g_message.size()) return;
+    buf->retrieve(static_cast<int>(g_message.size()));
+    if (++g_done >= g_roundTrips) {
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - g_start).count();
+        double cpu = cpuSeconds() - g_cpuStart;
+        printf("  %d round trips  %9.0f rt/s  %7.2f us cpu per round trip\n", g_done,
+               g_done / seconds, cpu * 1e6 / g_done);
+        fflush(stdout);
+        _exit(0);  // skip tearing down both loops
+    }
+    conn->send(g_message);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:p:")) != -1) {
+        switch (opt) {
+            case 'n': g_calls = std::max(1, atoi(optarg)); break;
+            case 'r': g_roundTrips = std::max(1, atoi(optarg)); break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    printf("SIREN_ACTIVE_LEVEL %d, runtime level warn\n", SIREN_ACTIVE_LEVEL);
+    printf("call:\n");
+    timeCalls("getInstance().getLogger().trace(3 ints)", [](int i) {
+        Logger::getInstance().getLogger().trace("fd = {}, events = {}, index = {}", i, i + 1, i + 2);
+    });
+    timeCalls("getInstance().getLogger().trace(string)",
+              [](int i) { Logger::getInstance().getLogger().trace(eventsString(i)); });
+    timeCalls("handle + level check, 3 ints", [](int i) {
+        SIREN_LOG_(spdlog::level::trace, "fd = {}, events = {}, index = {}", i, i + 1, i + 2);
+    });
+    timeCalls("handle + level check, string",
+              [](int i) { SIREN_LOG_(spdlog::level::trace, eventsString(i)); });
+    timeCalls("LOG_TRACE(3 ints)",
+              [](int i) { LOG_TRACE("fd = {}, events = {}, index = {}", i, i + 1, i + 2); });
+    timeCalls("LOG_TRACE(string)", [](int i) { LOG_TRACE(eventsString(i)); });
+
+    printf("pingpong:\n");
+    fflush(stdout);
+    InetAddress addr("127.0.0.1", g_port);
+    EventLoopThread serverThread;
+    EventLoop* serverLoop = serverThread.startLoop();
+    TcpServer server(serverLoop, addr, "logcost");
+    server.setMessageCallback(
+        [](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) { conn->send(buf); });
+    CountDownLatch started(1);
+    serverLoop->runInLoop([&] {
+        server.start();
+        started.countDown();
+    });
+    started.wait();
+
+    EventLoop loop;
+    TcpClient client(&loop, addr, "logcost-client");
+    client.setConnectionCallback(onClientConnection);
+    client.setMessageCallback(onClientMessage);
+    client.connect();
+    loop.loop();
+}
@@ -0,0 +1,73 @@
+// Time taken by EventLoopThreadPool::start() and by tearing the pool down.
+//
+// Every round builds a pool of <threads> loop threads on a fresh base loop,
+// times start() until every loop runs, then times the destructor joining
+// them. Reports min / median / max over <rounds>.
+//
+//   ./loopstart_bench [-t threads] [-r rounds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+int g_threads = 64;
+int g_rounds = 20;
+
+double micros(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+void report(const char* name, std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    printf("  %-8s min %9.0f us  median %9.0f us  max %9.0f us\n", name, samples.front(),
+           samples[samples.size() / 2], samples.back());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "t:r:")) != -1) {
+        switch (opt) {
+            case 't': g_threads = std::max(1, atoi(optarg)); break;
+            case 'r': g_rounds = std::max(1, atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    EventLoop baseLoop;
+    std::vector<double> starts, stops;
+    for (int r = 0; r < g_rounds; ++r) {
+        auto pool = std::make_unique<EventLoopThreadPool>(&baseLoop, "bench");
+        pool->setThreadNum(g_threads);
+        auto start = std::chrono::steady_clock::now();
+        pool->start();
+        starts.push_back(micros(start));
+        start = std::chrono::steady_clock::now();
+        pool.reset();
+        stops.push_back(micros(start));
+    }
+    printf("EventLoopThreadPool of %d threads, %d rounds\n", g_threads, g_rounds);
+    report("start", starts);
+    report("stop", stops);
+    fflush(stdout);
+    _exit(0);
+}
@@ -0,0 +1,137 @@
+#include "Shard.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace memcache;
+
+const size_t Arena::kChunkSize;
+const size_t Shard::kMaxItemSize;
+
+Arena::~Arena() {
+    for (char* chunk : chunks_) ::free(chunk);
+}
+
+void* Arena::allocate(size_t size, int* sizeClass) {
+    int cls = 0;
+    size_t classSize = kMinClassSize;
+    while (classSize < size) {
+        classSize <<= 1;
+        ++cls;
+    }
+    if (cls >= kNumClasses) return nullptr;
+    *sizeClass = cls;
+
+    if (FreeNode* node = freeLists_[cls]) {
+        freeLists_[cls] = node->next;
+        return node;
+    }
+    if (remaining_ < classSize) {
+        if (allocatedBytes() + kChunkSize > limitBytes_) return nullptr;
+        // the tail of the old chunk is given up
+        cursor_ = static_cast<char*>(::malloc(kChunkSize));
+        if (cursor_ == nullptr) return nullptr;
+        chunks_.push_back(cursor_);
+        remaining_ = kChunkSize;
+    }
+    void* p = cursor_;
+    cursor_ += classSize;
+    remaining_ -= classSize;
+    return p;
+}
+
+void Arena::deallocate(void* p, int sizeClass) {
+    FreeNode* node = static_cast<FreeNode*>(p);
+    node->next = freeLists_[sizeClass];
+    freeLists_[sizeClass] = node;
+}
+
+size_t Shard::probe(std::string_view key, uint64_t hash, bool* found) const {
+    size_t mask = slots_.size() - 1;
+    size_t firstFree = slots_.size();
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Item* item = slots_[i];
+        if (item == nullptr) {
+            *found = false;
+            return firstFree != slots_.size() ? firstFree : i;
+        }
+        if (item == tombstone()) {
+            if (firstFree == slots_.size()) firstFree = i;
+        } else if (item->hash == hash && item->key() == key) {
+            *found = true;
+            return i;
+        }
+    }
+}
+
+void Shard::grow() {
+    std::vector<Item*> old;
+    old.swap(slots_);
+    // mostly tombstones: rehash in place instead of doubling
+    size_t capacity = old.empty() ? 1024 : old.size();
+    if ((size_ + 1) * 2 > capacity) capacity *= 2;
+    slots_.assign(capacity, nullptr);
+    size_t mask = slots_.size() - 1;
+    for (Item* item : old) {
+        if (item == nullptr || item == tombstone()) continue;
+        size_t i = item->hash & mask;
+        while (slots_[i] != nullptr) i = (i + 1) & mask;
+        slots_[i] = item;
+    }
+    used_ = size_;
+}
+
+Item* Shard::find(std::string_view key, uint64_t hash) {
+    if (slots_.empty()) return nullptr;
+    bool found;
+    size_t i = probe(key, hash, &found);
+    return found ? slots_[i] : nullptr;
+}
+
+Shard::SetResult Shard::set(SetMode mode, std::string_view key, uint64_t hash,
+                            uint32_t flags, std::string_view value) {
+    // keep the load factor, tombstones included, under 0.7
+    if ((used_ + 1) * 10 > slots_.size() * 7) grow();
+
+    bool found;
+    size_t i = probe(key, hash, &found);
+    if ((mode == kAdd && found) || (mode == kReplace && !found)) {
+        return kNotStored;
+    }
+
+    size_t size = sizeof(Item) + key.size() + value.size();
+    if (size > kMaxItemSize) return kNoMemory;
+    int sizeClass;
+    void* p = arena_.allocate(size, &sizeClass);
+    if (p == nullptr) return kNoMemory;
+
+    Item* item = static_cast<Item*>(p);
+    item->hash = hash;
+    item->flags = flags;
+    item->keyLen = static_cast<uint32_t>(key.size());
+    item->valueLen = static_cast<uint32_t>(value.size());
+    item->sizeClass = sizeClass;
+    memcpy(item->data(), key.data(), key.size());
+    memcpy(item->data() + key.size(), value.data(), value.size());
+
+    if (found) {
+        Item* old = slots_[i];
+        arena_.deallocate(old, old->sizeClass);
+    } else {
+        if (slots_[i] == nullptr) ++used_;
+        ++size_;
+    }
+    slots_[i] = item;
+    return kStored;
+}
+
+bool Shard::remove(std::string_view key, uint64_t hash) {
+    if (slots_.empty()) return false;
+    bool found;
+    size_t i = probe(key, hash, &found);
+    if (!found) return false;
+    arena_.deallocate(slots_[i], slots_[i]->sizeClass);
+    slots_[i] = tombstone();
+    --size_;
+    return true;
+}
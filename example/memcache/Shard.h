@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+#include <vector>
+
+#include "siren/base/noncopyable.h"
+
+namespace memcache {
+
+// Size-classed arena: items are carved out of 1 MiB chunks and recycled
+// through per-class free lists, chunks are never returned to malloc.
+class Arena : siren::noncopyable {
+   public:
+    static const size_t kChunkSize = 1024 * 1024;
+    static const size_t kMinClassSize = 64;
+
+    explicit Arena(size_t limitBytes) : limitBytes_(limitBytes) {}
+    ~Arena();
+
+    // nullptr when the limit is reached
+    void* allocate(size_t size, int* sizeClass);
+    void deallocate(void* p, int sizeClass);
+
+    size_t allocatedBytes() const { return chunks_.size() * kChunkSize; }
+
+   private:
+    static const int kNumClasses = 15;  // 64 B .. 1 MiB
+
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    size_t limitBytes_;
+    std::vector<char*> chunks_;
+    char* cursor_ = nullptr;
+    size_t remaining_ = 0;
+    FreeNode* freeLists_[kNumClasses] = {};
+};
+
+struct Item {
+    uint64_t hash;
+    uint32_t flags;
+    uint32_t keyLen;
+    uint32_t valueLen;
+    int32_t sizeClass;
+
+    char* data() { return reinterpret_cast<char*>(this + 1); }
+    std::string_view key() { return std::string_view(data(), keyLen); }
+    std::string_view value() { return std::string_view(data() + keyLen, valueLen); }
+};
+
+// One loop's share of the cache: an open-addressing table with linear
+// probing whose items live in the shard's own arena. Only the owning loop
+// touches it, so nothing here is locked.
+class Shard : siren::noncopyable {
+   public:
+    enum SetMode { kSet, kAdd, kReplace };
+    enum SetResult { kStored, kNotStored, kNoMemory };
+
+    static const size_t kMaxItemSize = Arena::kChunkSize;
+
+    explicit Shard(size_t limitBytes) : arena_(limitBytes) {}
+
+    Item* find(std::string_view key, uint64_t hash);
+    SetResult set(SetMode mode, std::string_view key, uint64_t hash, uint32_t flags,
+                  std::string_view value);
+    bool remove(std::string_view key, uint64_t hash);
+
+    size_t size() const { return size_; }
+
+   private:
+    // probe for key, @return its slot or the first usable slot
+    size_t probe(std::string_view key, uint64_t hash, bool* found) const;
+    void grow();
+
+    static Item* tombstone() { return reinterpret_cast<Item*>(1); }
+
+    Arena arena_;
+    std::vector<Item*> slots_;  // nullptr: empty, tombstone(): deleted
+    size_t size_ = 0;
+    size_t used_ = 0;  // live items plus tombstones
+};
+
+}  // namespace memcache
@@ -0,0 +1,242 @@
+// memcached text-protocol load generator.
+//
+// <clients> connections over <threads> loops keep <pipeline> requests in
+// flight each, for <seconds>. Requests are get or set on <keys> random
+// keys with <valueSize>-byte values, <getPercent>% of them gets. Keys are
+// preloaded first so that gets hit.
+//
+//   ./memcache_bench [-h host] [-p port] [-c clients] [-T threads] [-d seconds]
+//                    [-P pipeline] [-k keys] [-s valueSize] [-g getPercent]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+string g_host = "127.0.0.1";
+uint16_t g_port = 11211;
+int g_clients = 64;
+int g_threads = 2;
+int g_seconds = 5;
+int g_pipeline = 8;
+int g_keys = 100000;
+size_t g_valueSize = 100;
+int g_getPercent = 90;
+
+std::atomic<bool> g_stop(false);
+
+class Client : noncopyable {
+   public:
+    Client(EventLoop* loop, const InetAddress& addr, const string& name, int first, int step,
+           CountDownLatch* preloaded)
+        : client_(loop, addr, name),
+          rng_(std::random_device{}()),
+          value_(g_valueSize, 'v'),
+          nextPreload_(first),
+          step_(step),
+          preloaded_(preloaded) {
+        client_.setConnectionCallback(std::bind(&Client::onConnection, this, _1));
+        client_.setMessageCallback(std::bind(&Client::onMessage, this, _1, _2, _3));
+        latencies_.reserve(1 << 16);
+    }
+
+    void start() { client_.connect(); }
+    void run() {
+        client_.getLoop()->runInLoop([this] {
+            measuring_ = true;
+            if (conn_) sendBatch();
+        });
+    }
+    EventLoop* getLoop() const { return client_.getLoop(); }
+    const std::vector<int64_t>& latencies() const { return latencies_; }
+    int64_t misses() const { return misses_; }
+
+   private:
+    void onConnection(const TcpConnectionPtr& conn) {
+        if (!conn->connected()) return;
+        conn->setTcpNoDelay(true);
+        conn_ = conn;
+        preloadNext();
+    }
+
+    // a keys/clients share of "set" requests, one at a time
+    void preloadNext() {
+        if (nextPreload_ >= g_keys) {
+            preloading_ = false;
+            preloaded_->countDown();
+            return;
+        }
+        Buffer out;
+        appendSet(&out, nextPreload_);
+        nextPreload_ += step_;
+        outstanding_ = 1;
+        conn_->send(&out);
+    }
+
+    void appendSet(Buffer* out, int key) {
+        char line[96];
+        int n = snprintf(line, sizeof line, "set key:%d 0 0 %zu\r\n", key, value_.size());
+        out->append(line, static_cast<size_t>(n));
+        out->append(value_.data(), value_.size());
+        out->append("\r\n", 2);
+    }
+
+    void sendBatch() {
+        if (g_stop) return;
+        Buffer out;
+        for (int i = 0; i < g_pipeline; ++i) {
+            int key = static_cast<int>(rng_() % static_cast<unsigned>(g_keys));
+            if (static_cast<int>(rng_() % 100) < g_getPercent) {
+                char line[64];
+                int n = snprintf(line, sizeof line, "get key:%d\r\n", key);
+                out.append(line, static_cast<size_t>(n));
+            } else {
+                appendSet(&out, key);
+            }
+        }
+        outstanding_ = g_pipeline;
+        sentAt_ = std::chrono::steady_clock::now();
+        conn_->send(&out);
+    }
+
+    // one reply: "STORED", "END", or "VALUE ..." + data + "END"
+    void onMessage(const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        while (true) {
+            const char* begin = buf->peek();
+            size_t readable = buf->readableBytes();
+            const char* crlf = static_cast<const char*>(memmem(begin, readable, "\r\n", 2));
+            if (crlf == nullptr) break;
+            size_t replyBytes = static_cast<size_t>(crlf - begin) + 2;
+            if (strncmp(begin, "VALUE ", 6) == 0) {
+                const char* lastSpace = static_cast<const char*>(memrchr(begin, ' ', crlf - begin));
+                size_t bytes = strtoul(lastSpace + 1, nullptr, 10);
+                replyBytes += bytes + 2 + 5;  // data, CRLF, "END\r\n"
+                if (readable < replyBytes) break;
+            } else if (strncmp(begin, "END", 3) == 0) {
+                ++misses_;
+            }
+            buf->retrieve(static_cast<int>(replyBytes));
+
+            if (preloading_) {
+                preloadNext();
+                continue;
+            }
+            if (measuring_) {
+                latencies_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                         std::chrono::steady_clock::now() - sentAt_)
+                                         .count());
+            }
+            if (--outstanding_ == 0) sendBatch();
+        }
+    }
+
+    TcpClient client_;
+    TcpConnectionPtr conn_;
+    std::mt19937 rng_;
+    const string value_;
+    int nextPreload_;
+    int step_;
+    CountDownLatch* preloaded_;
+    bool preloading_ = true;
+    bool measuring_ = false;
+    int outstanding_ = 0;
+    std::chrono::steady_clock::time_point sentAt_;
+    std::vector<int64_t> latencies_;
+    int64_t misses_ = 0;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:c:T:d:P:k:s:g:")) != -1) {
+        switch (opt) {
+            case 'h': g_host = optarg; break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            case 'c': g_clients = atoi(optarg); break;
+            case 'T': g_threads = atoi(optarg); break;
+            case 'd': g_seconds = atoi(optarg); break;
+            case 'P': g_pipeline = std::max(1, atoi(optarg)); break;
+            case 'k': g_keys = std::max(1, atoi(optarg)); break;
+            case 's': g_valueSize = static_cast<size_t>(atoi(optarg)); break;
+            case 'g': g_getPercent = atoi(optarg); break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::err);
+
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, "bench");
+    pool.setThreadNum(std::max(1, g_threads));
+    pool.start();
+
+    InetAddress addr(g_host, g_port);
+    CountDownLatch preloaded(g_clients);
+    std::vector<std::unique_ptr<Client>> clients;
+    for (int i = 0; i < g_clients; ++i) {
+        char name[32];
+        snprintf(name, sizeof name, "mc%d", i);
+        clients.emplace_back(
+            new Client(pool.getNextLoop(), addr, name, i, g_clients, &preloaded));
+        clients.back()->start();
+    }
+    preloaded.wait();
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& c : clients) c->run();
+    sleep(static_cast<unsigned>(g_seconds));
+    g_stop = true;
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int64_t> latencies;
+    int64_t misses = 0;
+    std::mutex mutex;
+    CountDownLatch collected(g_clients);
+    for (auto& c : clients) {
+        Client* client = c.get();
+        client->getLoop()->runInLoop([&, client] {
+            std::lock_guard<std::mutex> lock(mutex);
+            latencies.insert(latencies.end(), client->latencies().begin(),
+                             client->latencies().end());
+            misses += client->misses();
+            collected.countDown();
+        });
+    }
+    collected.wait();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&](double p) -> long long {
+        if (latencies.empty()) return 0;
+        return latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))];
+    };
+    printf("%d clients, %d threads, pipeline %d, %d%% get, %zuB values\n", g_clients,
+           g_threads, g_pipeline, g_getPercent, g_valueSize);
+    printf("  %.0f req/s, misses %lld, latency us p50 %lld p99 %lld max %lld\n",
+           static_cast<double>(latencies.size()) / seconds, static_cast<long long>(misses),
+           pct(0.5), pct(0.99), latencies.empty() ? 0LL : static_cast<long long>(latencies.back()));
+    fflush(stdout);
+    _exit(0);
+}
@@ -0,0 +1,402 @@
+// Sharded memcached-protocol cache, one shard per EventLoop.
+//
+// Every IO loop owns one Shard (hash table + arena) and is the only thread
+// touching it. A connection's loop executes commands for its own shard
+// inline; commands for other shards are grouped per shard and forwarded
+// with one queueInLoop per shard per read, and the owner posts the
+// results back the same way. Replies are written in request order.
+//
+// With -x lock the shards are instead guarded by a mutex and every command
+// runs on the connection's loop, the baseline to compare forwarding with.
+//
+//   ./memcache_server [-t threads] [-p port] [-m MiBPerShard] [-x forward|lock]
+//
+// Supported: get, gets, set, add, replace, delete, version, stats, quit.
+// Expiration times are accepted and ignored.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Shard.h"
+#include "siren/base/Logger.h"
+#include "siren/base/Metrics.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+using namespace memcache;
+
+namespace {
+
+const size_t kMaxKeyLength = 250;
+const size_t kMaxLineLength = 2048;
+
+metrics::Counter& g_forwardedBatches = metrics::counter(
+    "memcache_forwarded_batches_total", "Command batches sent to another loop's shard");
+metrics::Counter& g_forwardedOps = metrics::counter(
+    "memcache_forwarded_ops_total", "Commands executed on another loop's shard");
+metrics::Counter& g_localOps =
+    metrics::counter("memcache_local_ops_total", "Commands executed on the connection's own shard");
+
+struct Op {
+    enum Kind { kGet, kSet, kAdd, kReplace, kDelete, kReply };
+
+    Kind kind;
+    bool noreply = false;
+    bool endsGet = false;  // append "END" after this one
+    int shard = -1;
+    uint32_t flags = 0;
+    uint64_t hash = 0;
+    string key;
+    string value;
+    string result;
+};
+
+// the commands of one read of one connection
+struct Batch {
+    TcpConnectionPtr conn;
+    std::vector<Op> ops;
+    int pending = 0;  // forwarded groups not back yet, connection loop only
+    bool close = false;
+};
+
+typedef std::shared_ptr<Batch> BatchPtr;
+
+// per connection, in its loop
+struct Session {
+    std::deque<BatchPtr> batches;  // replies go out in this order
+    Buffer output;
+};
+
+class MemcacheServer : noncopyable {
+   public:
+    MemcacheServer(EventLoop* loop, const InetAddress& listenAddr, int threads,
+                   size_t shardBytes, bool lockMode)
+        : server_(loop, listenAddr, "MemcacheServer"),
+          shardBytes_(shardBytes),
+          lockMode_(lockMode) {
+        server_.setThreadNum(threads);
+        server_.setConnectionCallback(std::bind(&MemcacheServer::onConnection, this, _1));
+        server_.setMessageCallback(std::bind(&MemcacheServer::onMessage, this, _1, _2, _3));
+        int numShards = std::max(threads, 1);
+        for (int i = 0; i < numShards; ++i) {
+            shards_.emplace_back();
+            locks_.emplace_back(new std::mutex);
+        }
+    }
+
+    void start() {
+        server_.start();
+        // TcpServer::start() has started the pool, its loops are the owners
+        loops_ = server_.threadPool()->getAllLoops();
+        for (size_t i = 0; i < loops_.size(); ++i) {
+            loopIndex_[loops_[i]] = static_cast<int>(i);
+            // first touch of the arena happens in the owner thread
+            loops_[i]->runInLoop(
+                [this, i] { shards_[i].reset(new Shard(shardBytes_)); });
+        }
+    }
+
+   private:
+    void onConnection(const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            conn->setTcpNoDelay(true);
+            conn->setContext(std::make_shared<Session>());
+        }
+    }
+
+    void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp);
+    bool parse(Buffer* buf, Batch* batch);
+    void dispatch(const BatchPtr& batch);
+    void execute(Shard* shard, Op* op);
+    void flush(const TcpConnectionPtr& conn);
+
+    static uint64_t hashKey(std::string_view key) { return std::hash<std::string_view>()(key); }
+
+    TcpServer server_;
+    size_t shardBytes_;
+    bool lockMode_;
+    std::vector<EventLoop*> loops_;
+    std::unordered_map<EventLoop*, int> loopIndex_;  // read-only after start()
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<std::unique_ptr<std::mutex>> locks_;  // lock mode only
+    static thread_local std::vector<std::string_view> tokens_;
+};
+
+thread_local std::vector<std::string_view> MemcacheServer::tokens_;
+
+void MemcacheServer::onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    auto batch = std::make_shared<Batch>();
+    batch->conn = conn;
+    bool ok = parse(buf, batch.get());
+    if (!ok) {
+        buf->retrieveAll();
+        batch->close = true;
+    }
+    if (batch->ops.empty() && !batch->close) return;
+
+    auto session = std::any_cast<std::shared_ptr<Session>>(conn->getContext());
+    session->batches.push_back(batch);
+    dispatch(batch);
+    if (batch->pending == 0) flush(conn);
+}
+
+// @return false on a fatal protocol error, whose reply is already queued
+bool MemcacheServer::parse(Buffer* buf, Batch* batch) {
+    auto reply = [batch](const char* text) {
+        Op op;
+        op.kind = Op::kReply;
+        op.result = text;
+        batch->ops.push_back(std::move(op));
+    };
+
+    while (buf->readableBytes() > 0 && !batch->close) {
+        const char* begin = buf->peek();
+        const char* end = begin + buf->readableBytes();
+        const char* crlf = static_cast<const char*>(memmem(begin, end - begin, "\r\n", 2));
+        if (crlf == nullptr) {
+            if (buf->readableBytes() > kMaxLineLength) {
+                reply("CLIENT_ERROR line too long\r\n");
+                return false;
+            }
+            break;
+        }
+
+        // a get may name any number of keys
+        std::vector<std::string_view>& tokens = tokens_;
+        tokens.clear();
+        for (const char* p = begin; p < crlf;) {
+            while (p < crlf && *p == ' ') ++p;
+            const char* q = p;
+            while (q < crlf && *q != ' ') ++q;
+            if (q > p) tokens.emplace_back(p, static_cast<size_t>(q - p));
+            p = q;
+        }
+        size_t n = tokens.size();
+        size_t lineBytes = static_cast<size_t>(crlf - begin) + 2;
+        if (n == 0) {
+            buf->retrieve(static_cast<int>(lineBytes));
+            reply("ERROR\r\n");
+            continue;
+        }
+
+        std::string_view cmd = tokens[0];
+        if (cmd == "get" || cmd == "gets") {
+            if (n < 2) {
+                reply("ERROR\r\n");
+            } else {
+                for (size_t i = 1; i < n; ++i) {
+                    Op op;
+                    op.kind = Op::kGet;
+                    op.key.assign(tokens[i]);
+                    op.endsGet = i + 1 == n;
+                    batch->ops.push_back(std::move(op));
+                }
+            }
+            buf->retrieve(static_cast<int>(lineBytes));
+        } else if (cmd == "set" || cmd == "add" || cmd == "replace") {
+            if (n < 5 || tokens[1].size() > kMaxKeyLength) {
+                buf->retrieve(static_cast<int>(lineBytes));
+                reply("CLIENT_ERROR bad command line format\r\n");
+                continue;
+            }
+            size_t bytes = strtoul(string(tokens[4]).c_str(), nullptr, 10);
+            if (bytes > Shard::kMaxItemSize) {
+                reply("SERVER_ERROR object too large for cache\r\n");
+                return false;
+            }
+            // wait until the data block is in
+            if (buf->readableBytes() < lineBytes + bytes + 2) break;
+            const char* data = begin + lineBytes;
+            if (data[bytes] != '\r' || data[bytes + 1] != '\n') {
+                reply("CLIENT_ERROR bad data chunk\r\n");
+                return false;
+            }
+            Op op;
+            op.kind = cmd == "set" ? Op::kSet : cmd == "add" ? Op::kAdd : Op::kReplace;
+            op.key.assign(tokens[1]);
+            op.flags = static_cast<uint32_t>(strtoul(string(tokens[2]).c_str(), nullptr, 10));
+            op.noreply = n > 5 && tokens[5] == "noreply";
+            op.value.assign(data, bytes);
+            batch->ops.push_back(std::move(op));
+            buf->retrieve(static_cast<int>(lineBytes + bytes + 2));
+        } else if (cmd == "delete") {
+            if (n < 2) {
+                reply("ERROR\r\n");
+            } else {
+                Op op;
+                op.kind = Op::kDelete;
+                op.key.assign(tokens[1]);
+                op.noreply = n > 2 && tokens[2] == "noreply";
+                batch->ops.push_back(std::move(op));
+            }
+            buf->retrieve(static_cast<int>(lineBytes));
+        } else if (cmd == "version") {
+            buf->retrieve(static_cast<int>(lineBytes));
+            reply("VERSION siren-memcache 0.1\r\n");
+        } else if (cmd == "stats") {
+            buf->retrieve(static_cast<int>(lineBytes));
+            char text[256];
+            snprintf(text, sizeof text,
+                     "STAT shards %zu\r\nSTAT local_ops %lld\r\nSTAT forwarded_ops %lld\r\n"
+                     "STAT forwarded_batches %lld\r\nEND\r\n",
+                     shards_.size(), static_cast<long long>(g_localOps.value()),
+                     static_cast<long long>(g_forwardedOps.value()),
+                     static_cast<long long>(g_forwardedBatches.value()));
+            reply(text);
+        } else if (cmd == "quit") {
+            buf->retrieveAll();
+            batch->close = true;
+        } else {
+            buf->retrieve(static_cast<int>(lineBytes));
+            reply("ERROR\r\n");
+        }
+    }
+    return true;
+}
+
+void MemcacheServer::dispatch(const BatchPtr& batch) {
+    int numShards = static_cast<int>(shards_.size());
+    for (Op& op : batch->ops) {
+        if (op.kind != Op::kReply) {
+            op.hash = hashKey(op.key);
+            // Shard probes from the low bits; taking the shard from them too
+            // would leave each shard's keys on a fraction of its slots
+            op.shard = static_cast<int>((op.hash >> 32) % static_cast<uint64_t>(numShards));
+        }
+    }
+
+    if (lockMode_) {
+        for (Op& op : batch->ops) {
+            if (op.kind == Op::kReply) continue;
+            std::lock_guard<std::mutex> lock(*locks_[op.shard]);
+            execute(shards_[op.shard].get(), &op);
+        }
+        return;
+    }
+
+    EventLoop* ownLoop = batch->conn->getLoop();
+    int own = loopIndex_.at(ownLoop);
+    std::vector<std::vector<Op*>> remote(numShards);
+    int64_t local = 0;
+    for (Op& op : batch->ops) {
+        if (op.kind == Op::kReply) continue;
+        if (op.shard == own) {
+            execute(shards_[own].get(), &op);
+            ++local;
+        } else {
+            remote[op.shard].push_back(&op);
+        }
+    }
+    g_localOps.inc(local);
+
+    for (int s = 0; s < numShards; ++s) {
+        if (remote[s].empty()) continue;
+        ++batch->pending;
+        g_forwardedBatches.inc();
+        g_forwardedOps.inc(static_cast<int64_t>(remote[s].size()));
+        // one hop there with every op for that shard, one hop back
+        loops_[s]->queueInLoop([this, batch, s, ops = std::move(remote[s]), ownLoop] {
+            for (Op* op : ops) execute(shards_[s].get(), op);
+            ownLoop->queueInLoop([this, batch] {
+                if (--batch->pending == 0) flush(batch->conn);
+            });
+        });
+    }
+}
+
+void MemcacheServer::execute(Shard* shard, Op* op) {
+    switch (op->kind) {
+        case Op::kGet:
+            if (Item* item = shard->find(op->key, op->hash)) {
+                char header[320];
+                int len = snprintf(header, sizeof header, "VALUE %s %u %u\r\n", op->key.c_str(),
+                                   item->flags, item->valueLen);
+                op->result.reserve(static_cast<size_t>(len) + item->valueLen + 2);
+                op->result.assign(header, static_cast<size_t>(len));
+                op->result.append(item->value());
+                op->result.append("\r\n");
+            }
+            break;
+        case Op::kSet:
+        case Op::kAdd:
+        case Op::kReplace: {
+            Shard::SetMode mode = op->kind == Op::kSet   ? Shard::kSet
+                                  : op->kind == Op::kAdd ? Shard::kAdd
+                                                         : Shard::kReplace;
+            switch (shard->set(mode, op->key, op->hash, op->flags, op->value)) {
+                case Shard::kStored: op->result = "STORED\r\n"; break;
+                case Shard::kNotStored: op->result = "NOT_STORED\r\n"; break;
+                case Shard::kNoMemory:
+                    op->result = "SERVER_ERROR out of memory storing object\r\n";
+                    break;
+            }
+            break;
+        }
+        case Op::kDelete:
+            op->result = shard->remove(op->key, op->hash) ? "DELETED\r\n" : "NOT_FOUND\r\n";
+            break;
+        case Op::kReply:
+            break;
+    }
+    if (op->noreply) op->result.clear();
+}
+
+void MemcacheServer::flush(const TcpConnectionPtr& conn) {
+    auto session = std::any_cast<std::shared_ptr<Session>>(conn->getContext());
+    bool close = false;
+    while (!session->batches.empty() && session->batches.front()->pending == 0) {
+        const BatchPtr& batch = session->batches.front();
+        for (const Op& op : batch->ops) {
+            session->output.append(op.result.data(), op.result.size());
+            if (op.endsGet) session->output.append("END\r\n", 5);
+        }
+        close = close || batch->close;
+        session->batches.pop_front();
+        if (close) break;
+    }
+    if (session->output.readableBytes() > 0) conn->send(&session->output);
+    if (close) conn->shutdown();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int threads = 4;
+    uint16_t port = 11211;
+    size_t shardMiB = 256;
+    bool lockMode = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:p:m:x:")) != -1) {
+        switch (opt) {
+            case 't': threads = atoi(optarg); break;
+            case 'p': port = static_cast<uint16_t>(atoi(optarg)); break;
+            case 'm': shardMiB = static_cast<size_t>(atoi(optarg)); break;
+            case 'x': lockMode = strcmp(optarg, "lock") == 0; break;
+            default:
+                fprintf(stderr, "see the header of server.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    EventLoop loop;
+    MemcacheServer server(&loop, InetAddress(port), threads, shardMiB * 1024 * 1024, lockMode);
+    server.start();
+    printf("memcache_server: %d shards, %s mode, port %u\n", std::max(threads, 1),
+           lockMode ? "lock" : "forward", port);
+    fflush(stdout);
+    loop.loop();
+}
@@ -0,0 +1,45 @@
+#include "siren/net/TcpServer.h"
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/MetricsServer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace siren;
+using namespace siren::net;
+
+void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+{
+  conn->send(buf);
+}
+
+// echo server whose counters can be scraped with
+//   curl http://127.0.0.1:<metrics_port>/metrics
+int main(int argc, char* argv[])
+{
+  if (argc < 4)
+  {
+    fprintf(stderr, "Usage: metrics_echo <port> <metrics_port> <threads>\n");
+    return 1;
+  }
+
+  uint16_t port = static_cast<uint16_t>(atoi(argv[1]));
+  uint16_t metricsPort = static_cast<uint16_t>(atoi(argv[2]));
+  int threadCount = atoi(argv[3]);
+
+  InetAddress metricsAddr(metricsPort);
+  MetricsServer metrics(metricsAddr);
+  metrics.start();
+
+  EventLoop loop;
+  InetAddress listenAddr(port);
+  TcpServer server(&loop, listenAddr, "echo");
+  server.setMessageCallback(onMessage);
+  server.setThreadNum(threadCount);
+  server.start();
+
+  loop.loop();
+}
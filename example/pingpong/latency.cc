@@ -0,0 +1,108 @@
+// Single-connection pingpong latency under EventLoop busy-poll.
+//
+// The server loop and the client loop both spin for <spin_us> before
+// blocking in epoll_wait; 0 is the ordinary blocking loop.
+//
+//   for b in 0 10 50 200 1000; do ./pingpong_latency $b 64 100000; done
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThread.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+int g_spinUs = 0;
+size_t g_size = 64;
+int g_iterations = 100000;
+
+std::vector<int64_t> g_rtts;
+std::chrono::steady_clock::time_point g_sent;
+std::string g_message;
+
+void onServerMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf);
+}
+
+void report() {
+    std::sort(g_rtts.begin(), g_rtts.end());
+    auto pct = [](double p) {
+        return g_rtts[std::min(g_rtts.size() - 1, static_cast<size_t>(p * g_rtts.size()))] / 1000.0;
+    };
+    double sum = 0;
+    for (int64_t v : g_rtts) sum += static_cast<double>(v);
+    printf("spin %5d us  size %6zu  n %7zu  avg %8.2f us  p50 %8.2f us  p99 %8.2f us  "
+           "p99.9 %8.2f us  max %8.2f us\n",
+           g_spinUs, g_size, g_rtts.size(), sum / static_cast<double>(g_rtts.size()) / 1000.0,
+           pct(0.5), pct(0.99), pct(0.999), static_cast<double>(g_rtts.back()) / 1000.0);
+    fflush(stdout);
+}
+
+void onClientConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        conn->setTcpNoDelay(true);
+        if (g_spinUs > 0) conn->setBusyPoll(g_spinUs);
+        g_sent = std::chrono::steady_clock::now();
+        conn->send(g_message);
+    }
+}
+
+void onClientMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    if (buf->readableBytes() < g_size) return;
+    auto now = std::chrono::steady_clock::now();
+    g_rtts.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - g_sent).count());
+    buf->retrieve(static_cast<int>(g_size));
+    if (static_cast<int>(g_rtts.size()) >= g_iterations) {
+        report();
+        _exit(0);  // skip tearing down both loops
+    }
+    g_sent = std::chrono::steady_clock::now();
+    conn->send(g_message);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage: pingpong_latency <spin_us> <size> <iterations> [port]\n");
+        return 1;
+    }
+    g_spinUs = atoi(argv[1]);
+    g_size = static_cast<size_t>(atoi(argv[2]));
+    g_iterations = atoi(argv[3]);
+    uint16_t port = static_cast<uint16_t>(argc > 4 ? atoi(argv[4]) : 23456);
+    g_message.assign(g_size, 'x');
+    g_rtts.reserve(g_iterations);
+
+    InetAddress addr("127.0.0.1", port);
+
+    EventLoopThread serverThread([](EventLoop* loop) { loop->setBusyPollMicros(g_spinUs); });
+    EventLoop* serverLoop = serverThread.startLoop();
+    TcpServer server(serverLoop, addr, "latency");
+    server.setMessageCallback(onServerMessage);
+    server.setBusyPoll(g_spinUs);
+    CountDownLatch started(1);
+    serverLoop->runInLoop([&] {
+        server.start();
+        started.countDown();
+    });
+    started.wait();
+
+    EventLoop loop;
+    loop.setBusyPollMicros(g_spinUs);
+    TcpClient client(&loop, addr, "latency-client");
+    client.setConnectionCallback(onClientConnection);
+    client.setMessageCallback(onClientMessage);
+    client.connect();
+    loop.loop();
+}
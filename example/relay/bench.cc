@@ -0,0 +1,265 @@
+// TCP relay throughput: buffer copies vs splice(2).
+//
+// <conns> client threads each push <megabytes> MiB through an in-process
+// relay to an in-process sink, then shut down writing. The relay opens one
+// backend connection per client. The run ends when every sink connection
+// has seen EOF, so the half-close has to travel through the relay as well.
+// Reports wall time, throughput and the CPU time of the whole process.
+// Clients and sink cost the same in both modes, so the difference is the
+// relay.
+//
+//   ./relay_bench -m copy|splice [-c conns] [-s megabytes] [-t threads]
+//                 [-w highWaterKiB] [-p port]
+//
+// copy:   onMessage -> peer->send(buf), high-water callback pauses the reader
+// splice: TcpConnection::relay(front, backend), no user-space copies
+
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThread.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+string g_mode = "splice";
+int g_conns = 4;
+size_t g_megabytes = 1024;
+int g_threads = 1;
+size_t g_highWater = 1024 * 1024;
+uint16_t g_port = 9879;
+
+double cpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// One client connection and its backend connection, all on one loop.
+class Tunnel : public std::enable_shared_from_this<Tunnel> {
+public:
+    Tunnel(const TcpConnectionPtr& front, const InetAddress& backendAddr)
+        : client_(front->getLoop(), backendAddr, front->name() + "-backend"), front_(front) {}
+
+    void connect() {
+        std::weak_ptr<Tunnel> weak = shared_from_this();
+        client_.setConnectionCallback([weak](const TcpConnectionPtr& conn) {
+            if (auto tunnel = weak.lock()) tunnel->onBackendConnection(conn);
+        });
+        client_.setMessageCallback([weak](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+            if (auto tunnel = weak.lock()) {
+                if (tunnel->front_) tunnel->front_->send(buf);
+            }
+        });
+        client_.connect();
+    }
+
+    void onFrontMessage(Buffer* buf) {
+        // bytes wait in the input buffer until the backend is up
+        if (backend_) backend_->send(buf);
+    }
+
+    void onFrontDisconnected() {
+        if (g_mode == "copy" && backend_) backend_->shutdown();
+        front_.reset();
+    }
+
+private:
+    void onBackendConnection(const TcpConnectionPtr& conn) {
+        if (!conn->connected()) {
+            if (g_mode == "copy" && front_) front_->shutdown();
+            backend_.reset();
+            return;
+        }
+        if (!front_) {
+            conn->shutdown();
+            return;
+        }
+        if (g_mode == "copy") {
+            backend_ = conn;
+            pauseWhenFull(front_, backend_);
+            pauseWhenFull(backend_, front_);
+            front_->send(conn->inputBuffer());
+            backend_->send(front_->inputBuffer());
+        } else {
+            conn->setHighWaterMarkCallback(nullptr, g_highWater);
+            front_->setHighWaterMarkCallback(nullptr, g_highWater);
+            if (!TcpConnection::relay(front_, conn)) {
+                front_->forceClose();
+                conn->forceClose();
+                return;
+            }
+            backend_ = conn;
+        }
+        front_->startRead();
+    }
+
+    // stop reading @c from while @c to has a backlog
+    static void pauseWhenFull(const TcpConnectionPtr& from, const TcpConnectionPtr& to) {
+        std::weak_ptr<TcpConnection> weakFrom = from;
+        to->setHighWaterMarkCallback(
+            [weakFrom](const TcpConnectionPtr&, size_t) {
+                if (auto conn = weakFrom.lock()) conn->stopRead();
+            },
+            g_highWater);
+        to->setWriteCompleteCallback([weakFrom](const TcpConnectionPtr&) {
+            if (auto conn = weakFrom.lock()) {
+                if (!conn->isReading()) conn->startRead();
+            }
+        });
+    }
+
+    TcpClient client_;
+    TcpConnectionPtr front_;
+    TcpConnectionPtr backend_;
+};
+
+using TunnelPtr = std::shared_ptr<Tunnel>;
+
+int connectTo(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) < 0) {
+        perror("connect");
+        exit(1);
+    }
+    return fd;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "m:c:s:t:w:p:")) != -1) {
+        switch (opt) {
+            case 'm': g_mode = optarg; break;
+            case 'c': g_conns = std::max(1, atoi(optarg)); break;
+            case 's': g_megabytes = static_cast<size_t>(std::max(1, atoi(optarg))); break;
+            case 't': g_threads = atoi(optarg); break;
+            case 'w': g_highWater = static_cast<size_t>(std::max(4, atoi(optarg))) * 1024; break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    if (g_mode != "copy" && g_mode != "splice") {
+        fprintf(stderr, "unknown mode %s\n", g_mode.c_str());
+        return 1;
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    // sink: counts bytes, closes on EOF
+    EventLoopThread sinkThread;
+    EventLoop* sinkLoop = sinkThread.startLoop();
+    InetAddress sinkAddr(static_cast<uint16_t>(g_port + 1), true);
+    TcpServer sink(sinkLoop, sinkAddr, "RelaySink");
+    sink.setThreadNum(g_threads);
+    std::atomic<size_t> sunk(0);
+    CountDownLatch sinkDone(g_conns);
+    sink.setConnectionCallback([&sinkDone](const TcpConnectionPtr& conn) {
+        if (!conn->connected()) sinkDone.countDown();
+    });
+    sink.setMessageCallback([&sunk](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        sunk.fetch_add(buf->readableBytes(), std::memory_order_relaxed);
+        buf->retrieveAll();
+    });
+
+    // relay
+    EventLoopThread relayThread;
+    EventLoop* relayLoop = relayThread.startLoop();
+    InetAddress relayAddr(g_port, true);
+    TcpServer relay(relayLoop, relayAddr, "Relay");
+    relay.setThreadNum(g_threads);
+    std::mutex mutex;
+    std::vector<TunnelPtr> tunnels;  // kept until exit
+    relay.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            conn->stopRead();
+            auto tunnel = std::make_shared<Tunnel>(conn, sinkAddr);
+            conn->setContext(tunnel);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tunnels.push_back(tunnel);
+            }
+            tunnel->connect();
+        } else if (conn->getContext().has_value()) {
+            std::any_cast<const TunnelPtr&>(conn->getContext())->onFrontDisconnected();
+            conn->setContext(std::any());
+        }
+    });
+    relay.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+        std::any_cast<const TunnelPtr&>(conn->getContext())->onFrontMessage(buf);
+    });
+
+    sinkLoop->runInLoop([&sink] { sink.start(); });
+    relayLoop->runInLoop([&relay] { relay.start(); });
+    sleep(1);
+
+    const size_t perConn = g_megabytes * 1024 * 1024;
+    double cpuBefore = cpuSeconds();
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> clients;
+    for (int i = 0; i < g_conns; ++i) {
+        clients.emplace_back([perConn] {
+            int fd = connectTo(g_port);
+            std::vector<char> chunk(64 * 1024, 'r');
+            size_t sent = 0;
+            while (sent < perConn) {
+                size_t len = std::min(chunk.size(), perConn - sent);
+                ssize_t n = ::write(fd, chunk.data(), len);
+                if (n <= 0) {
+                    perror("write");
+                    exit(1);
+                }
+                sent += static_cast<size_t>(n);
+            }
+            ::shutdown(fd, SHUT_WR);
+            // the sink never answers, EOF comes back through the relay
+            while (::read(fd, chunk.data(), chunk.size()) > 0) {
+            }
+            ::close(fd);
+        });
+    }
+    sinkDone.wait();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double cpu = cpuSeconds() - cpuBefore;
+    for (std::thread& t : clients) t.join();
+
+    const size_t total = perConn * static_cast<size_t>(g_conns);
+    if (sunk.load() != total) {
+        fprintf(stderr, "sink got %zu bytes, expected %zu\n", sunk.load(), total);
+        fflush(stderr);
+        _exit(1);
+    }
+    printf("%s: %d conns x %zu MiB: %.3f s wall, %.2f Gbit/s, %.3f s cpu\n", g_mode.c_str(),
+           g_conns, g_megabytes, seconds, static_cast<double>(total) * 8 / seconds / 1e9, cpu);
+    fflush(stdout);
+    _exit(0);
+}
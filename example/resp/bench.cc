@@ -0,0 +1,251 @@
+// redis-benchmark style load for resp_server (or a real Redis).
+//
+// For each test, <clients> connections over <threads> loops issue
+// <requests> commands in total, <pipeline> at a time per connection.
+// Commands are encoded with RespWriter and replies parsed with RespParser.
+//
+//   ./resp_bench [-h host] [-p port] [-c clients] [-n requests] [-P pipeline]
+//                [-d valueSize] [-r keyspace] [-T threads] [-t ping,set,get,incr,mget]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+#include "siren/net/resp/RespParser.h"
+#include "siren/net/resp/RespWriter.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+string g_host = "127.0.0.1";
+uint16_t g_port = 6379;
+int g_clients = 50;
+int64_t g_requests = 100000;
+int g_pipeline = 1;
+size_t g_valueSize = 3;
+int g_keyspace = 0;
+int g_threads = 2;
+string g_tests = "ping,set,get,incr,mget";
+
+class Run;
+
+class Client : noncopyable {
+   public:
+    Client(EventLoop* loop, const InetAddress& addr, const string& name, Run* run)
+        : client_(loop, addr, name), run_(run), rng_(std::random_device{}()) {
+        client_.setConnectionCallback(std::bind(&Client::onConnection, this, _1));
+        client_.setMessageCallback(std::bind(&Client::onMessage, this, _1, _2, _3));
+        latencies_.reserve(1 << 14);
+    }
+
+    void start() { client_.connect(); }
+    void stop() { client_.disconnect(); }
+    EventLoop* getLoop() const { return client_.getLoop(); }
+    const std::vector<int64_t>& latencies() const { return latencies_; }
+    int64_t errors() const { return errors_; }
+
+   private:
+    void onConnection(const TcpConnectionPtr& conn);
+    void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp);
+    void sendBatch(const TcpConnectionPtr& conn);
+    void appendCommand(RespWriter* w);
+
+    TcpClient client_;
+    Run* run_;
+    RespParser parser_;
+    Buffer output_;
+    std::mt19937 rng_;
+    char key_[32];
+    int outstanding_ = 0;
+    std::chrono::steady_clock::time_point sentAt_;
+    std::vector<int64_t> latencies_;
+    int64_t errors_ = 0;
+};
+
+class Run : noncopyable {
+   public:
+    Run(const string& test, EventLoopThreadPool* pool, const InetAddress& addr)
+        : test_(test), value_(g_valueSize, 'x'), issued_(0), done_(1) {
+        for (int i = 0; i < g_clients; ++i) {
+            char name[32];
+            snprintf(name, sizeof name, "%s%d", test.c_str(), i);
+            clients_.emplace_back(new Client(pool->getNextLoop(), addr, name, this));
+        }
+    }
+
+    void execute() {
+        auto start = std::chrono::steady_clock::now();
+        for (auto& c : clients_) c->start();
+        done_.wait();
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // every client is read in its own loop
+        std::vector<int64_t> latencies;
+        int64_t errors = 0;
+        std::mutex mutex;
+        CountDownLatch collected(static_cast<int>(clients_.size()));
+        for (auto& c : clients_) {
+            Client* client = c.get();
+            client->getLoop()->runInLoop([&, client] {
+                std::lock_guard<std::mutex> lock(mutex);
+                latencies.insert(latencies.end(), client->latencies().begin(),
+                                 client->latencies().end());
+                errors += client->errors();
+                client->stop();
+                collected.countDown();
+            });
+        }
+        collected.wait();
+
+        std::sort(latencies.begin(), latencies.end());
+        auto pct = [&](double p) -> long long {
+            if (latencies.empty()) return 0;
+            return latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))];
+        };
+        string upper = test_;
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        printf("%s: %.2f requests per second, p50=%lldus p99=%lldus max=%lldus errors=%lld\n",
+               upper.c_str(), static_cast<double>(latencies.size()) / seconds, pct(0.5),
+               pct(0.99), latencies.empty() ? 0LL : static_cast<long long>(latencies.back()),
+               static_cast<long long>(errors));
+        fflush(stdout);
+    }
+
+    // claims up to n commands, 0 once the run is fully issued
+    int claim(int n) {
+        int64_t first = issued_.fetch_add(n);
+        if (first >= g_requests) return 0;
+        return static_cast<int>(std::min<int64_t>(n, g_requests - first));
+    }
+
+    void replied(int64_t n) {
+        if (replied_.fetch_add(n) + n == g_requests) done_.countDown();
+    }
+
+    const string& test() const { return test_; }
+    const string& value() const { return value_; }
+
+   private:
+    const string test_;
+    const string value_;
+    std::atomic<int64_t> issued_;
+    std::atomic<int64_t> replied_{0};
+    CountDownLatch done_;
+    std::vector<std::unique_ptr<Client>> clients_;
+};
+
+void Client::onConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        conn->setTcpNoDelay(true);
+        sendBatch(conn);
+    }
+}
+
+void Client::sendBatch(const TcpConnectionPtr& conn) {
+    outstanding_ = run_->claim(g_pipeline);
+    if (outstanding_ == 0) return;
+    RespWriter writer(&output_);
+    for (int i = 0; i < outstanding_; ++i) appendCommand(&writer);
+    sentAt_ = std::chrono::steady_clock::now();
+    conn->send(&output_);
+}
+
+void Client::appendCommand(RespWriter* w) {
+    int n = g_keyspace > 0 ? static_cast<int>(rng_() % static_cast<unsigned>(g_keyspace)) : 0;
+    snprintf(key_, sizeof key_, "key:%012d", n);
+    const string& test = run_->test();
+    if (test == "ping") {
+        w->command({"PING"});
+    } else if (test == "set") {
+        w->command({"SET", key_, run_->value()});
+    } else if (test == "get") {
+        w->command({"GET", key_});
+    } else if (test == "incr") {
+        w->command({"INCR", "counter:rand"});
+    } else if (test == "mget") {
+        w->command({"MGET", key_, key_, key_, key_, key_, key_, key_, key_, key_, key_});
+    } else {
+        w->command({"PING"});
+    }
+}
+
+void Client::onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    int64_t replies = 0;
+    while (true) {
+        RespParser::Result result = parser_.parse(buf);
+        if (result == RespParser::kNeedMore) break;
+        if (result == RespParser::kError) {
+            fprintf(stderr, "protocol error: %s\n", parser_.errorMessage());
+            conn->forceClose();
+            return;
+        }
+        if (parser_.root().type == RespValue::kError) ++errors_;
+        buf->retrieve(static_cast<int>(parser_.consumedBytes()));
+        parser_.reset();
+        latencies_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - sentAt_)
+                                 .count());
+        ++replies;
+        if (--outstanding_ == 0) {
+            sendBatch(conn);
+        }
+    }
+    if (replies > 0) run_->replied(replies);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:c:n:P:d:r:T:t:")) != -1) {
+        switch (opt) {
+            case 'h': g_host = optarg; break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            case 'c': g_clients = atoi(optarg); break;
+            case 'n': g_requests = atoll(optarg); break;
+            case 'P': g_pipeline = std::max(1, atoi(optarg)); break;
+            case 'd': g_valueSize = static_cast<size_t>(atoi(optarg)); break;
+            case 'r': g_keyspace = atoi(optarg); break;
+            case 'T': g_threads = atoi(optarg); break;
+            case 't': g_tests = optarg; break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::err);
+
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, "bench");
+    pool.setThreadNum(std::max(1, g_threads));
+    pool.start();
+    InetAddress addr(g_host, g_port);
+
+    std::istringstream tests(g_tests);
+    string test;
+    std::vector<std::unique_ptr<Run>> runs;
+    while (std::getline(tests, test, ',')) {
+        runs.emplace_back(new Run(test, &pool, addr));
+        runs.back()->execute();
+    }
+    fflush(stdout);
+    _exit(0);
+}
@@ -0,0 +1,210 @@
+// In-memory RESP server, enough of the Redis command set for
+// redis-benchmark / redis-cli and for resp_bench.
+//
+//   ./resp_server [threads] [port]
+//
+// PING ECHO SET GET DEL EXISTS INCR MSET MGET DBSIZE FLUSHALL HELLO COMMAND CONFIG
+
+#include <stdlib.h>
+
+#include <charconv>
+#include <mutex>
+#include <unordered_map>
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/resp/RespParser.h"
+#include "siren/net/resp/RespServer.h"
+#include "siren/net/resp/RespWriter.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+// keys are sharded over independently locked maps
+class Store {
+   public:
+    static const size_t kShards = 64;
+
+    bool get(std::string_view key, string* value) {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(scratchKey(key));
+        if (it == shard.map.end()) return false;
+        value->assign(it->second);
+        return true;
+    }
+
+    void set(std::string_view key, std::string_view value) {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.map[scratchKey(key)].assign(value);
+    }
+
+    bool del(std::string_view key) {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.map.erase(scratchKey(key)) > 0;
+    }
+
+    bool incr(std::string_view key, int64_t* result) {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        string& value = shard.map[scratchKey(key)];
+        int64_t n = 0;
+        if (!value.empty()) {
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), n);
+            if (ec != std::errc() || ptr != value.data() + value.size()) return false;
+        }
+        *result = ++n;
+        value = std::to_string(n);
+        return true;
+    }
+
+    size_t size() {
+        size_t n = 0;
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            n += shard.map.size();
+        }
+        return n;
+    }
+
+    void clear() {
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.map.clear();
+        }
+    }
+
+   private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<string, string> map;
+    };
+
+    Shard& shardOf(std::string_view key) {
+        return shards_[std::hash<std::string_view>()(key) % kShards];
+    }
+
+    // lookups go through a reused per-thread string instead of a fresh key
+    static const string& scratchKey(std::string_view key) {
+        thread_local string scratch;
+        scratch.assign(key);
+        return scratch;
+    }
+
+    Shard shards_[kShards];
+};
+
+Store g_store;
+
+void wrongArity(const RespCommand& cmd, RespWriter* w) {
+    string message = "ERR wrong number of arguments for '";
+    message.append(cmd.name());
+    message += "' command";
+    w->error(message);
+}
+
+void onCommand(const TcpConnectionPtr&, const RespCommand& cmd, RespWriter* w) {
+    thread_local string value;
+    if (cmd.is("GET")) {
+        if (cmd.argc() != 2) return wrongArity(cmd, w);
+        if (g_store.get(cmd.arg(1), &value)) {
+            w->bulkString(value);
+        } else {
+            w->null();
+        }
+    } else if (cmd.is("SET")) {
+        if (cmd.argc() < 3) return wrongArity(cmd, w);
+        g_store.set(cmd.arg(1), cmd.arg(2));
+        w->ok();
+    } else if (cmd.is("PING")) {
+        if (cmd.argc() > 1) {
+            w->bulkString(cmd.arg(1));
+        } else {
+            w->simpleString("PONG");
+        }
+    } else if (cmd.is("ECHO")) {
+        if (cmd.argc() != 2) return wrongArity(cmd, w);
+        w->bulkString(cmd.arg(1));
+    } else if (cmd.is("DEL") || cmd.is("EXISTS")) {
+        if (cmd.argc() < 2) return wrongArity(cmd, w);
+        bool del = cmd.is("DEL");
+        int64_t n = 0;
+        for (size_t i = 1; i < cmd.argc(); ++i) {
+            n += del ? g_store.del(cmd.arg(i)) : g_store.get(cmd.arg(i), &value);
+        }
+        w->integer(n);
+    } else if (cmd.is("INCR")) {
+        if (cmd.argc() != 2) return wrongArity(cmd, w);
+        int64_t n;
+        if (g_store.incr(cmd.arg(1), &n)) {
+            w->integer(n);
+        } else {
+            w->error("ERR value is not an integer or out of range");
+        }
+    } else if (cmd.is("MSET")) {
+        if (cmd.argc() < 3 || cmd.argc() % 2 == 0) return wrongArity(cmd, w);
+        for (size_t i = 1; i < cmd.argc(); i += 2) g_store.set(cmd.arg(i), cmd.arg(i + 1));
+        w->ok();
+    } else if (cmd.is("MGET")) {
+        if (cmd.argc() < 2) return wrongArity(cmd, w);
+        w->arrayHeader(cmd.argc() - 1);
+        for (size_t i = 1; i < cmd.argc(); ++i) {
+            if (g_store.get(cmd.arg(i), &value)) {
+                w->bulkString(value);
+            } else {
+                w->null();
+            }
+        }
+    } else if (cmd.is("DBSIZE")) {
+        w->integer(static_cast<int64_t>(g_store.size()));
+    } else if (cmd.is("FLUSHALL") || cmd.is("FLUSHDB")) {
+        g_store.clear();
+        w->ok();
+    } else if (cmd.is("HELLO")) {
+        if (cmd.argc() > 1) {
+            if (cmd.arg(1) == "3") {
+                w->setProtocol(3);
+            } else if (cmd.arg(1) == "2") {
+                w->setProtocol(2);
+            } else {
+                w->error("NOPROTO unsupported protocol version");
+                return;
+            }
+        }
+        w->mapHeader(3);
+        w->bulkString("server");
+        w->bulkString("siren");
+        w->bulkString("proto");
+        w->integer(w->protocol());
+        w->bulkString("mode");
+        w->bulkString("standalone");
+    } else if (cmd.is("COMMAND") || cmd.is("CONFIG")) {
+        // what redis-benchmark and redis-cli ask on startup
+        w->arrayHeader(0);
+    } else {
+        string message = "ERR unknown command '";
+        message.append(cmd.name());
+        message += "'";
+        w->error(message);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : 0;
+    uint16_t port = static_cast<uint16_t>(argc > 2 ? atoi(argv[2]) : 6379);
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    EventLoop loop;
+    RespServer server(&loop, InetAddress(port), "RespServer");
+    server.setCommandCallback(onCommand);
+    server.setThreadNum(threads);
+    server.start();
+    loop.loop();
+}
@@ -0,0 +1,233 @@
+// Local RPC throughput benchmark: an in-process RpcServer with an "echo"
+// method, and <clients> RpcClients over <threads> loops keeping <window>
+// calls in flight each until <calls> calls are answered.
+//
+// With -W > 0 the handler hands the request to a pool of worker threads,
+// which answer through the RpcResponder; otherwise it answers inline in
+// the IO thread.
+//
+//   ./rpc_bench [-p port] [-c clients] [-n calls] [-w window] [-s payloadSize]
+//               [-t serverThreads] [-T clientThreads] [-W workers] [-o timeoutMs]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "siren/base/BlockingQueue.h"
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThread.h"
+#include "siren/net/EventLoopThreadPool.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/rpc/RpcClient.h"
+#include "siren/net/rpc/RpcServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+uint16_t g_port = 9877;
+int g_clients = 4;
+int64_t g_calls = 1000000;
+int g_window = 64;
+size_t g_payloadSize = 32;
+int g_serverThreads = 2;
+int g_clientThreads = 2;
+int g_workers = 0;
+int g_timeoutMs = 5000;
+
+constexpr uint32_t kEcho = rpcMethodId("echo");
+
+typedef std::function<void()> Task;
+
+class Run;
+
+class Client : noncopyable {
+   public:
+    Client(EventLoop* loop, const InetAddress& addr, const string& name, Run* run)
+        : client_(loop, addr, name), run_(run) {
+        client_.setConnectionCallback(std::bind(&Client::onConnection, this, _1));
+        latencies_.reserve(1 << 16);
+    }
+
+    void start() { client_.connect(); }
+    void stop() { client_.disconnect(); }
+    EventLoop* getLoop() const { return client_.getLoop(); }
+    const std::vector<int64_t>& latencies() const { return latencies_; }
+    int64_t errors() const { return errors_; }
+
+   private:
+    void onConnection(const TcpConnectionPtr& conn);
+    void issue();
+
+    RpcClient client_;
+    Run* run_;
+    std::vector<int64_t> latencies_;
+    int64_t errors_ = 0;
+};
+
+class Run : noncopyable {
+   public:
+    Run(EventLoopThreadPool* pool, const InetAddress& addr)
+        : payload_(g_payloadSize, 'x'), issued_(0), done_(1) {
+        for (int i = 0; i < g_clients; ++i) {
+            char name[32];
+            snprintf(name, sizeof name, "rpc%d", i);
+            clients_.emplace_back(new Client(pool->getNextLoop(), addr, name, this));
+        }
+    }
+
+    void execute() {
+        auto start = std::chrono::steady_clock::now();
+        for (auto& c : clients_) c->start();
+        done_.wait();
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // every client is read in its own loop
+        std::vector<int64_t> latencies;
+        int64_t errors = 0;
+        std::mutex mutex;
+        CountDownLatch collected(static_cast<int>(clients_.size()));
+        for (auto& c : clients_) {
+            Client* client = c.get();
+            client->getLoop()->runInLoop([&, client] {
+                std::lock_guard<std::mutex> lock(mutex);
+                latencies.insert(latencies.end(), client->latencies().begin(),
+                                 client->latencies().end());
+                errors += client->errors();
+                client->stop();
+                collected.countDown();
+            });
+        }
+        collected.wait();
+
+        std::sort(latencies.begin(), latencies.end());
+        auto pct = [&](double p) -> long long {
+            if (latencies.empty()) return 0;
+            return latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))];
+        };
+        printf("%d clients x %d window, %zu byte payload, %s: %.2f calls per second, "
+               "p50=%lldus p99=%lldus max=%lldus errors=%lld\n",
+               g_clients, g_window, g_payloadSize, g_workers > 0 ? "worker replies" : "inline replies",
+               static_cast<double>(g_calls) / seconds, pct(0.5), pct(0.99),
+               latencies.empty() ? 0LL : static_cast<long long>(latencies.back()),
+               static_cast<long long>(errors));
+        fflush(stdout);
+    }
+
+    bool claim() { return issued_.fetch_add(1, std::memory_order_relaxed) < g_calls; }
+
+    void answered() {
+        if (answered_.fetch_add(1, std::memory_order_relaxed) + 1 == g_calls) done_.countDown();
+    }
+
+    const string& payload() const { return payload_; }
+
+   private:
+    const string payload_;
+    std::atomic<int64_t> issued_;
+    std::atomic<int64_t> answered_{0};
+    CountDownLatch done_;
+    std::vector<std::unique_ptr<Client>> clients_;
+};
+
+void Client::onConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        for (int i = 0; i < g_window; ++i) issue();
+    }
+}
+
+void Client::issue() {
+    if (!run_->claim()) return;
+    auto sentAt = std::chrono::steady_clock::now();
+    client_.call(
+        kEcho, run_->payload(),
+        [this, sentAt](RpcStatus status, std::string_view response) {
+            if (status != RpcStatus::kOk || response.size() != g_payloadSize) ++errors_;
+            latencies_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now() - sentAt)
+                                     .count());
+            run_->answered();
+            // sent together with the rest of this read's calls
+            issue();
+        },
+        g_timeoutMs);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "p:c:n:w:s:t:T:W:o:")) != -1) {
+        switch (opt) {
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            case 'c': g_clients = std::max(1, atoi(optarg)); break;
+            case 'n': g_calls = atoll(optarg); break;
+            case 'w': g_window = std::max(1, atoi(optarg)); break;
+            case 's': g_payloadSize = static_cast<size_t>(atoi(optarg)); break;
+            case 't': g_serverThreads = atoi(optarg); break;
+            case 'T': g_clientThreads = atoi(optarg); break;
+            case 'W': g_workers = atoi(optarg); break;
+            case 'o': g_timeoutMs = atoi(optarg); break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::err);
+
+    // worker threads answer from outside the IO loops
+    BlockingQueue<Task> tasks;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < g_workers; ++i) {
+        workers.emplace_back([&tasks] {
+            while (true) {
+                Task task = tasks.take();
+                if (!task) break;
+                task();
+            }
+        });
+    }
+
+    EventLoopThread serverThread;
+    EventLoop* serverLoop = serverThread.startLoop();
+    InetAddress listenAddr(g_port);
+    RpcServer server(serverLoop, listenAddr, "RpcBench");
+    server.setThreadNum(g_serverThreads);
+    server.registerMethod("echo", [&tasks](std::string_view request, RpcResponder responder) {
+        if (g_workers == 0) {
+            responder.reply(string(request));
+            return;
+        }
+        // the request view dies with this call, the reply string does not
+        tasks.put([responder, request = string(request)]() mutable {
+            responder.reply(std::move(request));
+        });
+    });
+    serverLoop->runInLoop([&server] { server.start(); });
+
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, "client");
+    pool.setThreadNum(std::max(1, g_clientThreads));
+    pool.start();
+    InetAddress addr("127.0.0.1", g_port);
+
+    Run run(&pool, addr);
+    run.execute();
+
+    for (size_t i = 0; i < workers.size(); ++i) tasks.put(Task());
+    for (auto& t : workers) t.join();
+    fflush(stdout);
+    _exit(0);
+}
@@ -0,0 +1,174 @@
+// UDP packets-per-second on loopback.
+//
+// <senders> threads blast <size>-byte datagrams at an in-process UdpServer
+// for <seconds>, each from its own connected socket with sendmmsg() (or one
+// UDP_SEGMENT message per batch with -g). The server reads with recvmmsg()
+// batches of <batch>; -b 1 is the one-datagram-per-syscall baseline.
+// Reports datagrams sent and received per second; loopback drops whatever
+// overflows the receive buffers, so the received rate is the server's.
+//
+//   ./udp_bench [-c senders] [-t threads] [-b batch] [-s size] [-d seconds]
+//               [-g] [-e] [-p port]
+//
+// -g: GSO on the senders and GRO on the server
+// -e: the server echoes every datagram back through UdpSocket::send()
+
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThread.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/UdpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+int g_senders = 2;
+int g_threads = 2;
+int g_batch = 64;
+size_t g_size = 64;
+int g_seconds = 3;
+bool g_gso = false;
+bool g_echo = false;
+uint16_t g_port = 9881;
+
+constexpr int kSendBatch = 64;
+
+uint64_t sendLoop(const std::atomic<bool>& stop) {
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(g_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) < 0) {
+        perror("connect");
+        exit(1);
+    }
+    std::vector<char> payload(g_size * kSendBatch, 'u');
+    struct iovec iov[kSendBatch];
+    struct mmsghdr msgs[kSendBatch];
+    memset(msgs, 0, sizeof msgs);
+    for (int i = 0; i < kSendBatch; ++i) {
+        iov[i].iov_base = &payload[i * g_size];
+        iov[i].iov_len = g_size;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    if (g_gso) {
+        int segment = static_cast<int>(g_size);
+        if (::setsockopt(fd, SOL_UDP, UDP_SEGMENT, &segment, sizeof segment) < 0) {
+            perror("UDP_SEGMENT");
+            exit(1);
+        }
+    }
+
+    uint64_t sent = 0;
+    std::vector<char> sink(65536);
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (g_gso) {
+            // one send, the kernel cuts it into kSendBatch datagrams
+            if (::send(fd, payload.data(), payload.size(), 0) > 0) sent += kSendBatch;
+        } else {
+            int n = ::sendmmsg(fd, msgs, kSendBatch, 0);
+            if (n > 0) sent += static_cast<uint64_t>(n);
+        }
+        if (g_echo) {
+            while (::recv(fd, sink.data(), sink.size(), MSG_DONTWAIT) > 0) {
+            }
+        }
+    }
+    ::close(fd);
+    return sent;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "c:t:b:s:d:gep:")) != -1) {
+        switch (opt) {
+            case 'c': g_senders = std::max(1, atoi(optarg)); break;
+            case 't': g_threads = atoi(optarg); break;
+            case 'b': g_batch = std::max(1, atoi(optarg)); break;
+            case 's': g_size = static_cast<size_t>(std::clamp(atoi(optarg), 1, 1400)); break;
+            case 'd': g_seconds = std::max(1, atoi(optarg)); break;
+            case 'g': g_gso = true; break;
+            case 'e': g_echo = true; break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    EventLoopThread serverThread;
+    EventLoop* serverLoop = serverThread.startLoop();
+    UdpServer server(serverLoop, InetAddress(g_port, true), "UdpBench");
+    server.setThreadNum(g_threads);
+    server.setBatchSize(g_batch);
+    server.enableGro(g_gso);
+    server.enableGso(g_gso);
+    if (g_echo) {
+        server.setMessageCallback([](UdpSocket* socket, const char* data, size_t len,
+                                     const InetAddress& peer, Timestamp) {
+            socket->send(peer, data, len);
+        });
+    }
+    CountDownLatch started(1);
+    serverLoop->runInLoop([&] {
+        server.start();
+        started.countDown();
+    });
+    started.wait();
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> sent(0);
+    std::vector<std::thread> senders;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < g_senders; ++i) {
+        senders.emplace_back([&] { sent.fetch_add(sendLoop(stop)); });
+    }
+    sleep(static_cast<unsigned>(g_seconds));
+    stop = true;
+    for (std::thread& t : senders) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    usleep(100 * 1000);
+
+    std::atomic<uint64_t> received(0), dropped(0);
+    CountDownLatch counted(static_cast<int>(server.sockets().size()));
+    for (const auto& socket : server.sockets()) {
+        socket->getLoop()->runInLoop([&, s = socket.get()] {
+            received += s->receivedDatagrams();
+            dropped += s->droppedDatagrams();
+            counted.countDown();
+        });
+    }
+    counted.wait();
+
+    printf("%d senders, %d server threads, batch %d, %zu bytes%s%s: sent %.0f pps, "
+           "received %.0f pps (%.1f%%)%s\n",
+           g_senders, g_threads, g_batch, g_size, g_gso ? ", gso/gro" : "",
+           g_echo ? ", echo" : "", static_cast<double>(sent.load()) / seconds,
+           static_cast<double>(received.load()) / seconds,
+           sent.load() ? 100.0 * static_cast<double>(received.load()) / static_cast<double>(sent.load()) : 0.0,
+           g_echo ? (", echo drops " + std::to_string(dropped.load())).c_str() : "");
+    fflush(stdout);
+    _exit(0);
+}
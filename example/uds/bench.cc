@@ -0,0 +1,164 @@
+// Single-connection pingpong over a Unix domain socket vs loopback TCP.
+//
+// The same TcpServer/TcpClient pair runs on an InetAddress from
+// InetAddress::unixDomain() or on 127.0.0.1, the server in its own loop
+// thread. With -f every ping also carries one descriptor as SCM_RIGHTS,
+// the server passes it straight back (unix modes only).
+//
+//   ./uds_bench [-m tcp|unix|abstract] [-s size] [-n iterations] [-f]
+//               [-p port] [-P path]
+//
+//   for m in tcp unix abstract; do ./uds_bench -m $m -s 64; done
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThread.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+std::string g_mode = "unix";
+size_t g_size = 64;
+int g_iterations = 100000;
+bool g_passFd = false;
+uint16_t g_port = 9883;
+std::string g_path = "/tmp/siren_uds_bench.sock";
+
+std::vector<int64_t> g_rtts;
+std::chrono::steady_clock::time_point g_start;
+std::chrono::steady_clock::time_point g_sent;
+std::string g_message;
+int g_fd = -1;  // the descriptor bounced with -f
+size_t g_fdsBack = 0;
+
+void ping(const TcpConnectionPtr& conn) {
+    g_sent = std::chrono::steady_clock::now();
+    if (g_passFd) {
+        conn->sendFds({g_fd}, g_message);
+    } else {
+        conn->send(g_message);
+    }
+}
+
+void onServerMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    std::vector<int> fds = conn->takeReceivedFds();
+    if (fds.empty()) {
+        conn->send(buf);
+        return;
+    }
+    conn->sendFds(fds, buf->retrieveAllAsString());
+    for (int fd : fds) ::close(fd);
+}
+
+void report() {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_start).count();
+    std::sort(g_rtts.begin(), g_rtts.end());
+    auto pct = [](double p) {
+        return static_cast<double>(
+                   g_rtts[std::min(g_rtts.size() - 1, static_cast<size_t>(p * static_cast<double>(g_rtts.size())))]) /
+               1000.0;
+    };
+    double sum = 0;
+    for (int64_t v : g_rtts) sum += static_cast<double>(v);
+    printf("%-8s size %6zu%s  n %7zu  %9.0f rt/s  avg %7.2f us  p50 %7.2f us  p99 %7.2f us",
+           g_mode.c_str(), g_size, g_passFd ? " +fd" : "", g_rtts.size(),
+           static_cast<double>(g_rtts.size()) / seconds,
+           sum / static_cast<double>(g_rtts.size()) / 1000.0, pct(0.5), pct(0.99));
+    if (g_passFd) printf("  fds back %zu", g_fdsBack);
+    printf("\n");
+    fflush(stdout);
+}
+
+void onClientConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        if (g_mode == "tcp") conn->setTcpNoDelay(true);
+        g_start = std::chrono::steady_clock::now();
+        ping(conn);
+    }
+}
+
+void onClientMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    for (int fd : conn->takeReceivedFds()) {
+        ++g_fdsBack;
+        ::close(fd);
+    }
+    if (buf->readableBytes() < g_size) return;
+    auto now = std::chrono::steady_clock::now();
+    g_rtts.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - g_sent).count());
+    buf->retrieve(static_cast<int>(g_size));
+    if (static_cast<int>(g_rtts.size()) >= g_iterations) {
+        report();
+        if (g_mode == "unix") ::unlink(g_path.c_str());
+        _exit(0);  // skip tearing down both loops
+    }
+    ping(conn);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "m:s:n:fp:P:")) != -1) {
+        switch (opt) {
+            case 'm': g_mode = optarg; break;
+            case 's': g_size = static_cast<size_t>(std::max(1, atoi(optarg))); break;
+            case 'n': g_iterations = std::max(1, atoi(optarg)); break;
+            case 'f': g_passFd = true; break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            case 'P': g_path = optarg; break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    if (g_mode != "tcp" && g_mode != "unix" && g_mode != "abstract") {
+        fprintf(stderr, "unknown mode %s\n", g_mode.c_str());
+        return 1;
+    }
+    if (g_passFd && g_mode == "tcp") {
+        fprintf(stderr, "-f needs a unix mode\n");
+        return 1;
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+    g_message.assign(g_size, 'x');
+    g_rtts.reserve(static_cast<size_t>(g_iterations));
+    g_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    InetAddress addr = g_mode == "tcp"    ? InetAddress("127.0.0.1", g_port)
+                       : g_mode == "unix" ? InetAddress::unixDomain(g_path)
+                                          : InetAddress::unixDomain("@siren_uds_bench");
+
+    EventLoopThread serverThread;
+    EventLoop* serverLoop = serverThread.startLoop();
+    TcpServer server(serverLoop, addr, "UdsBench");
+    server.setMessageCallback(onServerMessage);
+    CountDownLatch started(1);
+    serverLoop->runInLoop([&] {
+        server.start();
+        started.countDown();
+    });
+    started.wait();
+
+    EventLoop loop;
+    TcpClient client(&loop, addr, "UdsBenchClient");
+    client.setConnectionCallback(onClientConnection);
+    client.setMessageCallback(onClientMessage);
+    client.connect();
+    loop.loop();
+}
@@ -0,0 +1,228 @@
+// WebSocket echo load for websocket_server.
+//
+// <clients> connections over <threads> loops upgrade, then each keeps
+// <pipeline> masked messages of <size> bytes in flight until <messages>
+// echoes have come back in total.
+//
+//   ./websocket_bench [-h host] [-p port] [-c clients] [-n messages] [-P pipeline]
+//                     [-s size] [-T threads] [-f fragments]
+//   ./websocket_bench -u [-s size]     unmask throughput, bytewise vs vectorized
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/TcpClient.h"
+#include "siren/net/websocket/WebSocketFrame.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+string g_host = "127.0.0.1";
+uint16_t g_port = 8080;
+int g_clients = 50;
+int64_t g_messages = 200000;
+int g_pipeline = 1;
+size_t g_size = 64;
+int g_threads = 2;
+int g_fragments = 1;
+
+std::atomic<int64_t> g_issued{0};
+std::atomic<int64_t> g_echoed{0};
+std::atomic<int64_t> g_errors{0};
+CountDownLatch* g_done;
+
+class Client : noncopyable {
+   public:
+    Client(EventLoop* loop, const InetAddress& addr, const string& name)
+        : client_(loop, addr, name), frames_(false), rng_(std::random_device{}()) {
+        client_.setConnectionCallback(std::bind(&Client::onConnection, this, _1));
+        client_.setMessageCallback(std::bind(&Client::onMessage, this, _1, _2, _3));
+        payload_.assign(g_size, 'x');
+    }
+
+    void start() { client_.connect(); }
+
+   private:
+    void onConnection(const TcpConnectionPtr& conn) {
+        if (!conn->connected()) return;
+        conn->setTcpNoDelay(true);
+        char request[256];
+        int n = snprintf(request, sizeof request,
+                         "GET /chat HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\n"
+                         "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                         "Sec-WebSocket-Version: 13\r\n\r\n",
+                         g_host.c_str());
+        conn->send(request, n);
+    }
+
+    void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+        if (!upgraded_) {
+            std::string_view head(buf->peek(), buf->readableBytes());
+            size_t end = head.find("\r\n\r\n");
+            if (end == std::string_view::npos) return;
+            if (head.compare(0, 12, "HTTP/1.1 101") != 0) {
+                fprintf(stderr, "upgrade refused: %.*s\n", static_cast<int>(end), head.data());
+                conn->forceClose();
+                return;
+            }
+            buf->retrieve(static_cast<int>(end + 4));
+            upgraded_ = true;
+            for (int i = 0; i < g_pipeline; ++i) sendOne(conn);
+            flush(conn);
+        }
+
+        int64_t echoed = 0;
+        while (true) {
+            WebSocketParser::Result result = frames_.parse(buf);
+            if (result == WebSocketParser::kNeedMore) break;
+            if (result == WebSocketParser::kError) {
+                fprintf(stderr, "bad frame, close code %d\n", frames_.closeCode());
+                conn->forceClose();
+                return;
+            }
+            if (result == WebSocketParser::kMessage) {
+                if (frames_.message().size() != g_size) g_errors.fetch_add(1);
+                ++echoed;
+                sendOne(conn);
+            }
+            buf->retrieve(static_cast<int>(frames_.consumedBytes()));
+            frames_.next();
+        }
+        flush(conn);
+        if (echoed > 0 && g_echoed.fetch_add(echoed) + echoed >= g_messages) {
+            g_done->countDown();
+        }
+    }
+
+    void sendOne(const TcpConnectionPtr&) {
+        if (g_issued.fetch_add(1) >= g_messages) return;
+        uint8_t mask[4];
+        uint32_t r = rng_();
+        memcpy(mask, &r, 4);
+        if (g_fragments <= 1) {
+            websocket::appendMaskedFrame(&output_, websocket::kText, payload_, mask);
+            return;
+        }
+        // split into g_fragments frames, the server reassembles them in place
+        size_t step = (g_size + g_fragments - 1) / g_fragments;
+        for (size_t off = 0; off < g_size || off == 0; off += step) {
+            size_t len = std::min(step, g_size - off);
+            bool fin = off + len >= g_size;
+            char header[websocket::kMaxHeaderSize];
+            size_t n = websocket::encodeHeader(header, off == 0 ? websocket::kText
+                                                                : websocket::kContinuation,
+                                               len, fin, false, mask);
+            output_.append(header, n);
+            output_.append(payload_.data() + off, len);
+            websocket::unmask(output_.beginWrite() - len, len, mask);
+            if (fin) break;
+        }
+    }
+
+    void flush(const TcpConnectionPtr& conn) {
+        if (output_.readableBytes() > 0) conn->send(&output_);
+    }
+
+    TcpClient client_;
+    WebSocketParser frames_;
+    Buffer output_;
+    string payload_;
+    std::mt19937 rng_;
+    bool upgraded_ = false;
+};
+
+void benchUnmask() {
+    const size_t total = size_t(1) << 30;
+    size_t size = std::max<size_t>(g_size, 1);
+    std::vector<char> data(size, 'x');
+    const uint8_t key[4] = {0x12, 0x34, 0x56, 0x78};
+    size_t rounds = total / size;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < size; ++i) data[i] = static_cast<char>(data[i] ^ key[i & 3]);
+        asm volatile("" : : "r"(data.data()) : "memory");
+    }
+    double bytewise =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        websocket::unmask(data.data(), size, key);
+        asm volatile("" : : "r"(data.data()) : "memory");
+    }
+    double vectorized =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double gib = static_cast<double>(rounds * size) / (1 << 30);
+    printf("unmask %zu byte payloads: bytewise %.2f GiB/s, vectorized %.2f GiB/s\n", size,
+           gib / bytewise, gib / vectorized);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    bool unmaskOnly = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:c:n:P:s:T:f:u")) != -1) {
+        switch (opt) {
+            case 'h': g_host = optarg; break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            case 'c': g_clients = std::max(1, atoi(optarg)); break;
+            case 'n': g_messages = atoll(optarg); break;
+            case 'P': g_pipeline = std::max(1, atoi(optarg)); break;
+            case 's': g_size = static_cast<size_t>(atoi(optarg)); break;
+            case 'T': g_threads = atoi(optarg); break;
+            case 'f': g_fragments = std::max(1, atoi(optarg)); break;
+            case 'u': unmaskOnly = true; break;
+            default:
+                fprintf(stderr, "see the header of bench.cc for options\n");
+                return 1;
+        }
+    }
+    if (unmaskOnly) {
+        benchUnmask();
+        return 0;
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::err);
+
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, "bench");
+    pool.setThreadNum(std::max(1, g_threads));
+    pool.start();
+    InetAddress addr(g_host, g_port);
+
+    CountDownLatch done(1);
+    g_done = &done;
+    std::vector<std::unique_ptr<Client>> clients;
+    for (int i = 0; i < g_clients; ++i) {
+        char name[32];
+        snprintf(name, sizeof name, "ws%d", i);
+        clients.emplace_back(new Client(pool.getNextLoop(), addr, name));
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (auto& c : clients) c->start();
+    done.wait();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%d clients, %zu byte messages, %d fragments: %.2f messages per second, errors=%lld\n",
+           g_clients, g_size, g_fragments, static_cast<double>(g_messages) / seconds,
+           static_cast<long long>(g_errors.load()));
+    fflush(stdout);
+    _exit(0);
+}
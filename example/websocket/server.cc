@@ -0,0 +1,64 @@
+// WebSocket echo / chat server, the target for websocket_bench.
+//
+//   ./websocket_server [threads] [port] [chat] [deflate]
+//
+// Every message is echoed back to its sender; in chat mode it is
+// broadcast to every open connection instead.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/websocket/WebSocketServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+std::mutex g_mutex;
+std::set<TcpConnectionPtr> g_connections;
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : 0;
+    uint16_t port = static_cast<uint16_t>(argc > 2 ? atoi(argv[2]) : 8080);
+    bool chat = false;
+    bool deflate = false;
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "chat") == 0) chat = true;
+        if (strcmp(argv[i], "deflate") == 0) deflate = true;
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    EventLoop loop;
+    WebSocketServer server(&loop, InetAddress(port), "WebSocketServer");
+    server.setThreadNum(threads);
+    server.enableDeflate(deflate);
+    server.setConnectionCallback([](const TcpConnectionPtr& conn) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (conn->connected()) {
+            g_connections.insert(conn);
+        } else {
+            g_connections.erase(conn);
+        }
+    });
+    server.setMessageCallback(
+        [chat](const TcpConnectionPtr& conn, std::string_view message, websocket::Opcode opcode) {
+            if (!chat) {
+                WebSocketServer::send(conn, message, opcode);
+                return;
+            }
+            std::vector<TcpConnectionPtr> all;
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                all.assign(g_connections.begin(), g_connections.end());
+            }
+            WebSocketServer::broadcast(all, message, opcode);
+        });
+    server.start();
+    loop.loop();
+}
@@ -0,0 +1,171 @@
+// MSG_ZEROCOPY payloads outliving their connection.
+//
+// The server sends one <size> MiB SharedPayload with zero-copy to a client
+// that does not read, so most of it is still in the socket when the server
+// force-closes and the TcpConnection is destroyed. The kernel may still
+// read those pages: the payload must stay referenced, by the loop, until
+// the client has drained the socket and the completions came back, and
+// the bytes the client gets must be the payload's.
+//
+// Exits non-zero if the payload is released while sends are in flight,
+// never released, or the client reads anything else.
+//
+//   ./zerocopy_test [-s sizeMiB] [-p port]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/InetAddress.h"
+#include "siren/net/SharedPayload.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+int g_sizeMiB = 16;
+uint16_t g_port = 12348;
+
+constexpr double kReleaseTimeout = 10.0;
+
+char patternAt(size_t i) { return static_cast<char>(i * 31 + i / 4096); }
+
+// blocking, reads nothing until told to, then checks every byte up to EOF
+class Client {
+   public:
+    Client() : fd_(::socket(AF_INET, SOCK_STREAM, 0)), received_(0), corrupt_(false) {
+        int rcvbuf = 64 * 1024;
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf);
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(g_port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) != 0) {
+            perror("connect");
+            _exit(1);
+        }
+    }
+    ~Client() {
+        join();
+        ::close(fd_);
+    }
+
+    void startReading() {
+        reader_ = std::thread([this] {
+            char buf[65536];
+            ssize_t n;
+            while ((n = ::read(fd_, buf, sizeof buf)) > 0) {
+                size_t at = received_.load(std::memory_order_relaxed);
+                for (ssize_t i = 0; i < n; ++i) {
+                    if (buf[i] != patternAt(at + i)) corrupt_ = true;
+                }
+                received_.store(at + n, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    /// returns at EOF
+    void join() {
+        if (reader_.joinable()) reader_.join();
+    }
+
+    size_t received() const { return received_.load(std::memory_order_relaxed); }
+    bool corrupt() const { return corrupt_.load(); }
+
+   private:
+    int fd_;
+    std::atomic<size_t> received_;
+    std::atomic<bool> corrupt_;
+    std::thread reader_;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "s:p:")) != -1) {
+        switch (opt) {
+            case 's': g_sizeMiB = std::max(1, atoi(optarg)); break;
+            case 'p': g_port = static_cast<uint16_t>(atoi(optarg)); break;
+            default:
+                fprintf(stderr, "see the header of zerocopy.cc for options\n");
+                return 1;
+        }
+    }
+    Logger::getInstance().getLogger().set_level(spdlog::level::warn);
+
+    std::string bytes(static_cast<size_t>(g_sizeMiB) << 20, '\0');
+    for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = patternAt(i);
+    SharedPayload payload(std::move(bytes));
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(g_port), "ZeroCopy");
+    std::unique_ptr<Client> client;
+    bool ok = true;
+    long heldAfterClose = 0;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (!conn->connected()) {
+            // the TcpConnection is destroyed once this callback chain is done
+            loop.runAfter(0.1, [&] {
+                heldAfterClose = payload.useCount() - 1;
+                printf("connection gone, %ld reference(s) to the payload still held\n",
+                       heldAfterClose);
+                if (heldAfterClose == 0) {
+                    printf("FAIL: released while the client has not read\n");
+                    ok = false;
+                    loop.quit();
+                    return;
+                }
+                client->startReading();
+                auto deadline = std::chrono::steady_clock::now() +
+                                std::chrono::duration<double>(kReleaseTimeout);
+                loop.runEvery(0.01, [&, deadline] {
+                    if (payload.useCount() == 1) {
+                        printf("released after the client read %zu bytes\n", client->received());
+                        loop.quit();
+                    } else if (std::chrono::steady_clock::now() > deadline) {
+                        printf("FAIL: still held after %.0f s\n", kReleaseTimeout);
+                        ok = false;
+                        loop.quit();
+                    }
+                });
+            });
+            return;
+        }
+        if (!conn->enableZeroCopy()) {
+            printf("SO_ZEROCOPY is not supported here, nothing to test\n");
+            _exit(0);
+        }
+        conn->send(payload);
+        // whatever the socket took is in flight, drop the rest and go
+        conn->forceClose();
+    });
+    server.start();
+    client.reset(new Client);
+    loop.loop();
+
+    client->join();
+    if (client->corrupt()) {
+        printf("FAIL: the client read bytes that are not the payload's\n");
+        ok = false;
+    }
+    if (payload.useCount() != 1) ok = false;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    _exit(ok ? 0 : 1);
+}
@@ -4,6 +4,7 @@
 #include "siren/net/Socket.h"
 
 #include <functional>
+#include <string>
 
 
 namespace siren::net {
@@ -32,6 +33,7 @@ namespace siren::net {
         NewConnectionCallback newConnectionCallback_;
         bool listening_;
         int idleFd_;
+        std::string unixPath_;  // AF_UNIX socket file, removed with the acceptor
     };
 } // namespace siren::net
 
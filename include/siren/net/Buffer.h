@@ -50,6 +50,9 @@ class Buffer {
 
     [[nodiscard]] const char* peek() const { return begin() + readerIndex_; }
 
+    /// for codecs that rewrite received bytes in place
+    char* mutablePeek() { return begin() + readerIndex_; }
+
     void retrieve(int len) {
         if (len < readableBytes()) {
             readerIndex_ += len;
@@ -123,6 +126,8 @@ class Buffer {
     }
 
     ssize_t readFd(int);
+    /// same, on an AF_UNIX socket, appending SCM_RIGHTS descriptors to @c fds
+    ssize_t readFd(int, std::vector<int>* fds);
 
    private:
     std::vector<char> buffer_;
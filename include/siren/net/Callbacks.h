@@ -1,6 +1,7 @@
 #pragma once
 
 // #include "siren/net/Timer.h"
+#include "siren/base/InplaceFunction.h"
 
 #include <chrono>
 #include <functional>
@@ -21,7 +22,8 @@ inline T* get_pointer(const std::shared_ptr<T>& ptr) {
 namespace net {
 class Buffer;
 class TcpConnection;
-using TimerCallback = std::function<void()>;
+// move-only, small captures are stored inline
+using TimerCallback = InplaceFunction<void()>;
 using Timestamp = std::chrono::system_clock::time_point;
 using TcpConnectionPtr = std::shared_ptr<TcpConnection>;
 using ConnectionCallback = std::function<void(const TcpConnectionPtr&)>;
@@ -31,6 +33,11 @@ using WriteCompleteCallback = std::function<void(const TcpConnectionPtr&)>;
 typedef std::function<void(const TcpConnectionPtr&, size_t)>
     HighWaterMarkCallback;
 
+// a connect attempt failed, or was refused up front by an open circuit breaker;
+// circuitOpen is true only for the latter, the failure that opens it reports false
+typedef std::function<void(int consecutiveFailures, bool circuitOpen)>
+    ConnectFailedCallback;
+
 // the data has been read to (buf, len)
 typedef std::function<void(const TcpConnectionPtr&, Buffer*, Timestamp)>
     MessageCallback;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "siren/base/WorkStealingPool.h"
+#include "siren/net/EventLoop.h"
+
+namespace siren::net {
+
+    ///
+    /// Runs @c work on a worker of @c pool, then @c done with its result
+    /// back on @c loop through queueInLoop(), so the IO thread only pays
+    /// for the two hand-offs:
+    ///
+    ///   runInPool(&pool, conn->getLoop(),
+    ///             [req] { return render(req); },
+    ///             [conn](std::string page) { conn->send(page); });
+    ///
+    /// A void @c work calls @c done(). Thread safe.
+    template <typename Work, typename Done>
+    void runInPool(WorkStealingPool* pool, EventLoop* loop, Work work, Done done) {
+        pool->submit([loop, work = std::move(work), done = std::move(done)]() mutable {
+            if constexpr (std::is_void_v<std::invoke_result_t<Work&>>) {
+                work();
+                loop->queueInLoop(std::move(done));
+            } else {
+                loop->queueInLoop([done = std::move(done), result = work()]() mutable {
+                    done(std::move(result));
+                });
+            }
+        });
+    }
+
+} // namespace siren::net
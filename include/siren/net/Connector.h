@@ -1,9 +1,11 @@
 
 
+#include <chrono>
 #include <functional>
 #include <memory>
 
 #include "siren/base/noncopyable.h"
+#include "siren/net/Callbacks.h"
 #include "siren/net/InetAddress.h"
 
 namespace siren {
@@ -23,12 +25,31 @@ class Connector : noncopyable, public std::enable_shared_from_this<Connector> {
         newConnectionCallback_ = cb;
     }
 
+    void setConnectFailedCallback(const ConnectFailedCallback& cb) {
+        connectFailedCallback_ = cb;
+    }
+
+    /// Retry delays start at @c initMs and grow with decorrelated jitter,
+    /// each one drawn from [initMs, 3 * previous], capped at @c maxMs.
+    /// Not thread safe, call it before start().
+    void setRetryDelay(int initMs, int maxMs);
+
+    /// After @c failures consecutive failed attempts the circuit opens:
+    /// for @c openMs every attempt fails fast without creating a socket,
+    /// then a single probe is let through. @c failures == 0 disables it.
+    /// Not thread safe, call it before start().
+    void setCircuitBreaker(int failures, int openMs);
+
     void start();    // can be called in any thread
     void restart();  // must be called in loop thread
     void stop();     // can be called in any thread
 
     const InetAddress& serverAddress() const { return serverAddr_; }
 
+    /// in loop thread
+    bool circuitOpen() const;
+    int consecutiveFailures() const { return failures_; }
+
    private:
     enum States { kDisconnected, kConnecting, kConnected };
     static const int kMaxRetryDelayMs = 30 * 1000;
@@ -42,6 +63,9 @@ class Connector : noncopyable, public std::enable_shared_from_this<Connector> {
     void handleWrite();
     void handleError();
     void retry(int sockfd);
+    void failFast();
+    void scheduleRetry(int delayMs);
+    int nextRetryDelayMs();
     int removeAndResetChannel();
     void resetChannel();
 
@@ -51,7 +75,15 @@ class Connector : noncopyable, public std::enable_shared_from_this<Connector> {
     States state_;  
     std::unique_ptr<Channel> channel_;
     NewConnectionCallback newConnectionCallback_;
+    ConnectFailedCallback connectFailedCallback_;
+    int initRetryDelayMs_;
+    int maxRetryDelayMs_;
     int retryDelayMs_;
+    bool retryPending_;
+    int failures_;
+    int breakerFailures_;
+    int breakerOpenMs_;
+    std::chrono::steady_clock::time_point breakerOpenUntil_;
 };
 
 }  // namespace net
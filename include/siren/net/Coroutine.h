@@ -0,0 +1,465 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine) || __cplusplus < 202002L
+#error "siren/net/Coroutine.h needs C++20, build the target with -std=c++20"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "siren/net/Buffer.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/TcpClient.h"
+#include "siren/net/TcpConnection.h"
+
+///
+/// C++20 coroutines on top of EventLoop, header only so siren_net itself
+/// stays C++17.
+///
+/// Every awaitable here suspends with its handle parked in a callback of
+/// the loop that owns the connection, timer or client, and that callback
+/// resumes it inline: a coroutine started on a loop thread stays there.
+/// Frames come from a free list of the thread that runs the loop.
+///
+///   Task<void> session(AsyncConnection conn) {
+///       for (;;) {
+///           std::string line = co_await conn.readUntil("\r\n");
+///           if (line.empty()) co_return;  // closed
+///           co_await conn.write(line);
+///       }
+///   }
+///   server.setConnectionCallback([](const TcpConnectionPtr& conn) {
+///       if (conn->connected()) spawn(session(AsyncConnection(conn)));
+///   });
+namespace siren::net {
+
+    namespace detail {
+
+        ///
+        /// Size-classed free lists for coroutine frames, one per thread.
+        ///
+        /// Frames are created and destroyed on the loop thread, so after
+        /// warm-up a suspension point costs no malloc. Larger frames and
+        /// lists past kMaxCached go straight to the global heap.
+        class FramePool {
+        public:
+            static const size_t kGranularity = 64;
+            static const size_t kClasses = 16;  // frames up to 1 KiB
+            static const size_t kMaxCached = 256;  // per class
+
+            static void* allocate(size_t size) {
+                const size_t cls = classOf(size);
+                if (cls < kClasses) {
+                    Lists& lists = local();
+                    if (FreeFrame* frame = lists.head[cls]) {
+                        lists.head[cls] = frame->next;
+                        --lists.count[cls];
+                        return frame;
+                    }
+                    return ::operator new((cls + 1) * kGranularity);
+                }
+                return ::operator new(size);
+            }
+
+            static void deallocate(void* p, size_t size) {
+                const size_t cls = classOf(size);
+                if (cls < kClasses) {
+                    Lists& lists = local();
+                    if (lists.count[cls] < kMaxCached) {
+                        FreeFrame* frame = static_cast<FreeFrame*>(p);
+                        frame->next = lists.head[cls];
+                        lists.head[cls] = frame;
+                        ++lists.count[cls];
+                        return;
+                    }
+                }
+                ::operator delete(p);
+            }
+
+        private:
+            struct FreeFrame {
+                FreeFrame* next;
+            };
+
+            struct Lists {
+                FreeFrame* head[kClasses] = {};
+                size_t count[kClasses] = {};
+
+                ~Lists() {
+                    for (FreeFrame* frame : head) {
+                        while (frame) {
+                            FreeFrame* next = frame->next;
+                            ::operator delete(frame);
+                            frame = next;
+                        }
+                    }
+                }
+            };
+
+            static size_t classOf(size_t size) { return (size - 1) / kGranularity; }
+
+            static Lists& local() {
+                thread_local Lists lists;
+                return lists;
+            }
+        };
+
+        /// frames of every coroutine type here go through FramePool
+        struct PooledPromise {
+            static void* operator new(size_t size) { return FramePool::allocate(size); }
+            static void operator delete(void* p, size_t size) { FramePool::deallocate(p, size); }
+        };
+
+    } // namespace detail
+
+    template <typename T>
+    class Task;
+
+    namespace detail {
+
+        template <typename T>
+        struct TaskPromiseBase : PooledPromise {
+            std::coroutine_handle<> continuation;
+            std::exception_ptr exception;
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+                    // symmetric transfer, the awaiting coroutine goes on
+                    // without growing the stack
+                    std::coroutine_handle<> next = h.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            FinalAwaiter final_suspend() noexcept { return {}; }
+
+            void unhandled_exception() { exception = std::current_exception(); }
+        };
+
+        template <typename T>
+        struct TaskPromise : TaskPromiseBase<T> {
+            T value{};
+
+            Task<T> get_return_object();
+            template <typename U>
+            void return_value(U&& v) { value = std::forward<U>(v); }
+            T result() {
+                if (this->exception) std::rethrow_exception(this->exception);
+                return std::move(value);
+            }
+        };
+
+        template <>
+        struct TaskPromise<void> : TaskPromiseBase<void> {
+            Task<void> get_return_object();
+            void return_void() {}
+            void result() {
+                if (exception) std::rethrow_exception(exception);
+            }
+        };
+
+    } // namespace detail
+
+    ///
+    /// Lazy coroutine returning T, it starts when awaited and resumes the
+    /// awaiting coroutine when done. Pass it to spawn() to run it detached.
+    template <typename T = void>
+    class [[nodiscard]] Task {
+    public:
+        using promise_type = detail::TaskPromise<T>;
+
+        Task(Task&& rhs) noexcept : handle_(std::exchange(rhs.handle_, {})) {}
+        Task& operator=(Task&& rhs) noexcept {
+            if (this != &rhs) {
+                if (handle_) handle_.destroy();
+                handle_ = std::exchange(rhs.handle_, {});
+            }
+            return *this;
+        }
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task() {
+            if (handle_) handle_.destroy();
+        }
+
+        bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle_.promise().continuation = awaiting;
+            return handle_;
+        }
+        T await_resume() { return handle_.promise().result(); }
+
+    private:
+        friend promise_type;
+        explicit Task(std::coroutine_handle<promise_type> h) : handle_(h) {}
+
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    namespace detail {
+
+        template <typename T>
+        Task<T> TaskPromise<T>::get_return_object() {
+            return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() {
+            return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+        }
+
+        /// eager and self-destroying, the frame is freed when it finishes
+        struct Detached {
+            struct promise_type : PooledPromise {
+                Detached get_return_object() noexcept { return {}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() noexcept {}
+                // nobody is left to see it
+                void unhandled_exception() noexcept { std::terminate(); }
+            };
+        };
+
+        inline Detached runDetached(Task<void> task) {
+            co_await task;
+        }
+
+    } // namespace detail
+
+    /// Starts @c task right here and lets it run to completion on its own.
+    /// Call it on the loop thread the task's awaitables belong to.
+    inline void spawn(Task<void> task) {
+        detail::runDetached(std::move(task));
+    }
+
+    ///
+    /// co_await sleep(loop, seconds): resumes from a timer of @c loop.
+    /// Loop thread only.
+    class SleepAwaiter {
+    public:
+        SleepAwaiter(EventLoop* loop, double seconds) : loop_(loop), seconds_(seconds) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            loop_->runAfter(seconds_, [h]() { h.resume(); });
+        }
+        void await_resume() const noexcept {}
+
+    private:
+        EventLoop* loop_;
+        double seconds_;
+    };
+
+    inline SleepAwaiter sleep(EventLoop* loop, double seconds) {
+        return SleepAwaiter(loop, seconds);
+    }
+
+    template <typename Rep, typename Period>
+    SleepAwaiter sleep(EventLoop* loop, std::chrono::duration<Rep, Period> d) {
+        return SleepAwaiter(loop, std::chrono::duration<double>(d).count());
+    }
+
+    ///
+    /// Coroutine view of a TcpConnection.
+    ///
+    /// Takes over the connection's message, write complete and connection
+    /// callbacks. One reader and one writer may be suspended at a time.
+    /// Reads complete with an empty string once the peer closed, writes
+    /// with false. Loop thread only.
+    class AsyncConnection {
+    public:
+        AsyncConnection() = default;
+        explicit AsyncConnection(const TcpConnectionPtr& conn)
+            : conn_(conn), state_(std::make_shared<State>()) {
+            // the callbacks hold the state, not the connection
+            std::shared_ptr<State> state = state_;
+            conn_->setMessageCallback(
+                [state](const TcpConnectionPtr&, Buffer*, Timestamp) { state->wakeReader(); });
+            // installed only while a writer waits, see WriteAwaiter
+            conn_->setWriteCompleteCallback(WriteCompleteCallback());
+            conn_->setConnectionCallback([state](const TcpConnectionPtr& c) {
+                if (!c->connected()) {
+                    state->closed = true;
+                    state->wakeReader();
+                    state->wakeWriter();
+                }
+            });
+            state_->closed = !conn_->connected();
+        }
+
+        [[nodiscard]] const TcpConnectionPtr& connection() const { return conn_; }
+        [[nodiscard]] bool connected() const { return conn_ && !state_->closed; }
+
+        class ReadAwaiter {
+        public:
+            ReadAwaiter(AsyncConnection* owner, size_t n, std::string delim)
+                : owner_(owner), n_(n), delim_(std::move(delim)) {}
+
+            bool await_ready() { return owner_->state_->closed || ready(); }
+            void await_suspend(std::coroutine_handle<> h) {
+                owner_->state_->reader = h;
+                owner_->state_->readAwaiter = this;
+            }
+            std::string await_resume() {
+                Buffer* buf = owner_->conn_->inputBuffer();
+                if (!ready()) return std::string();
+                std::string out(buf->peek(), length_);
+                buf->retrieve(static_cast<int>(length_));
+                return out;
+            }
+
+            // enough bytes in the input buffer, sets length_
+            bool ready() {
+                Buffer* buf = owner_->conn_->inputBuffer();
+                if (delim_.empty()) {
+                    length_ = n_;
+                    return buf->readableBytes() >= n_;
+                }
+                const char* begin = buf->peek();
+                const char* end = begin + buf->readableBytes();
+                const char* found = std::search(begin, end, delim_.begin(), delim_.end());
+                if (found == end) return false;
+                length_ = static_cast<size_t>(found - begin) + delim_.size();
+                return true;
+            }
+
+        private:
+            AsyncConnection* owner_;
+            size_t n_;
+            std::string delim_;
+            size_t length_ = 0;
+        };
+
+        class WriteAwaiter {
+        public:
+            WriteAwaiter(AsyncConnection* owner, const void* data, size_t len, Buffer* buf)
+                : owner_(owner), data_(data), len_(len), buf_(buf) {}
+
+            bool await_ready() {
+                if (owner_->state_->closed) return true;
+                if (buf_) {
+                    owner_->conn_->send(buf_);
+                } else {
+                    owner_->conn_->send(data_, static_cast<int>(len_));
+                }
+                // whatever the socket did not take waits in the connection
+                return owner_->conn_->unsentBytes() == 0;
+            }
+            void await_suspend(std::coroutine_handle<> h) {
+                std::shared_ptr<State> state = owner_->state_;
+                state->writer = h;
+                owner_->conn_->setWriteCompleteCallback([state](const TcpConnectionPtr& c) {
+                    if (c->unsentBytes() == 0) {
+                        // a completed write queues no functor from here on
+                        c->setWriteCompleteCallback(WriteCompleteCallback());
+                        state->wakeWriter();
+                    }
+                });
+            }
+            bool await_resume() const { return !owner_->state_->closed; }
+
+        private:
+            AsyncConnection* owner_;
+            const void* data_;
+            size_t len_;
+            Buffer* buf_;
+        };
+
+        /// exactly @c n bytes
+        ReadAwaiter read(size_t n) { return ReadAwaiter(this, n, std::string()); }
+        /// up to and including the first @c delim
+        ReadAwaiter readUntil(std::string delim) { return ReadAwaiter(this, 0, std::move(delim)); }
+        /// resumes once the bytes are all in the kernel, @c data may go then
+        WriteAwaiter write(const void* data, size_t len) {
+            return WriteAwaiter(this, data, len, nullptr);
+        }
+        WriteAwaiter write(const std::string& data) { return write(data.data(), data.size()); }
+        /// takes everything readable out of @c buf
+        WriteAwaiter write(Buffer* buf) { return WriteAwaiter(this, nullptr, 0, buf); }
+
+        void shutdown() { conn_->shutdown(); }
+        void forceClose() { conn_->forceClose(); }
+
+    private:
+        struct State {
+            std::coroutine_handle<> reader;
+            ReadAwaiter* readAwaiter = nullptr;
+            std::coroutine_handle<> writer;
+            bool closed = false;
+
+            void wakeReader() {
+                if (reader && (closed || readAwaiter->ready())) {
+                    readAwaiter = nullptr;
+                    std::exchange(reader, {}).resume();
+                }
+            }
+            void wakeWriter() {
+                if (writer) std::exchange(writer, {}).resume();
+            }
+        };
+
+        TcpConnectionPtr conn_;
+        std::shared_ptr<State> state_;
+    };
+
+    ///
+    /// Coroutine view of a TcpClient: co_await client.connect() resumes
+    /// with the established connection, or an unconnected one when the
+    /// attempt fails; the client stops then instead of retrying.
+    /// Loop thread only.
+    class AsyncClient {
+    public:
+        AsyncClient(EventLoop* loop, const InetAddress& serverAddr, const string& name)
+            : client_(loop, serverAddr, name) {
+            client_.setConnectionCallback([this](const TcpConnectionPtr& conn) {
+                if (conn->connected()) resume(conn);
+            });
+            client_.setConnectFailedCallback([this](int, bool) {
+                client_.stop();
+                resume(TcpConnectionPtr());
+            });
+        }
+
+        [[nodiscard]] TcpClient* client() { return &client_; }
+
+        class ConnectAwaiter {
+        public:
+            explicit ConnectAwaiter(AsyncClient* owner) : owner_(owner) {}
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) {
+                owner_->waiter_ = h;
+                owner_->client_.connect();
+            }
+            AsyncConnection await_resume() {
+                TcpConnectionPtr conn = std::move(owner_->conn_);
+                return conn ? AsyncConnection(conn) : AsyncConnection();
+            }
+
+        private:
+            AsyncClient* owner_;
+        };
+
+        ConnectAwaiter connect() { return ConnectAwaiter(this); }
+
+    private:
+        void resume(const TcpConnectionPtr& conn) {
+            conn_ = conn;
+            if (waiter_) std::exchange(waiter_, {}).resume();
+        }
+
+        TcpClient client_;
+        std::coroutine_handle<> waiter_;
+        TcpConnectionPtr conn_;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+///
+/// Thread placement helpers, Linux only.
+///
+namespace siren::net::affinity {
+
+    /// Pins the calling thread to @c cpus.
+    /// @return false if @c cpus is empty or sched_setaffinity fails
+    bool pinCurrentThread(const std::vector<int>& cpus);
+
+    /// Sets the calling thread's name, truncated to 15 characters.
+    void setCurrentThreadName(const std::string& name);
+
+    /// @return NUMA node of @c cpu from sysfs, or -1 when unknown
+    int numaNodeOfCpu(int cpu);
+
+    /// @return the CPU that services each interrupt line whose device name
+    /// contains @c ifname (e.g. "eth0" matches "eth0-TxRx-3"), in the order
+    /// the lines appear. The servicing CPU is the column with the highest
+    /// interrupt count. Duplicates are removed.
+    std::vector<int> nicQueueCpus(const std::string& ifname,
+                                  const std::string& interruptsPath = "/proc/interrupts");
+
+} // namespace siren::net::affinity
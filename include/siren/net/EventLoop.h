@@ -19,7 +19,8 @@ namespace siren::net {
     class TimerQueue;
 
     using ChannelList = std::vector<Channel*>;
-    typedef std::function<void()> Functor;
+    // move-only, small captures are stored inline
+    typedef InplaceFunction<void()> Functor;
 
     class EventLoop : noncopyable {
     public:
@@ -58,10 +59,42 @@ namespace siren::net {
          */
         TimerId runEvery(double interval, TimerCallback cb);
 
+        /**
+         * @brief 取消定时器，定时器已经触发（非循环）时什么也不做
+         * @note 从其他线程调用是线程安全的
+         */
+        void cancel(TimerId timerId);
+
+        /// 当前由该 EventLoop 负责的 TcpConnection 数量
+        /// @note 线程安全
+        int connectionCount() const { return numConnections_.load(std::memory_order_relaxed); }
+        void addConnectionCount(int delta) { numConnections_.fetch_add(delta, std::memory_order_relaxed); }
+
+        /// 累计处理事件、定时器与 pending functors 的时间（不含 poll 等待），单位纳秒
+        /// @note 线程安全，可由其他线程采样
+        int64_t busyNanos() const { return busyNanos_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 开启 busy-poll：poll 没有事件时，先以 0 超时反复 poll，
+         * 自旋 spinMicros 微秒后才真正阻塞在 epoll_wait 上。
+         * 自旋期间其他线程调用 queueInLoop() 不再写 eventfd 唤醒。
+         *
+         * @param spinMicros 自旋预算，单位微秒，0 表示关闭
+         * @note 需在 loop() 之前或 loop 线程中调用
+         */
+        void setBusyPollMicros(int spinMicros) { busyPollMicros_ = spinMicros; }
+        int busyPollMicros() const { return busyPollMicros_; }
+
+        /// 线程被绑定到的 NUMA 节点，未绑定时为 -1
+        /// 非 -1 时，loop 自己持有的内存（如 TcpConnection 的 Buffer）会在 loop 线程中分配
+        int numaNode() const { return numaNode_; }
+        void setNumaNode(int node) { numaNode_ = node; }
+
     private:
         const int kPollTimeMs; // poll 超时时间
         const std::thread::id threadId_; // handle eventloop的线程
         void handleRead(); // wakeup
+        Timestamp spinPoll();
         void abortNotInLoopThread();
         void doPendingFunctors();
         bool looping_;
@@ -80,7 +113,15 @@ namespace siren::net {
 
         mutable std::mutex mutex_;
         std::vector<Functor> pendingFunctors_;
-        
+
+        std::atomic<int> numConnections_;
+        std::atomic<int64_t> busyNanos_;
+        int numaNode_;
+
+        int busyPollMicros_;
+        std::atomic<bool> spinning_;       // loop 正在自旋，queueInLoop 无需唤醒
+        std::atomic<bool> hasPendingFunctors_;
+
     };
 } // namespace siren::net
 
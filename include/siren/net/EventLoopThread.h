@@ -1,10 +1,12 @@
 #pragma once
+#include "siren/base/Event.h"
+#include "siren/base/FutexMutex.h"
 #include "siren/base/noncopyable.h"
 
-#include <condition_variable>
 #include <functional>
-#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace siren::net {
     class EventLoop;
@@ -13,18 +15,35 @@ namespace siren::net {
         typedef std::function<void(EventLoop*)> ThreadInitCallback;
 
         explicit EventLoopThread(ThreadInitCallback  cb = ThreadInitCallback());
+
+        /// @param name thread name given to pthread_setname_np, empty to keep the default
+        /// @param cpus CPUs the loop thread is pinned to, empty for no pinning.
+        ///        The EventLoop is created after pinning, so memory it touches
+        ///        first is placed on the local NUMA node.
+        EventLoopThread(ThreadInitCallback cb, std::string name, std::vector<int> cpus = {});
         ~EventLoopThread();
+        /// start() then waitForLoop()
         EventLoop* startLoop();
-        
+
+        /// Spawns the loop thread and returns at once, so several threads can
+        /// construct their loops in parallel.
+        void start();
+        /// Blocks until the loop started by start() runs.
+        EventLoop* waitForLoop();
+
+        [[nodiscard]] const std::vector<int>& cpus() const { return cpus_; }
+
     private:
         void threadFunc();
 
         EventLoop* loop_;
         bool exiting_;
         std::thread thread_;
-        std::mutex mutex_;
-        std::condition_variable cond_;
+        FutexMutex mutex_;
+        Event started_; // set once loop_ points at the running loop
         ThreadInitCallback callback_;
+        const std::string name_;
+        const std::vector<int> cpus_;
     };
 } // namespace siren::net
 
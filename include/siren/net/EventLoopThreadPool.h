@@ -1,5 +1,6 @@
 #pragma once
 
+#include "siren/base/FutexMutex.h"
 #include "siren/base/Types.h"
 #include "siren/base/noncopyable.h"
 
@@ -15,18 +16,63 @@ namespace siren::net {
     class EventLoopThreadPool : public noncopyable {
     public:
         using ThreadInitCallback = std::function<void(EventLoop*)>;
+        /// custom strategy: choose one of @c loops for a key, called in base loop
+        using LoopSelector = std::function<EventLoop*(const std::vector<EventLoop*>& loops, size_t hashCode)>;
+
+        /// How getLoop() assigns new work to the IO loops.
+        enum Strategy {
+            kRoundRobin,       // getNextLoop()
+            kLeastConnections, // fewest TcpConnections owned by the loop
+            kLeastCpuTime,     // least busy time in the last sampling window
+            kConsistentHash,   // jump consistent hash of the key
+            kCustom,           // LoopSelector set by setLoopSelector()
+        };
+
         EventLoopThreadPool(EventLoop* baseLoop, string  nameArg);
         ~EventLoopThreadPool();
         void setThreadNum(int numThreads) { numThreads_ = numThreads; }
+
+        /// CPU set of each loop thread, loop i is pinned to cpuSets[i % cpuSets.size()].
+        /// Threads are named "<name><i>". Call before start().
+        void setThreadCpus(std::vector<std::vector<int>> cpuSets) { cpuSets_ = std::move(cpuSets); }
+
+        /// Pins loop i to the CPU servicing the i-th receive queue of @c ifname,
+        /// read from /proc/interrupts. Call before start().
+        /// @return false if no interrupt line matches @c ifname
+        bool setNicQueueCpus(const string& ifname);
+
+        /// valid after calling start(), empty if loop @c index is not pinned
+        const std::vector<int>& cpusOfLoop(size_t index) const;
+
+        /// valid after calling start()
+        /// @return the loop pinned to @c cpu, nullptr if no loop is pinned there
+        EventLoop* getLoopForCpu(int cpu) const;
+        /// Starts every loop thread at once and returns when all loops run.
+        /// @c cb runs in each new loop thread, one at a time but in no
+        /// particular order.
         void start(const ThreadInitCallback& cb = ThreadInitCallback());
 
         // valid after calling start()
         /// round-robin
         EventLoop* getNextLoop();
 
-        /// with the same hash code, it will always return the same EventLoop
+        /// with the same hash code, it will always return the same EventLoop.
+        /// Uses jump consistent hash, so growing the pool from n to n+1 loops
+        /// only moves 1/(n+1) of the keys.
         EventLoop* getLoopForHash(size_t hashCode);
 
+        /// picks a loop according to strategy(), @c hashCode is only used by
+        /// kConsistentHash and kCustom
+        EventLoop* getLoop(size_t hashCode = 0);
+
+        void setStrategy(Strategy strategy) { strategy_ = strategy; }
+        [[nodiscard]] Strategy strategy() const { return strategy_; }
+        void setLoopSelector(LoopSelector selector)
+        {
+            selector_ = std::move(selector);
+            strategy_ = kCustom;
+        }
+
         std::vector<EventLoop*> getAllLoops();
 
         [[nodiscard]] bool started() const
@@ -40,6 +86,10 @@ namespace siren::net {
         }
 
     private:
+        EventLoop* getLeastConnectionsLoop();
+        EventLoop* getLeastCpuTimeLoop();
+        void sampleCpuTime();
+
         EventLoop* baseLoop_;
         string name_;
         bool started_;
@@ -47,6 +97,17 @@ namespace siren::net {
         int next_;
         std::vector<std::unique_ptr<EventLoopThread>> threads_;
         std::vector<EventLoop*> loops_;
+        std::vector<std::vector<int>> cpuSets_;
+        std::vector<EventLoop*> cpuToLoop_;  // indexed by cpu id
+        FutexMutex initMutex_;               // serializes the ThreadInitCallback
+        Strategy strategy_;
+        LoopSelector selector_;
+
+        // kLeastCpuTime bookkeeping, always in base loop
+        int64_t lastSampleNanos_;
+        std::vector<int64_t> lastBusyNanos_;
+        std::vector<int64_t> recentBusyNanos_;
+        std::vector<int> assignedSinceSample_;
     };
 } // namespace siren::net
 
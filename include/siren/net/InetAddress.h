@@ -11,6 +11,8 @@
  * 
  */
 #include <netinet/in.h>
+#include <string.h>
+#include <sys/un.h>
 #include <string>
 
 namespace siren {
@@ -20,7 +22,10 @@ namespace net {
     }
 
     ///
-    /// Wrapper of sockaddr_in.
+    /// Wrapper of sockaddr_in, sockaddr_in6 and sockaddr_un.
+    ///
+    /// AF_UNIX stream addresses come from unixDomain(), everything taking
+    /// an InetAddress (TcpServer, TcpClient, Connector) then works on them.
     ///
     /// This is an POD interface class.
     class InetAddress {
@@ -37,16 +42,35 @@ namespace net {
         /// Constructs an endpoint with given struct @c sockaddr_in
         /// Mostly used when accepting new connections
         explicit InetAddress(const struct sockaddr_in& addr)
-            : addr_(addr)
         {
+            memset(&addrUnix_, 0, sizeof addrUnix_);
+            addr_ = addr;
         }
 
         explicit InetAddress(const struct sockaddr_in6& addr)
-            : addr6_(addr)
+        {
+            memset(&addrUnix_, 0, sizeof addrUnix_);
+            addr6_ = addr;
+        }
+
+        explicit InetAddress(const struct sockaddr_un& addr)
+            : addrUnix_(addr)
         {
         }
 
+        /// AF_UNIX stream address. A leading '@' selects the Linux abstract
+        /// namespace, "@siren" binds "\0siren" and leaves no file behind.
+        /// Paths longer than sun_path are truncated.
+        static InetAddress unixDomain(const std::string& path);
+
+        /// getsockname()/getpeername() of a connected socket, unlike
+        /// sockets::getLocalAddr() they keep AF_UNIX paths whole
+        static InetAddress localAddressOf(int sockfd);
+        static InetAddress peerAddressOf(int sockfd);
+
         sa_family_t family() const { return addr_.sin_family; }
+        /// the length bind()/connect() want, exact for abstract names
+        socklen_t length() const;
         std::string toIp() const;
         std::string toIpPort() const;
         uint16_t port() const;
@@ -57,7 +81,7 @@ namespace net {
         void setSockAddrInet6(const struct sockaddr_in6& addr6) { addr6_ = addr6; }
 
         uint32_t ipv4NetEndian() const;
-        uint16_t portNetEndian() const { return addr_.sin_port; }
+        uint16_t portNetEndian() const { return family() == AF_UNIX ? 0 : addr_.sin_port; }
 
         // resolve hostname to IP address, not changing port or sin_family
         // return true on success.
@@ -72,6 +96,7 @@ namespace net {
         union {
             struct sockaddr_in addr_{};
             struct sockaddr_in6 addr6_;
+            struct sockaddr_un addrUnix_;
         };
     };
 
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "siren/base/noncopyable.h"
+#include "siren/net/Buffer.h"
+#include "siren/net/Callbacks.h"
+
+#include <string_view>
+
+namespace siren::net {
+
+    ///
+    /// Frames messages with a big-endian length header of 2, 4 or 8 bytes.
+    ///
+    /// onMessage() is meant to be bound as a TcpConnection message callback.
+    /// Complete frames are handed out as string_views into the connection's
+    /// input buffer, no copy is made; a view is only valid during the
+    /// callback. Outgoing frames get their header prepended into the
+    /// buffer's kCheapPrepend area, so the payload is never moved.
+    class LengthHeaderCodec : noncopyable {
+    public:
+        typedef std::function<void(const TcpConnectionPtr&, std::string_view frame,
+                                   Timestamp)>
+            FrameCallback;
+        /// a header announced more than maxFrameSize bytes
+        typedef std::function<void(const TcpConnectionPtr&, uint64_t length)>
+            OversizeCallback;
+
+        static const size_t kDefaultMaxFrameSize = 64 * 1024 * 1024;
+
+        /// @c maxFrameSize is clamped to what @c headerLen can express
+        explicit LengthHeaderCodec(FrameCallback cb, size_t headerLen = 4,
+                                   size_t maxFrameSize = kDefaultMaxFrameSize);
+
+        /// Default: log and force close the connection.
+        void setOversizeCallback(OversizeCallback cb) { oversizeCallback_ = std::move(cb); }
+
+        void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+
+        /// Prepends the header for buf's readable bytes in place.
+        void encode(Buffer* buf) const;
+
+        /// Encodes @c buf in place and sends it, @c buf is consumed.
+        void send(const TcpConnectionPtr& conn, Buffer* buf) const;
+
+        /// Copies @c frame once into a buffer with header room and sends it.
+        void send(const TcpConnectionPtr& conn, std::string_view frame) const;
+
+        [[nodiscard]] size_t headerLen() const { return headerLen_; }
+        [[nodiscard]] size_t maxFrameSize() const { return maxFrameSize_; }
+
+    private:
+        uint64_t peekLength(const char* data) const;
+
+        FrameCallback frameCallback_;
+        OversizeCallback oversizeCallback_;
+        const size_t headerLen_;
+        const size_t maxFrameSize_;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "siren/base/Types.h"
+#include "siren/base/noncopyable.h"
+#include "siren/net/Callbacks.h"
+#include "siren/net/EventLoopThread.h"
+#include "siren/net/InetAddress.h"
+
+#include <memory>
+
+namespace siren::net {
+
+    class EventLoop;
+    class TcpServer;
+
+    /**
+     * @brief 以 Prometheus 文本格式导出 siren::metrics::MetricsRegistry
+     *
+     * 在独立的 EventLoopThread 上运行自己的 TcpServer，慢速的抓取端不会
+     * 与 IO 线程共用 loop。渲染时只读取各指标分片的原子变量，
+     * 不会获取 IO loop 的任何锁。
+     */
+    class MetricsServer : noncopyable {
+    public:
+        /**
+         * @param listenAddr 监听地址
+         * @param nameArg 服务名，用作内部 TcpServer 的名字并出现在日志中
+         * @param path 提供指标的 HTTP 路径，其他路径返回 404
+         */
+        explicit MetricsServer(const InetAddress& listenAddr,
+                               string nameArg = "metrics",
+                               string path = "/metrics");
+        ~MetricsServer();
+
+        /**
+         * @brief 启动独立的 loop 线程并开始监听
+         * @note 非线程安全，只能调用一次
+         */
+        void start();
+
+        /// 指标服务所在的 EventLoop，start() 之后有效
+        EventLoop* getLoop() const { return loop_; }
+
+    private:
+        void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp);
+
+        const InetAddress listenAddr_;
+        const string name_;
+        const string path_;
+        EventLoopThread loopThread_;
+        EventLoop* loop_;
+        std::unique_ptr<TcpServer> server_;  // lives in loop_
+    };
+
+} // namespace siren::net
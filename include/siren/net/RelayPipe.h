@@ -0,0 +1,51 @@
+#pragma once
+
+#include "siren/base/noncopyable.h"
+
+#include <stddef.h>
+#include <sys/types.h>
+
+namespace siren::net {
+
+    ///
+    /// A pipe used as the kernel-side buffer of a spliced TCP relay.
+    ///
+    /// splice(2) moves socket pages into the pipe and from the pipe into the
+    /// other socket without touching user space. Pipes come from a pool
+    /// owned by the calling thread, which is the loop thread for relays, so
+    /// every loop reuses its own pipes instead of paying pipe2() and
+    /// F_SETPIPE_SZ per connection.
+    class RelayPipe : noncopyable {
+    public:
+        /// the kernel default fs.pipe-max-size, larger requests are clamped
+        static constexpr size_t kMaxCapacity = 1024 * 1024;
+
+        /// Takes a pipe from the pool of the calling thread or opens one,
+        /// sized for at least @c capacity bytes when the kernel allows it.
+        explicit RelayPipe(size_t capacity);
+        /// Gives an empty pipe back to the pool, closes one still holding data.
+        ~RelayPipe();
+
+        [[nodiscard]] bool valid() const { return readFd_ >= 0; }
+        /// bytes waiting in the pipe
+        [[nodiscard]] size_t size() const { return size_; }
+        [[nodiscard]] size_t capacity() const { return capacity_; }
+
+        /// Splices what @c fd has, up to the free room, into the pipe.
+        /// @return bytes moved, 0 on EOF, -1 with errno set
+        ssize_t fillFrom(int fd);
+        /// Splices the pipe into @c fd as far as the socket takes it.
+        /// @return bytes moved, -1 with errno set
+        ssize_t drainTo(int fd);
+
+        /// pipes parked in the pool of the calling thread
+        static size_t pooled();
+
+    private:
+        int readFd_;
+        int writeFd_;
+        size_t capacity_;
+        size_t size_;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "siren/net/Callbacks.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace siren::net {
+
+    ///
+    /// Refcounted immutable bytes.
+    ///
+    /// TcpConnection::send(const SharedPayload&) queues a reference instead
+    /// of copying, so one message sent to many connections exists once no
+    /// matter how many of them are still waiting for socket space. Copying
+    /// a SharedPayload only bumps the refcount.
+    class SharedPayload {
+    public:
+        SharedPayload() = default;
+
+        /// takes over @c data, no copy
+        explicit SharedPayload(std::string data)
+            : data_(std::make_shared<const std::string>(std::move(data))) {}
+
+        static SharedPayload copyOf(std::string_view data) {
+            return SharedPayload(std::string(data));
+        }
+
+        [[nodiscard]] const char* data() const { return data_ ? data_->data() : nullptr; }
+        [[nodiscard]] size_t size() const { return data_ ? data_->size() : 0; }
+        [[nodiscard]] bool empty() const { return size() == 0; }
+        [[nodiscard]] std::string_view view() const {
+            return data_ ? std::string_view(*data_) : std::string_view();
+        }
+        [[nodiscard]] long useCount() const { return data_.use_count(); }
+
+    private:
+        std::shared_ptr<const std::string> data_;
+    };
+
+    /// Groups @c conns by owning loop and runs @c task once in each loop
+    /// with that loop's share of the connections. Thread safe; the calling
+    /// thread's own loop runs its share before this returns.
+    void runPerLoop(const std::vector<TcpConnectionPtr>& conns,
+                    const std::function<void(const std::vector<TcpConnectionPtr>&)>& task);
+
+    /// Sends @c payload to every connection in @c conns, one task per
+    /// owning loop, no per-connection copy. Thread safe.
+    void broadcast(const std::vector<TcpConnectionPtr>& conns, const SharedPayload& payload);
+
+} // namespace siren::net
@@ -66,6 +66,19 @@ namespace siren::net {
         ///
         void setKeepAlive(bool on);
 
+        ///
+        /// SO_BUSY_POLL: busy poll the device queue for up to @c usec on
+        /// blocking reads and epoll, and SO_PREFER_BUSY_POLL when @c prefer.
+        /// Raising the value above net.core.busy_read needs CAP_NET_ADMIN.
+        ///
+        void setBusyPoll(int usec, bool prefer);
+
+        ///
+        /// Enable/disable SO_ZEROCOPY, which lets sends pass MSG_ZEROCOPY.
+        /// @return false if the kernel does not support it
+        ///
+        bool setZeroCopy(bool on);
+
     private:
         const int sockfd_;
     };
@@ -2,6 +2,8 @@
 
 #include <arpa/inet.h>
 
+#include <vector>
+
 
 namespace siren::net::sockets {
 
@@ -10,9 +12,14 @@ namespace siren::net::sockets {
     /// abort if any error.
     int createNonblockingOrDie(sa_family_t family);
 
-    int connect(int sockfd, const struct sockaddr *addr);
+    /// same for a UDP socket
+    int createUdpNonblockingOrDie(sa_family_t family);
+
+    int connect(int sockfd, const struct sockaddr *addr,
+                socklen_t addrlen = sizeof(struct sockaddr_in6));
 
-    void bindOrDie(int sockfd, const struct sockaddr *addr);
+    void bindOrDie(int sockfd, const struct sockaddr *addr,
+                   socklen_t addrlen = sizeof(struct sockaddr_in6));
 
     void listenOrDie(int sockfd);
 
@@ -24,6 +31,26 @@ namespace siren::net::sockets {
 
     ssize_t write(int sockfd, const void *buf, size_t count);
 
+    ssize_t writev(int sockfd, const struct iovec *iov, int iovcnt);
+
+    /// sendmsg(2) of @c buf with @c nfds descriptors as SCM_RIGHTS, AF_UNIX only
+    ssize_t sendFds(int sockfd, const int *fds, int nfds, const void *buf, size_t count);
+
+    /// readv(2) that also collects SCM_RIGHTS descriptors into @c fds,
+    /// received close-on-exec
+    ssize_t readvFds(int sockfd, const struct iovec *iov, int iovcnt, std::vector<int> *fds);
+
+    /// send(2) with MSG_ZEROCOPY, the bytes must stay untouched until the
+    /// completion for this send is read back. Needs SO_ZEROCOPY.
+    ssize_t sendZeroCopy(int sockfd, const void *buf, size_t count);
+
+    ///
+    /// Reads the next MSG_ZEROCOPY completion off the error queue of
+    /// @c sockfd, other queued errors are skipped. Sends *lo to *hi are
+    /// done; *copied if the kernel copied the data after all.
+    /// @return false once the error queue is empty
+    bool readZeroCopyCompletion(int sockfd, uint32_t *lo, uint32_t *hi, bool *copied);
+
     void close(int sockfd);
 
     void shutdownWrite(int sockfd);
@@ -42,6 +69,11 @@ namespace siren::net::sockets {
 
     int getSocketError(int sockfd);
 
+    ///
+    /// CPU that processed the most recent packet of @c sockfd (SO_INCOMING_CPU),
+    /// -1 if unknown or unsupported.
+    int getIncomingCpu(int sockfd);
+
     const struct sockaddr *sockaddr_cast(const struct sockaddr_in *addr);
 
     const struct sockaddr *sockaddr_cast(const struct sockaddr_in6 *addr);
@@ -37,6 +37,16 @@ namespace siren::net {
 
         void enableRetry() { retry_ = true; }
 
+        /// Reconnect delays start at @c initMs and grow with decorrelated
+        /// jitter up to @c maxMs.
+        /// Not thread safe, call it before connect().
+        void setRetryDelay(int initMs, int maxMs);
+
+        /// Fail fast for @c openMs after @c failures consecutive failed
+        /// connect attempts, then probe once. @c failures == 0 disables it.
+        /// Not thread safe, call it before connect().
+        void setCircuitBreaker(int failures, int openMs);
+
         const string &name() const { return name_; }
 
         /// Set connection callback.
@@ -57,6 +67,10 @@ namespace siren::net {
             writeCompleteCallback_ = std::move(cb);
         }
 
+        /// Set connect failed callback, called in loop thread.
+        /// Not thread safe, call it before connect().
+        void setConnectFailedCallback(ConnectFailedCallback cb);
+
     private:
         /// Not thread safe, but in loop
         void newConnection(int sockfd);
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "siren/net/TcpClient.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace siren::net {
+
+    class EventLoopThreadPool;
+
+    ///
+    /// N warm connections to one endpoint, spread over the loops of an
+    /// EventLoopThreadPool.
+    ///
+    /// Each connection is a TcpClient with retry enabled, so a failed
+    /// connection is re-established in the background by its Connector.
+    /// acquire() picks the connected slot with the fewest outstanding
+    /// leases; borrowing and returning only touch per-slot atomics and the
+    /// slot's own TcpClient mutex, never a pool-wide lock.
+    ///
+    /// Many requests may share one leased connection at the same time. The
+    /// pool does not multiplex: matching responses to requests is left to
+    /// the protocol on top, e.g. the call ids of rpc::RpcChannel.
+    class TcpClientPool : noncopyable {
+    private:
+        struct Slot;
+
+    public:
+        /// A borrowed connection, returned to the pool on destruction.
+        /// It keeps the TcpConnection alive but not the pool: a Lease that
+        /// outlives its pool only drops its connection reference.
+        class Lease {
+        public:
+            Lease() = default;
+            Lease(Lease&& rhs) noexcept;
+            Lease& operator=(Lease&& rhs) noexcept;
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+            ~Lease() { release(); }
+
+            [[nodiscard]] const TcpConnectionPtr& connection() const { return conn_; }
+            TcpConnection* operator->() const { return conn_.get(); }
+            explicit operator bool() const { return static_cast<bool>(conn_); }
+
+            /// gives the connection back early, harmless to call twice
+            void release();
+
+        private:
+            friend class TcpClientPool;
+            Lease(std::weak_ptr<Slot> slot, TcpConnectionPtr conn);
+
+            std::weak_ptr<Slot> slot_;
+            TcpConnectionPtr conn_;
+        };
+
+        /// @param loops started pool, connection i lives on loop i % loops.
+        ///        Call it in the thread of the pool's base loop.
+        TcpClientPool(EventLoopThreadPool* loops, const InetAddress& serverAddr,
+                      const string& nameArg, int numConnections);
+        /// @param loops connection i lives on loops[i % loops.size()], any thread
+        TcpClientPool(const std::vector<EventLoop*>& loops, const InetAddress& serverAddr,
+                      const string& nameArg, int numConnections);
+        /// stop(), then destroys each TcpClient in its own loop; those loops
+        /// must outlive the pool
+        ~TcpClientPool();
+
+        /// Connects every slot. Not thread safe, call it once.
+        void start();
+
+        /// Disconnects every slot and stops reconnecting.
+        void stop();
+
+        /// Borrows the least-busy connected connection.
+        /// Thread safe.
+        /// @return an empty Lease if no connection is up
+        Lease acquire();
+
+        /// Thread safe.
+        [[nodiscard]] int connectedCount() const;
+        [[nodiscard]] int size() const { return static_cast<int>(slots_.size()); }
+        [[nodiscard]] const string& name() const { return name_; }
+
+        /// Set connection callback.
+        /// Not thread safe, call it before start().
+        void setConnectionCallback(ConnectionCallback cb) {
+            connectionCallback_ = std::move(cb);
+        }
+
+        /// Set message callback.
+        /// Not thread safe, call it before start().
+        void setMessageCallback(MessageCallback cb) {
+            messageCallback_ = std::move(cb);
+        }
+
+    private:
+        struct Slot {
+            std::atomic<int> leases{0};
+            std::atomic<bool> connected{false};
+            std::unique_ptr<TcpClient> client;
+        };
+
+        void init(const std::vector<EventLoop*>& loops, const InetAddress& serverAddr,
+                  int numConnections);
+
+        const string name_;
+        ConnectionCallback connectionCallback_;
+        MessageCallback messageCallback_;
+        std::vector<std::shared_ptr<Slot>> slots_;
+        std::atomic<size_t> next_;
+        bool stopped_;
+    };
+
+} // namespace siren::net
@@ -1,22 +1,28 @@
 #pragma once
 
+#include <any>
+#include <deque>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "siren/base/Types.h"
 #include "siren/base/noncopyable.h"
 #include "siren/net/Buffer.h"
 #include "siren/net/Callbacks.h"
 #include "siren/net/InetAddress.h"
+#include "siren/net/SharedPayload.h"
 #include "siren/net/Timer.h"
 // struct tcp_info is in <netinet/tcp.h>
 struct tcp_info;
+struct iovec;
 
 namespace siren {
 namespace net {
 
 class Channel;
 class EventLoop;
+class RelayPipe;
 class Socket;
 
 class TcpConnection : public noncopyable, public
@@ -52,12 +58,47 @@ class TcpConnection : public noncopyable, public
     void send(const std::string& message);
     // void send(Buffer&& message); // C++11
     void send(Buffer* message);  // this one will swap data
+    /// Queues a reference to @c payload, whatever the socket does not take
+    /// right away is written from the shared bytes later, never copied.
+    /// Thread safe.
+    void send(const SharedPayload& payload);
+    /// Gathers iovcnt pieces into one writev() when nothing is queued,
+    /// whatever the kernel does not take is copied to the output buffer.
+    /// Loop thread only, the pieces may be freed once it returns.
+    void sendv(const struct iovec* iov, int iovcnt);
+    /// AF_UNIX only: passes duplicates of @c fds as SCM_RIGHTS on the first
+    /// byte of @c message, which must not be empty. The stream order with
+    /// the other sends is kept, the caller may close its own fds on return.
+    /// Thread safe.
+    void sendFds(const std::vector<int>& fds, const std::string& message);
+    /// AF_UNIX only: descriptors received so far, in arrival order. They
+    /// came with the bytes just read and belong to the caller once taken;
+    /// whatever is never taken is closed with the connection.
+    /// Loop thread only, e.g. from the message callback.
+    std::vector<int> takeReceivedFds();
     void shutdown();             // NOT thread safe, no simultaneous calling
     // void shutdownAndForceCloseAfter(double seconds); // NOT thread safe, no
     // simultaneous calling
     void forceClose();
     void forceCloseWithDelay(double seconds);
     void setTcpNoDelay(bool on);
+    /// SO_BUSY_POLL / SO_PREFER_BUSY_POLL on the socket, see Socket::setBusyPoll
+    void setBusyPoll(int usec, bool prefer = true);
+
+    static const size_t kZeroCopyThreshold = 32 * 1024;
+    /// Sends SharedPayloads of at least @c threshold bytes with MSG_ZEROCOPY:
+    /// the kernel reads the shared bytes in place and the reference is held
+    /// until the completion shows up on the socket error queue. Smaller
+    /// sends stay on the copy path, and so does everything once the kernel
+    /// keeps reporting it copied anyway (loopback, no scatter-gather).
+    /// References still in flight when the connection is torn down
+    /// (connectDestroyed()) move to its loop together with a dup of the
+    /// socket, which is shut down but only closed once the kernel has
+    /// reported every one of them.
+    /// Loop thread only, e.g. from the connection callback.
+    /// @return false if the socket does not support SO_ZEROCOPY
+    bool enableZeroCopy(size_t threshold = kZeroCopyThreshold);
+    bool zeroCopyEnabled() const { return zeroCopyThreshold_ > 0; }
     // reading or not
     void startRead();
     void stopRead();
@@ -65,6 +106,24 @@ class TcpConnection : public noncopyable, public
         return reading_;
     };  // NOT thread safe, may race with start/stopReadInLoop
 
+    /// Links @c a and @c b: from now on whatever one side reads is spliced
+    /// into the other through a pipe of the loop's pool, never through
+    /// inputBuffer_/outputBuffer_, and message callbacks stop firing.
+    /// Bytes already sitting in either input buffer are forwarded first.
+    /// A pipe holds at most the peer's high-water mark, reading pauses
+    /// while it cannot drain. EOF on one side shuts down writing on the
+    /// other once everything before it is out, the pair is closed when
+    /// both directions are done or either side fails.
+    /// Both must be connected and on the same loop. Loop thread only.
+    /// @return false if a side is not connected or no pipe could be opened
+    static bool relay(const TcpConnectionPtr& a, const TcpConnectionPtr& b);
+    /// bytes spliced from this connection into its relay peer
+    uint64_t relayedBytes() const { return relayedBytes_; }
+
+    /// per-connection state of the protocol on top, in loop thread
+    void setContext(const std::any& context) { context_ = context; }
+    const std::any& getContext() const { return context_; }
+    std::any* getMutableContext() { return &context_; }
 
     void setConnectionCallback(const ConnectionCallback& cb) {
         connectionCallback_ = cb;
@@ -88,6 +147,10 @@ class TcpConnection : public noncopyable, public
     Buffer* inputBuffer() { return &inputBuffer_; }
 
     Buffer* outputBuffer() { return &outputBuffer_; }
+    /// Bytes send() accepted that the socket has not taken yet: the output
+    /// buffer, queued SharedPayloads and data waiting behind descriptors.
+    /// 0 means the write is complete. Loop thread only.
+    [[nodiscard]] size_t unsentBytes() const;
 
     /// Internal use only.
     void setCloseCallback(const CloseCallback& cb) { closeCallback_ = cb; }
@@ -110,6 +173,24 @@ class TcpConnection : public noncopyable, public
     // void sendInLoop(string&& message);
     void sendInLoop(const std::string& message);
     void sendInLoop(const void* message, size_t len);
+    void sendPayloadInLoop(const SharedPayload& payload);
+    // takes ownership of fds
+    void sendFdsInLoop(std::vector<int>& fds, const std::string& message);
+    // sends fdQueue_ entries while the socket takes them
+    void writeFdQueue();
+    // writes outputBuffer_ and payloadQueue_ in order, loop thread only
+    void writeQueued();
+    // MSG_ZEROCOPY for sends of zeroCopyThreshold_ bytes and more
+    [[nodiscard]] bool useZeroCopy(size_t len) const {
+        return zeroCopyThreshold_ > 0 && len >= zeroCopyThreshold_;
+    }
+    ssize_t writeZeroCopy(const SharedPayload& payload, size_t offset);
+    void readZeroCopyCompletions();
+    // hands zeroCopyInflight_ and a dup of the socket to the loop's timers
+    void startZeroCopyDrain();
+    [[nodiscard]] size_t pendingBytes() const {
+        return outputBuffer_.readableBytes() + payloadBytes_;
+    }
     void shutdownInLoop();
     // void shutdownAndForceCloseInLoop(double seconds);
     void forceCloseInLoop();
@@ -117,6 +198,9 @@ class TcpConnection : public noncopyable, public
     const char* stateToString() const;
     void startReadInLoop();
     void stopReadInLoop();
+    void relayRead();
+    // moves relayPipe_ into the peer socket, pauses or resumes reading here
+    void relayFlush(const TcpConnectionPtr& peer);
 
     EventLoop* loop_;
     const string name_;
@@ -137,6 +221,41 @@ class TcpConnection : public noncopyable, public
     size_t highWaterMark_;  // TCP 缓冲区移除标识
     Buffer inputBuffer_;    // 读缓冲区
     Buffer outputBuffer_;  
+    // Shared payloads waiting for socket space. Each entry is written after
+    // the bufferBefore bytes of outputBuffer_ queued ahead of it; bytes
+    // appended after the last entry stay in outputBuffer_ behind it.
+    struct PendingPayload {
+        SharedPayload payload;
+        size_t offset;        // bytes of payload already written
+        size_t bufferBefore;  // outputBuffer_ bytes that go first
+    };
+    std::deque<PendingPayload> payloadQueue_;
+    size_t queuedBufferBytes_;  // sum of bufferBefore
+    size_t payloadBytes_;       // unwritten bytes in payloadQueue_
+    std::any context_;
+    // relay mode, bytes read here wait in relayPipe_ for relayPeer_
+    std::weak_ptr<TcpConnection> relayPeer_;
+    std::unique_ptr<RelayPipe> relayPipe_;
+    bool relayEof_;       // read EOF on this side
+    bool relayShutdown_;  // and passed it on to the peer
+    uint64_t relayedBytes_;
+    // MSG_ZEROCOPY sends the kernel has not reported done, the front one
+    // has id zeroCopyFirst_ and ids are consecutive; completed entries are
+    // emptied and popped once they reach the front
+    static const int kZeroCopyMaxCopied = 16;
+    size_t zeroCopyThreshold_;  // 0 when off
+    std::deque<SharedPayload> zeroCopyInflight_;
+    uint32_t zeroCopyFirst_;
+    int zeroCopyCopied_;  // completions in a row the kernel copied anyway
+    // SCM_RIGHTS messages waiting for socket space, after everything that
+    // was pending when they were queued. While any wait, later sends are
+    // appended to the data of the last one.
+    struct PendingFds {
+        std::vector<int> fds;  // owned, sent with the first byte of data
+        std::string data;
+    };
+    std::deque<PendingFds> fdQueue_;
+    std::vector<int> receivedFds_;
 };
 }  // namespace net
 
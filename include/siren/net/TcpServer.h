@@ -1,11 +1,18 @@
+#pragma once
 
 #include "siren/base/Types.h"
+#include "siren/net/EventLoopThreadPool.h"
 #include "siren/net/TcpConnection.h"
 
 #include <map>
 #include <atomic>
 
 namespace siren {
+namespace metrics {
+class Counter;
+class Gauge;
+}  // namespace metrics
+
 namespace net {
 
 class Acceptor;
@@ -41,6 +48,26 @@ class TcpServer : noncopyable {
     /// valid after calling start()
     std::shared_ptr<EventLoopThreadPool> threadPool() { return threadPool_; }
 
+    /// How new connections are spread over the IO loops, default round-robin.
+    /// kConsistentHash is keyed by the peer IP (the path for AF_UNIX), so
+    /// reconnects from one host land on the same loop.
+    /// Not thread safe, call it before start().
+    void setLoopStrategy(EventLoopThreadPool::Strategy strategy);
+    void setLoopSelector(EventLoopThreadPool::LoopSelector selector);
+
+    /// Dispatch each accepted connection to the IO loop pinned to the CPU
+    /// that received its packets (SO_INCOMING_CPU), so the RX softirq and the
+    /// loop share caches. Needs pinned loops, see
+    /// EventLoopThreadPool::setThreadCpus(). Connections whose CPU has no
+    /// loop fall back to round-robin.
+    /// Not thread safe, call it before start().
+    void setIncomingCpuSteering(bool on) { incomingCpuSteering_ = on; }
+
+    /// Sets SO_BUSY_POLL (and SO_PREFER_BUSY_POLL) on every accepted socket,
+    /// 0 disables. Pair it with EventLoop::setBusyPollMicros() on the IO loops.
+    /// Not thread safe, call it before start().
+    void setBusyPoll(int usec) { busyPollUsec_ = usec; }
+
     /// Starts the server if it's not listening.
     ///
     /// It's harmless to call it multiple times.
@@ -88,6 +115,10 @@ class TcpServer : noncopyable {
     // always in loop thread
     int nextConnId_;
     ConnectionMap connections_;
+    bool incomingCpuSteering_;
+    int busyPollUsec_;
+    metrics::Counter* acceptedCounter_;
+    metrics::Gauge* activeGauge_;
 };
 
 }  // namespace net
@@ -45,7 +45,11 @@ namespace net {
     struct TimerCmp {
         bool operator()(const Timer* t1, const Timer* t2) const
         {
-            return t1->expiration() < t2->expiration();
+            // timers due at the same instant are ordered by creation,
+            // otherwise the set would treat them as duplicates
+            if (t1->expiration() != t2->expiration())
+                return t1->expiration() < t2->expiration();
+            return t1->sequence() < t2->sequence();
         }
     };
 } // namespace net
@@ -22,12 +22,16 @@ class TimerQueue {
     explicit TimerQueue(EventLoop* loop);
     ~TimerQueue();
 
-    TimerId addTimer(TimerCallback cb, Timestamp when, int64_t interval);
+    TimerId addTimer(TimerCallback cb, Timestamp when, double interval);
+    /// Thread safe. Cancelling a timer that already fired is a no-op.
     void cancel(TimerId timerId);
 
    private:
     typedef std::set<Timer*, TimerCmp> TimerList;
+    typedef std::pair<Timer*, int64_t> ActiveTimer;
+    typedef std::set<ActiveTimer> ActiveTimerSet;
     void addTimerInLoop(Timer* timer);
+    void cancelInLoop(TimerId timerId);
     void handleRead();
 
     // move out all expired timers
@@ -42,6 +46,11 @@ class TimerQueue {
     Channel timerfdChannel_;
     // Timer list sorted by expiration
     TimerList timers_;
+    // same timers keyed by (address, sequence), so cancel() never
+    // dereferences a timer that is already gone
+    ActiveTimerSet activeTimers_;
+    // repeating timers cancelled from their own callback
+    ActiveTimerSet cancelingTimers_;
 };
 }  // namespace net
 
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "siren/net/UdpSocket.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace siren::net {
+
+    class EventLoop;
+    class EventLoopThreadPool;
+
+    ///
+    /// UDP server, one SO_REUSEPORT socket per IO loop.
+    ///
+    /// The kernel hashes each flow to one of the sockets, so datagrams of
+    /// a peer keep landing on the same loop and the loops never share a
+    /// socket. With no threads the only socket lives on the base loop.
+    class UdpServer : noncopyable {
+    public:
+        typedef std::function<void(EventLoop*)> ThreadInitCallback;
+
+        UdpServer(EventLoop* loop, const InetAddress& listenAddr, const string& nameArg);
+        ~UdpServer();  // force out-line dtor, for std::unique_ptr members.
+
+        [[nodiscard]] const string& name() const { return name_; }
+        [[nodiscard]] EventLoop* getLoop() const { return loop_; }
+
+        /// Not thread safe, call it before start().
+        void setThreadNum(int numThreads);
+        void setThreadInitCallback(const ThreadInitCallback& cb) { threadInitCallback_ = cb; }
+        /// valid after calling start()
+        std::shared_ptr<EventLoopThreadPool> threadPool() { return threadPool_; }
+
+        /// See UdpSocket. Not thread safe, call them before start().
+        void setBatchSize(int batch) { batch_ = batch; }
+        void setMaxDatagramSize(size_t size) { maxDatagram_ = size; }
+        void enableGro(bool on) { gro_ = on; }
+        void enableGso(bool on) { gso_ = on; }
+
+        /// Reply with UdpSocket::send() on the socket passed in, it belongs
+        /// to the loop running the callback.
+        /// Not thread safe, call it before start().
+        void setMessageCallback(const UdpMessageCallback& cb) { messageCallback_ = cb; }
+
+        /// Binds one socket per loop and starts reading.
+        /// It's harmless to call it multiple times.
+        /// In loop thread, it starts the thread pool.
+        void start();
+
+        /// valid after calling start()
+        [[nodiscard]] const std::vector<std::shared_ptr<UdpSocket>>& sockets() const {
+            return sockets_;
+        }
+
+    private:
+        EventLoop* loop_;  // the base loop
+        const InetAddress listenAddr_;
+        const string name_;
+        std::shared_ptr<EventLoopThreadPool> threadPool_;
+        ThreadInitCallback threadInitCallback_;
+        UdpMessageCallback messageCallback_;
+        int batch_;
+        size_t maxDatagram_;
+        bool gro_;
+        bool gso_;
+        std::atomic<int> started_;
+        std::vector<std::shared_ptr<UdpSocket>> sockets_;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "siren/base/Types.h"
+#include "siren/base/noncopyable.h"
+#include "siren/net/Callbacks.h"
+#include "siren/net/InetAddress.h"
+
+#include <sys/socket.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace siren::net {
+
+    class Channel;
+    class EventLoop;
+    class Socket;
+    class UdpSocket;
+
+    /// one datagram, @c data is only valid during the callback
+    typedef std::function<void(UdpSocket*, const char* data, size_t len,
+                               const InetAddress& peer, Timestamp)>
+        UdpMessageCallback;
+
+    ///
+    /// Non-blocking UDP socket owned by one EventLoop.
+    ///
+    /// Reads drain the socket with recvmmsg() into preallocated slots,
+    /// one syscall per batch. send() queues a copy, the queue leaves with
+    /// sendmmsg() once per loop iteration. With GRO the kernel may put
+    /// several datagrams of one flow into a slot; with GSO consecutive
+    /// datagrams of equal size to one peer leave as one UDP_SEGMENT message.
+    /// The callback always sees single datagrams.
+    class UdpSocket : noncopyable {
+    public:
+        static const int kDefaultBatch = 64;
+        static const size_t kDefaultMaxDatagram = 2048;
+        static const size_t kMaxQueued = 8192;  // datagrams, more are dropped
+        static const size_t kGsoMaxSegments = 64;
+        static const size_t kGsoMaxBytes = 65000;
+
+        /// binds to @c bindAddr, port 0 picks a free one
+        UdpSocket(EventLoop* loop, const InetAddress& bindAddr, const string& name,
+                  bool reusePort = false);
+        ~UdpSocket();  // in loop thread
+
+        [[nodiscard]] EventLoop* getLoop() const { return loop_; }
+        [[nodiscard]] const string& name() const { return name_; }
+        [[nodiscard]] const InetAddress& localAddress() const { return localAddr_; }
+        [[nodiscard]] int fd() const;
+
+        /// Datagrams per recvmmsg()/sendmmsg(), default 64.
+        /// Not thread safe, call it before start().
+        void setBatchSize(int batch);
+        /// Slot size, longer datagrams are truncated. Default 2048.
+        /// Not thread safe, call it before start().
+        void setMaxDatagramSize(size_t size);
+        /// UDP_GRO on receive, slots grow to 64 KiB.
+        /// Not thread safe, call it before start().
+        /// @return false if the kernel does not support it
+        bool enableGro(bool on);
+        /// UDP_SEGMENT on send.
+        /// Not thread safe, call it before start().
+        void enableGso(bool on) { gso_ = on; }
+
+        /// Not thread safe, call it before start().
+        void setMessageCallback(UdpMessageCallback cb) { messageCallback_ = std::move(cb); }
+
+        /// Starts reading. Thread safe.
+        void start();
+
+        /// Queues a copy of one datagram. Thread safe.
+        void send(const InetAddress& peer, const void* data, size_t len);
+        /// Writes the queue now rather than at the end of the iteration.
+        /// Loop thread only.
+        void flush();
+
+        /// datagrams received, truncated, and dropped on send; loop thread
+        [[nodiscard]] uint64_t receivedDatagrams() const { return received_; }
+        [[nodiscard]] uint64_t truncatedDatagrams() const { return truncated_; }
+        [[nodiscard]] uint64_t droppedDatagrams() const { return dropped_; }
+
+    private:
+        struct Outgoing {
+            size_t offset;  // into sendArena_
+            size_t len;
+            struct sockaddr_in6 peer;
+        };
+
+        void startInLoop();
+        void allocateSlots();
+        void handleRead(Timestamp receiveTime);
+        void handleWrite();
+        void sendInLoop(const struct sockaddr_in6& peer, const void* data, size_t len);
+        // sends datagrams [first, last) of sendQueue_, grouping for GSO
+        size_t sendBatch(size_t first, size_t last);
+
+        EventLoop* loop_;
+        const string name_;
+        std::unique_ptr<Socket> socket_;
+        std::unique_ptr<Channel> channel_;
+        InetAddress localAddr_;
+        UdpMessageCallback messageCallback_;
+
+        int batch_;
+        size_t maxDatagram_;
+        bool gro_;
+        bool gso_;
+        bool flushQueued_;
+
+        // receive slots, all sized once in allocateSlots()
+        size_t slotSize_;
+        std::vector<char> slots_;
+        std::vector<struct mmsghdr> recvMsgs_;
+        std::vector<struct iovec> recvIovs_;
+        std::vector<struct sockaddr_in6> recvAddrs_;
+        std::vector<char> recvControl_;
+
+        // datagrams waiting for sendmmsg()
+        std::vector<char> sendArena_;
+        std::vector<Outgoing> sendQueue_;
+        std::vector<struct mmsghdr> sendMsgs_;
+        std::vector<struct iovec> sendIovs_;
+        std::vector<char> sendControl_;
+        std::vector<size_t> sendSegments_;  // datagrams in each of sendMsgs_
+
+        uint64_t received_;
+        uint64_t truncated_;
+        uint64_t dropped_;
+
+        // functors queued in the loop hold it weakly and do nothing once
+        // ~UdpSocket, which runs in the same loop, has reset it
+        std::shared_ptr<UdpSocket*> self_;
+    };
+
+} // namespace siren::net
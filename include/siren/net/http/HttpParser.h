@@ -0,0 +1,60 @@
+#pragma once
+
+#include "siren/net/http/HttpRequest.h"
+
+#include <stddef.h>
+
+namespace siren::net {
+
+    class Buffer;
+
+    ///
+    /// Incremental HTTP/1.x request parser over Buffer.
+    ///
+    /// parse() never copies or allocates. It remembers how far it has
+    /// scanned for the end of the header, so a request that arrives over
+    /// many reads is scanned once. It does not consume the buffer: after a
+    /// complete request the caller retrieves requestBytes() and calls
+    /// reset(), which leaves pipelined requests behind it in place.
+    class HttpParser {
+    public:
+        enum Result { kNeedMore, kComplete, kError };
+
+        static const size_t kDefaultMaxHeaderBytes = 8 * 1024;
+        static const size_t kDefaultMaxBodyBytes = 1024 * 1024;
+
+        explicit HttpParser(size_t maxHeaderBytes = kDefaultMaxHeaderBytes,
+                            size_t maxBodyBytes = kDefaultMaxBodyBytes)
+            : maxHeaderBytes_(maxHeaderBytes), maxBodyBytes_(maxBodyBytes) {}
+
+        Result parse(const Buffer* buf, HttpRequest* request);
+
+        /// header plus body of the complete request
+        [[nodiscard]] size_t requestBytes() const { return headerBytes_ + bodyBytes_; }
+
+        /// status code to answer with after kError
+        [[nodiscard]] int errorStatus() const { return errorStatus_; }
+
+        void reset() {
+            scanned_ = 0;
+            headerBytes_ = 0;
+            bodyBytes_ = 0;
+            errorStatus_ = 0;
+        }
+
+    private:
+        bool parseHead(const char* begin, const char* end, HttpRequest* request);
+        Result fail(int status) {
+            errorStatus_ = status;
+            return kError;
+        }
+
+        size_t maxHeaderBytes_;
+        size_t maxBodyBytes_;
+        size_t scanned_ = 0;      // bytes already searched for "\r\n\r\n"
+        size_t headerBytes_ = 0;  // 0 until the header is complete
+        size_t bodyBytes_ = 0;
+        int errorStatus_ = 0;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <utility>
+
+namespace siren::net {
+
+    namespace detail {
+        /// ASCII case-insensitive equality, for header names and tokens
+        bool equalsIgnoreCase(std::string_view a, std::string_view b);
+    } // namespace detail
+
+    ///
+    /// A parsed HTTP/1.x request.
+    ///
+    /// Every field is a view into the connection's input buffer, nothing is
+    /// copied; a request is only valid during the HttpServer callback.
+    class HttpRequest {
+    public:
+        enum Method { kInvalid, kGet, kPost, kHead, kPut, kDelete, kOptions, kPatch };
+        enum Version { kUnknown, kHttp10, kHttp11 };
+
+        static const int kMaxHeaders = 32;
+
+        typedef std::pair<std::string_view, std::string_view> Header;
+
+        [[nodiscard]] Method method() const { return method_; }
+        [[nodiscard]] std::string_view methodString() const { return methodString_; }
+        [[nodiscard]] Version version() const { return version_; }
+        [[nodiscard]] std::string_view path() const { return path_; }
+        /// without the leading '?'
+        [[nodiscard]] std::string_view query() const { return query_; }
+        [[nodiscard]] std::string_view body() const { return body_; }
+
+        /// @return the value of the first header named @c field, compared
+        /// case-insensitively, or an empty view
+        [[nodiscard]] std::string_view getHeader(std::string_view field) const;
+        [[nodiscard]] int headerCount() const { return numHeaders_; }
+        [[nodiscard]] const Header& header(int i) const { return headers_[i]; }
+
+        /// HTTP/1.1 unless "Connection: close", HTTP/1.0 only with
+        /// "Connection: Keep-Alive"
+        [[nodiscard]] bool keepAlive() const;
+
+    private:
+        friend class HttpParser;
+
+        Method method_ = kInvalid;
+        Version version_ = kUnknown;
+        std::string_view methodString_;
+        std::string_view path_;
+        std::string_view query_;
+        std::string_view body_;
+        std::array<Header, kMaxHeaders> headers_;
+        int numHeaders_ = 0;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "siren/base/Types.h"
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace siren::net {
+
+    class Buffer;
+
+    ///
+    /// An HTTP/1.1 response.
+    ///
+    /// HttpServer keeps one per connection and reset()s it between
+    /// requests, so the strings keep their capacity and a steady stream of
+    /// similar responses does not allocate.
+    class HttpResponse {
+    public:
+        enum HttpStatusCode {
+            kUnknown,
+            k200Ok = 200,
+            k204NoContent = 204,
+            k301MovedPermanently = 301,
+            k400BadRequest = 400,
+            k403Forbidden = 403,
+            k404NotFound = 404,
+            k413PayloadTooLarge = 413,
+            k426UpgradeRequired = 426,
+            k431HeaderFieldsTooLarge = 431,
+            k500InternalServerError = 500,
+            k501NotImplemented = 501,
+        };
+
+        explicit HttpResponse(bool close = false) : closeConnection_(close) {}
+
+        void reset(bool close);
+
+        /// also sets the standard reason phrase
+        void setStatusCode(int code);
+        void setStatusMessage(std::string_view message) { statusMessage_.assign(message); }
+        [[nodiscard]] int statusCode() const { return statusCode_; }
+
+        void setCloseConnection(bool on) { closeConnection_ = on; }
+        [[nodiscard]] bool closeConnection() const { return closeConnection_; }
+
+        void setContentType(std::string_view contentType) { contentType_.assign(contentType); }
+        void addHeader(std::string_view key, std::string_view value);
+
+        void setBody(std::string_view body) { body_.assign(body); }
+        string* mutableBody() { return &body_; }
+
+        /// Serializes straight into @c output.
+        /// @param date pre-rendered "Date" header line, may be empty
+        /// @param withBody false for HEAD, Content-Length is still sent
+        void appendToBuffer(Buffer* output, std::string_view date, bool withBody = true) const;
+
+        static std::string_view reasonPhrase(int code);
+
+    private:
+        int statusCode_ = kUnknown;
+        string statusMessage_;
+        bool closeConnection_;
+        string contentType_;
+        std::vector<std::pair<string, string>> headers_;
+        size_t numHeaders_ = 0;  // live entries of headers_, the rest keep capacity
+        string body_;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "siren/net/TcpServer.h"
+
+namespace siren::net {
+
+    class HttpRequest;
+    class HttpResponse;
+
+    ///
+    /// HTTP/1.1 server on top of TcpServer, with keep-alive and pipelining.
+    ///
+    /// All requests parsed from one read are answered in order and their
+    /// responses serialized into one buffer, which is sent with a single
+    /// write. Each loop keeps a pre-rendered "Date" header refreshed by a
+    /// one-second timer.
+    class HttpServer : noncopyable {
+    public:
+        typedef std::function<void(const HttpRequest&, HttpResponse*)> HttpCallback;
+
+        HttpServer(EventLoop* loop, const InetAddress& listenAddr, const string& name,
+                   TcpServer::Option option = TcpServer::kNoReusePort);
+
+        EventLoop* getLoop() const { return server_.getLoop(); }
+
+        /// Not thread safe, callback be registered before calling start().
+        void setHttpCallback(const HttpCallback& cb) { httpCallback_ = cb; }
+
+        void setThreadNum(int numThreads) { server_.setThreadNum(numThreads); }
+
+        /// Request limits, answered with 431 / 413.
+        /// Not thread safe, call it before start().
+        void setMaxRequestSize(size_t headerBytes, size_t bodyBytes) {
+            maxHeaderBytes_ = headerBytes;
+            maxBodyBytes_ = bodyBytes;
+        }
+
+        void start();
+
+        /// @return "Date: ...\r\n" of the calling loop thread
+        static std::string_view cachedDateHeader();
+
+    private:
+        void onConnection(const TcpConnectionPtr& conn);
+        void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+        static void initLoop(EventLoop* loop);
+
+        TcpServer server_;
+        HttpCallback httpCallback_;
+        size_t maxHeaderBytes_;
+        size_t maxBodyBytes_;
+    };
+
+} // namespace siren::net
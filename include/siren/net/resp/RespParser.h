@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+#include <vector>
+
+namespace siren::net {
+
+    class Buffer;
+
+    ///
+    /// One RESP2/RESP3 value. Aggregates are followed by their children in
+    /// pre-order, so a parsed message is a flat array.
+    struct RespValue {
+        enum Type : char {
+            kSimpleString = '+',
+            kError = '-',
+            kInteger = ':',
+            kBulkString = '$',
+            kArray = '*',
+            // RESP3
+            kNull = '_',
+            kBoolean = '#',
+            kDouble = ',',
+            kBigNumber = '(',
+            kBlobError = '!',
+            kVerbatim = '=',
+            kMap = '%',
+            kSet = '~',
+            kAttribute = '|',
+            kPush = '>',
+        };
+
+        Type type;
+        bool null = false;     // '_', or RESP2 "$-1" / "*-1"
+        int64_t integer = 0;   // ':' value, '#' as 0/1
+        std::string_view str;  // string payload, or the text of ',' and '('
+        size_t count = 0;      // direct children of an aggregate, a map of n pairs has 2n
+        size_t span = 1;       // values in this subtree, itself included
+
+        // position of str in the input, used while the message is incomplete
+        size_t offset = 0;
+        size_t length = 0;
+
+        [[nodiscard]] bool isAggregate() const;
+        [[nodiscard]] bool isString() const;
+    };
+
+    ///
+    /// Incremental RESP parser.
+    ///
+    /// parse() resumes where the previous call stopped: complete elements of
+    /// a partially received array are kept, and only the unfinished element
+    /// is looked at again. Values are views into the input and the value
+    /// vector is reused across messages, so steady-state parsing does not
+    /// allocate. The caller consumes consumedBytes() after kComplete and
+    /// calls reset(); the input must not be consumed in between.
+    ///
+    /// An attribute ('|') is modelled as an aggregate whose last child is
+    /// the value it annotates.
+    class RespParser {
+    public:
+        enum Result { kNeedMore, kComplete, kError };
+
+        static const size_t kMaxLineBytes = 64 * 1024;
+
+        /// @param acceptInline accept telnet-style "SET k v\r\n" commands,
+        /// parsed as an array of bulk strings (server side only)
+        explicit RespParser(bool acceptInline = false,
+                            size_t maxBulkBytes = 512 * 1024 * 1024,
+                            size_t maxElements = 1024 * 1024)
+            : acceptInline_(acceptInline),
+              maxBulkBytes_(maxBulkBytes),
+              maxElements_(maxElements) {}
+
+        Result parse(const char* data, size_t len);
+        Result parse(const Buffer* buf);
+
+        /// the complete message after kComplete, root first
+        [[nodiscard]] const std::vector<RespValue>& values() const { return values_; }
+        [[nodiscard]] const RespValue& root() const { return values_.front(); }
+        [[nodiscard]] size_t consumedBytes() const { return pos_; }
+        /// after kError
+        [[nodiscard]] const char* errorMessage() const { return error_; }
+
+        void reset() {
+            values_.clear();
+            stack_.clear();
+            pos_ = 0;
+            error_ = nullptr;
+        }
+
+    private:
+        struct Frame {
+            size_t index;
+            size_t remaining;
+        };
+
+        Result parseInline(const char* data, size_t len);
+        Result complete(const char* data);
+        Result fail(const char* message) {
+            error_ = message;
+            return kError;
+        }
+
+        bool acceptInline_;
+        size_t maxBulkBytes_;
+        size_t maxElements_;
+        std::vector<RespValue> values_;
+        std::vector<Frame> stack_;  // open aggregates
+        size_t pos_ = 0;
+        const char* error_ = nullptr;
+    };
+
+    ///
+    /// A command: an array of bulk strings, viewed in place.
+    class RespCommand {
+    public:
+        RespCommand(const RespValue* args, size_t argc) : args_(args), argc_(argc) {}
+
+        [[nodiscard]] size_t argc() const { return argc_; }
+        [[nodiscard]] std::string_view arg(size_t i) const { return args_[i].str; }
+        [[nodiscard]] std::string_view name() const { return args_[0].str; }
+        /// case-insensitive
+        [[nodiscard]] bool is(std::string_view command) const;
+
+    private:
+        const RespValue* args_;
+        size_t argc_;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "siren/net/TcpServer.h"
+
+namespace siren::net {
+
+    class RespCommand;
+    class RespWriter;
+
+    ///
+    /// A RESP server on top of TcpServer.
+    ///
+    /// Every command parsed from one read is dispatched in order, and the
+    /// replies are encoded into one per-connection buffer that is sent with
+    /// a single write. QUIT is answered here; the callback sees everything
+    /// else and may switch the connection to RESP3 with
+    /// RespWriter::setProtocol(), e.g. on HELLO 3.
+    class RespServer : noncopyable {
+    public:
+        typedef std::function<void(const TcpConnectionPtr&, const RespCommand&, RespWriter*)>
+            CommandCallback;
+
+        RespServer(EventLoop* loop, const InetAddress& listenAddr, const string& name,
+                   TcpServer::Option option = TcpServer::kNoReusePort);
+
+        EventLoop* getLoop() const { return server_.getLoop(); }
+
+        /// Not thread safe, callback be registered before calling start().
+        void setCommandCallback(const CommandCallback& cb) { commandCallback_ = cb; }
+
+        void setThreadNum(int numThreads) { server_.setThreadNum(numThreads); }
+
+        void start();
+
+    private:
+        void onConnection(const TcpConnectionPtr& conn);
+        void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+
+        TcpServer server_;
+        CommandCallback commandCallback_;
+    };
+
+} // namespace siren::net
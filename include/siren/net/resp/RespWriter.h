@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <initializer_list>
+#include <string_view>
+
+namespace siren::net {
+
+    class Buffer;
+
+    ///
+    /// Encodes RESP replies and commands straight into a Buffer.
+    ///
+    /// With protocol 2 the RESP3-only types fall back to their RESP2
+    /// spelling: null to "$-1", maps to flat arrays, booleans to integers
+    /// and doubles to bulk strings.
+    class RespWriter {
+    public:
+        explicit RespWriter(Buffer* output, int protocol = 2)
+            : output_(output), protocol_(protocol) {}
+
+        [[nodiscard]] int protocol() const { return protocol_; }
+        void setProtocol(int protocol) { protocol_ = protocol; }
+        [[nodiscard]] Buffer* output() const { return output_; }
+
+        void simpleString(std::string_view s);
+        void ok() { simpleString("OK"); }
+        /// @c message should start with an error code such as "ERR"
+        void error(std::string_view message);
+        void integer(int64_t value);
+        void bulkString(std::string_view s);
+        void null();
+        void boolean(bool value);
+        void doubleValue(double value);
+        void arrayHeader(size_t n);
+        /// @c n key/value pairs follow
+        void mapHeader(size_t n);
+        void setHeader(size_t n);
+
+        /// client side: an array of bulk strings
+        void command(std::initializer_list<std::string_view> args);
+
+    private:
+        void header(char type, int64_t n);
+        void append(std::string_view s);
+
+        Buffer* output_;
+        int protocol_;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "siren/base/noncopyable.h"
+#include "siren/net/Callbacks.h"
+#include "siren/net/TimerId.h"
+#include "siren/net/rpc/RpcHeader.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace siren::net {
+
+    class Buffer;
+    class EventLoop;
+    class RpcChannel;
+
+    ///
+    /// Completes one request, possibly later and from another thread.
+    ///
+    /// Copyable; the first reply() or fail() wins on the calling side,
+    /// further ones are dropped there as unknown call ids. A reply after
+    /// the caller's timeout is dropped here, before it hits the wire.
+    class RpcResponder {
+    public:
+        RpcResponder() = default;
+
+        /// Thread safe. The payload is moved all the way into writev().
+        void reply(std::string response) const;
+
+        /// Thread safe.
+        void fail(RpcStatus status = RpcStatus::kHandlerError) const;
+
+        /// true once the caller has given up, long handlers may bail out
+        [[nodiscard]] bool expired() const;
+
+        [[nodiscard]] uint64_t callId() const { return callId_; }
+
+    private:
+        friend class RpcChannel;
+        typedef std::chrono::steady_clock::time_point Deadline;
+
+        RpcResponder(std::weak_ptr<RpcChannel> channel, uint64_t callId, Deadline deadline)
+            : channel_(std::move(channel)), callId_(callId), deadline_(deadline) {}
+
+        std::weak_ptr<RpcChannel> channel_;
+        uint64_t callId_ = 0;
+        Deadline deadline_ = Deadline::max();
+    };
+
+    /// @c request points into the connection's input buffer and is only
+    /// valid during the call; the responder may outlive it.
+    typedef std::function<void(std::string_view request, RpcResponder responder)> RpcHandler;
+    typedef std::unordered_map<uint32_t, RpcHandler> RpcMethodMap;
+
+    /// @c response is empty unless @c status is kOk, and is only valid
+    /// during the call. Runs in the connection's loop thread, except when
+    /// RpcClient fails a call up front because it is not connected.
+    typedef std::function<void(RpcStatus status, std::string_view response)> RpcCallback;
+
+    ///
+    /// The RPC state of one connection, kept in its context. Both sides
+    /// use it: it sends requests and matches their responses against a
+    /// table of outstanding calls, and it dispatches incoming requests to
+    /// a method map.
+    ///
+    /// Frames produced anywhere (calls from any thread, replies from
+    /// handlers or worker threads) are queued under a mutex and sent by
+    /// one flush() per loop iteration, so all replies to one read and all
+    /// calls made meanwhile leave in a single writev(). Small payloads are
+    /// copied next to their headers, large ones are handed to writev()
+    /// straight from the moved-in string.
+    class RpcChannel : noncopyable, public std::enable_shared_from_this<RpcChannel> {
+    public:
+        /// frames announcing a larger payload close the connection
+        static const uint32_t kMaxPayload = 64 * 1024 * 1024;
+        /// payloads below this are coalesced with the headers
+        static const size_t kCopyThreshold = 512;
+
+        /// @param methods may be null on a pure client, must outlive the channel
+        RpcChannel(const TcpConnectionPtr& conn, const RpcMethodMap* methods);
+
+        /// Sends a request, @c done runs in the loop thread.
+        /// @param timeoutMs 0 means wait forever
+        /// Thread safe.
+        void call(uint32_t methodId, std::string request, RpcCallback done, int timeoutMs);
+
+        /// Loop thread, from the connection's message callback.
+        void onMessage(const TcpConnectionPtr& conn, Buffer* buf);
+
+        /// Loop thread, fails every outstanding call with kConnectionLost.
+        void onDisconnected();
+
+        [[nodiscard]] EventLoop* getLoop() const { return loop_; }
+
+        /// Loop thread.
+        [[nodiscard]] size_t outstandingCalls() const { return outstanding_.size(); }
+
+    private:
+        friend class RpcResponder;
+
+        struct Frame {
+            char header[RpcHeader::kSize];
+            std::string payload;
+            RpcCallback done;  // requests only
+            uint64_t callId;
+            int timeoutMs;
+        };
+
+        struct Outstanding {
+            RpcCallback done;
+            TimerId timer;
+            bool hasTimer;
+        };
+
+        void reply(uint64_t callId, RpcStatus status, std::string response);
+        void enqueue(Frame&& frame);
+        void flush();
+        void onTimeout(uint64_t callId);
+        void dispatch(const RpcHeader& header, std::string_view payload);
+
+        EventLoop* loop_;
+        std::weak_ptr<TcpConnection> conn_;
+        const RpcMethodMap* methods_;
+        std::atomic<uint64_t> nextCallId_;
+
+        std::mutex mutex_;
+        std::vector<Frame> pending_;  // guarded by mutex_
+        bool flushQueued_;            // guarded by mutex_
+
+        // loop thread only
+        std::vector<Frame> sending_;
+        std::string scratch_;
+        std::unordered_map<uint64_t, Outstanding> outstanding_;
+    };
+
+    typedef std::shared_ptr<RpcChannel> RpcChannelPtr;
+
+} // namespace siren::net
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "siren/net/TcpClient.h"
+#include "siren/net/rpc/RpcChannel.h"
+
+namespace siren::net {
+
+    ///
+    /// RPC client over one TcpClient connection.
+    ///
+    /// Any number of calls may be in flight; calls made from other threads
+    /// are queued and sent together with the next flush of the channel.
+    class RpcClient : noncopyable {
+    public:
+        RpcClient(EventLoop* loop, const InetAddress& serverAddr, const string& name);
+
+        void connect() { client_.connect(); }
+        void disconnect() { client_.disconnect(); }
+        void enableRetry() { client_.enableRetry(); }
+
+        EventLoop* getLoop() const { return client_.getLoop(); }
+
+        /// Set connection callback.
+        /// Not thread safe, call it before connect().
+        void setConnectionCallback(ConnectionCallback cb) {
+            connectionCallback_ = std::move(cb);
+        }
+
+        /// Thread safe. Fails with kConnectionLost in the calling thread
+        /// when there is no connection.
+        /// @param timeoutMs 0 means wait forever
+        void call(uint32_t methodId, std::string request, RpcCallback done,
+                  int timeoutMs = 0);
+
+        void call(std::string_view method, std::string request, RpcCallback done,
+                  int timeoutMs = 0) {
+            call(rpcMethodId(method), std::move(request), std::move(done), timeoutMs);
+        }
+
+        /// Thread safe.
+        [[nodiscard]] bool connected() const;
+
+    private:
+        void onConnection(const TcpConnectionPtr& conn);
+        void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+
+        TcpClient client_;
+        ConnectionCallback connectionCallback_;
+        mutable std::mutex mutex_;
+        RpcChannelPtr channel_;  // guarded by mutex_
+    };
+
+} // namespace siren::net
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+namespace siren::net {
+
+    enum class RpcStatus : uint8_t {
+        kOk = 0,
+        kNoSuchMethod,
+        kHandlerError,
+        // never on the wire, produced on the calling side
+        kTimeout,
+        kConnectionLost,
+    };
+
+    const char* rpcStatusToString(RpcStatus status);
+
+    /// FNV-1a of the method name, the id carried in every request.
+    constexpr uint32_t rpcMethodId(std::string_view name) {
+        uint32_t hash = 2166136261u;
+        for (char c : name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    ///
+    /// Fixed 24-byte frame header, all fields big-endian:
+    ///
+    ///   magic u16 | type u8 | status u8 | length u32 |
+    ///   callId u64 | methodId u32 | timeoutMs u32
+    ///
+    /// @c length counts the payload only. Responses echo the request's
+    /// callId; methodId and timeoutMs are only meaningful in requests.
+    struct RpcHeader {
+        enum Type : uint8_t { kRequest = 0, kResponse = 1 };
+
+        static const size_t kSize = 24;
+        static const uint16_t kMagic = 0x5352;  // "SR"
+
+        Type type = kRequest;
+        RpcStatus status = RpcStatus::kOk;
+        uint32_t length = 0;
+        uint64_t callId = 0;
+        uint32_t methodId = 0;
+        uint32_t timeoutMs = 0;
+
+        void encode(char* out) const;
+
+        /// @return false if @c in does not start with kMagic or has an unknown type
+        bool decode(const char* in);
+    };
+
+} // namespace siren::net
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "siren/net/TcpServer.h"
+#include "siren/net/rpc/RpcChannel.h"
+
+namespace siren::net {
+
+    ///
+    /// RPC server on top of TcpServer.
+    ///
+    /// Each connection gets an RpcChannel; requests are dispatched by
+    /// method id in the IO thread. A handler may answer right away or keep
+    /// the RpcResponder and answer from any thread later, replies are
+    /// batched into one writev() per loop iteration either way.
+    class RpcServer : noncopyable {
+    public:
+        RpcServer(EventLoop* loop, const InetAddress& listenAddr, const string& name,
+                  TcpServer::Option option = TcpServer::kNoReusePort);
+
+        EventLoop* getLoop() const { return server_.getLoop(); }
+
+        /// Not thread safe, register every method before calling start().
+        void registerMethod(const string& method, RpcHandler handler);
+
+        void setThreadNum(int numThreads) { server_.setThreadNum(numThreads); }
+
+        void setThreadInitCallback(const TcpServer::ThreadInitCallback& cb) {
+            server_.setThreadInitCallback(cb);
+        }
+
+        void start();
+
+    private:
+        void onConnection(const TcpConnectionPtr& conn);
+        void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+
+        TcpServer server_;
+        RpcMethodMap methods_;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+namespace siren::net {
+
+    class Buffer;
+
+    namespace websocket {
+
+        enum Opcode : uint8_t {
+            kContinuation = 0x0,
+            kText = 0x1,
+            kBinary = 0x2,
+            kClose = 0x8,
+            kPing = 0x9,
+            kPong = 0xA,
+        };
+
+        enum CloseCode : uint16_t {
+            kNormalClosure = 1000,
+            kGoingAway = 1001,
+            kProtocolError = 1002,
+            kUnsupportedData = 1003,
+            kInvalidPayload = 1007,
+            kMessageTooBig = 1009,
+            kInternalError = 1011,
+        };
+
+        /// largest frame header: 2 + 8 byte length + 4 byte mask
+        static const size_t kMaxHeaderSize = 14;
+
+        /// XORs @c len bytes with the 4-byte masking key, @c offset being the
+        /// position of data[0] within the frame payload. Uses AVX2/SSE2
+        /// when the target has them, 8-byte words otherwise.
+        void unmask(char* data, size_t len, const uint8_t key[4], size_t offset = 0);
+
+        /// Writes a frame header into @c out and returns its size.
+        /// @param mask non-null for client frames, the payload must then be
+        /// masked with the same key
+        size_t encodeHeader(char* out, Opcode opcode, uint64_t payloadLen, bool fin = true,
+                            bool compressed = false, const uint8_t* mask = nullptr);
+
+        /// Appends one unfragmented, unmasked frame.
+        void appendFrame(Buffer* output, Opcode opcode, std::string_view payload,
+                         bool compressed = false);
+
+        /// Appends one masked frame, as a client sends it.
+        void appendMaskedFrame(Buffer* output, Opcode opcode, std::string_view payload,
+                               const uint8_t mask[4]);
+
+        /// Appends a close frame carrying @c code and @c reason.
+        void appendCloseFrame(Buffer* output, uint16_t code, std::string_view reason = {});
+
+    } // namespace websocket
+
+    ///
+    /// Incremental WebSocket frame parser over Buffer.
+    ///
+    /// Payloads are unmasked where they lie. Fragments of one message are
+    /// assembled in place too: each finished fragment's payload is moved
+    /// down to follow the previous one, so a fragmented message ends up
+    /// contiguous at the front of the buffer without a second buffer. An
+    /// unfragmented message is not moved at all. Control frames may arrive
+    /// between fragments and are handed out as soon as they complete.
+    ///
+    /// parse() does not consume the buffer; the caller retrieves
+    /// consumedBytes() and calls next() once it is done with message().
+    class WebSocketParser {
+    public:
+        enum Result {
+            kNeedMore,
+            kMessage,  // a complete data message, see opcode() and message()
+            kControl,  // a ping, pong or close frame, message() is its payload
+            kError,    // see closeCode()
+        };
+
+        static const size_t kDefaultMaxMessageSize = 16 * 1024 * 1024;
+
+        /// @param server true expects masked frames, as sent by clients
+        explicit WebSocketParser(bool server = true,
+                                 size_t maxMessageSize = kDefaultMaxMessageSize)
+            : server_(server), maxMessageSize_(maxMessageSize) {}
+
+        Result parse(Buffer* buf);
+
+        [[nodiscard]] websocket::Opcode opcode() const { return opcode_; }
+        /// RSV1 of the message's first frame, set by permessage-deflate
+        [[nodiscard]] bool compressed() const { return compressed_; }
+        /// valid until next(), points into the buffer
+        [[nodiscard]] std::string_view message() const { return message_; }
+        /// bytes the caller retrieves after kMessage / kControl
+        [[nodiscard]] size_t consumedBytes() const { return consumed_; }
+        [[nodiscard]] uint16_t closeCode() const { return closeCode_; }
+
+        /// After kMessage: forget the message, the caller has retrieved
+        /// consumedBytes(). After kControl: the frame is skipped but nothing
+        /// is retrieved while a fragmented message is still being assembled.
+        void next();
+
+        void setRsv1Allowed(bool on) { rsv1Allowed_ = on; }
+
+    private:
+        Result fail(uint16_t code) {
+            closeCode_ = code;
+            return kError;
+        }
+
+        const bool server_;
+        const size_t maxMessageSize_;
+        bool rsv1Allowed_ = false;
+
+        // offsets relative to buf->peek()
+        size_t assembled_ = 0;  // payload bytes of the current message at the front
+        size_t scanned_ = 0;    // start of the next unparsed frame
+        size_t controlEnd_ = 0; // end of the last control frame
+        bool inMessage_ = false;
+        bool lastWasControl_ = false;
+
+        websocket::Opcode opcode_ = websocket::kText;
+        websocket::Opcode messageOpcode_ = websocket::kText;
+        bool compressed_ = false;
+        std::string_view message_;
+        size_t consumed_ = 0;
+        uint16_t closeCode_ = 0;
+    };
+
+} // namespace siren::net
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "siren/net/TcpServer.h"
+#include "siren/net/websocket/WebSocketFrame.h"
+
+#include <string_view>
+#include <vector>
+
+namespace siren::net {
+
+    class HttpRequest;
+
+    ///
+    /// WebSocket (RFC 6455) server on top of TcpServer.
+    ///
+    /// A connection starts as HTTP; a valid upgrade request is answered
+    /// with 101 and the connection switches to WebSocketParser. Pings are
+    /// answered and close frames echoed here, the callbacks only see data
+    /// messages.
+    ///
+    /// With enableDeflate(), permessage-deflate is negotiated with both
+    /// sides' context takeover disabled. That lets each loop keep one
+    /// deflate and one inflate stream for all its connections instead of
+    /// ~300KB of zlib state per connection, and lets broadcast() compress
+    /// a message once for every receiver.
+    class WebSocketServer : noncopyable {
+    public:
+        /// return false to refuse the upgrade with 403
+        typedef std::function<bool(const TcpConnectionPtr&, const HttpRequest&)>
+            UpgradeCallback;
+        /// @c message is only valid during the call
+        typedef std::function<void(const TcpConnectionPtr&, std::string_view message,
+                                   websocket::Opcode opcode)>
+            WebSocketCallback;
+
+        WebSocketServer(EventLoop* loop, const InetAddress& listenAddr, const string& name,
+                        TcpServer::Option option = TcpServer::kNoReusePort);
+
+        EventLoop* getLoop() const { return server_.getLoop(); }
+
+        /// Not thread safe, callbacks be registered before calling start().
+        void setUpgradeCallback(const UpgradeCallback& cb) { upgradeCallback_ = cb; }
+        /// called after the upgrade and when an upgraded connection goes down
+        void setConnectionCallback(const ConnectionCallback& cb) { connectionCallback_ = cb; }
+        void setMessageCallback(const WebSocketCallback& cb) { messageCallback_ = cb; }
+
+        /// Not thread safe, call it before start().
+        void setMaxMessageSize(size_t bytes) { maxMessageSize_ = bytes; }
+        void enableDeflate(bool on) { deflate_ = on; }
+
+        void setThreadNum(int numThreads) { server_.setThreadNum(numThreads); }
+
+        void start();
+
+        /// Sends one message. Thread safe, an off-loop call copies it once.
+        static void send(const TcpConnectionPtr& conn, std::string_view message,
+                         websocket::Opcode opcode = websocket::kText);
+
+        /// Sends a close frame and closes once the peer answers.
+        /// Thread safe.
+        static void close(const TcpConnectionPtr& conn,
+                          uint16_t code = websocket::kNormalClosure,
+                          std::string_view reason = {});
+
+        /// Serializes @c message into a frame once (and compresses it once
+        /// for connections that negotiated deflate), then queues the same
+        /// SharedPayload on every connection, one task per owning loop.
+        /// Thread safe.
+        static void broadcast(const std::vector<TcpConnectionPtr>& conns,
+                              std::string_view message,
+                              websocket::Opcode opcode = websocket::kText);
+
+    private:
+        void onConnection(const TcpConnectionPtr& conn);
+        void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+        void onHandshake(const TcpConnectionPtr& conn, Buffer* buf);
+        void onFrames(const TcpConnectionPtr& conn, Buffer* buf);
+
+        TcpServer server_;
+        UpgradeCallback upgradeCallback_;
+        ConnectionCallback connectionCallback_;
+        WebSocketCallback messageCallback_;
+        size_t maxMessageSize_;
+        bool deflate_;
+    };
+
+} // namespace siren::net
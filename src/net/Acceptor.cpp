@@ -5,10 +5,45 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 using namespace siren::net;
 
+namespace {
+
+// A socket file left behind by an earlier run would fail bind(). Only a
+// socket nobody listens on is removed: anything else at the path, or a
+// live server, is left alone and bind() reports the clash.
+// returns false if the path belongs to someone else
+bool removeStaleUnixSocket(const InetAddress& addr) {
+    const std::string path = addr.toIp();
+    struct stat st;
+    if (::lstat(path.c_str(), &st) < 0) {
+        return errno == ENOENT;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        LOG_ERROR("Acceptor: {} exists and is not a socket, not removing it", path);
+        return false;
+    }
+    int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        LOG_ERROR("Acceptor: socket() for probing {}, errno = {}", path, errno);
+        return false;
+    }
+    const int ret = ::connect(probe, addr.getSockAddr(), addr.length());
+    const int savedErrno = errno;
+    ::close(probe);
+    if (ret == 0 || savedErrno != ECONNREFUSED) {
+        LOG_ERROR("Acceptor: {} is in use, not removing it", path);
+        return false;
+    }
+    ::unlink(path.c_str());
+    return true;
+}
+
+}  // namespace
+
 siren::net::Acceptor::Acceptor(EventLoop* loop, const InetAddress& listenAddr, bool reuseport)
     : loop_(loop)
     , acceptSocket_(sockets::createNonblockingOrDie(listenAddr.family()))
@@ -20,6 +55,11 @@ siren::net::Acceptor::Acceptor(EventLoop* loop, const InetAddress& listenAddr, b
     assert(idleFd_ >= 0);
     acceptSocket_.setReuseAddr(true);
     acceptSocket_.setReusePort(reuseport);
+    if (listenAddr.family() == AF_UNIX && listenAddr.toIp()[0] != '@'
+        && removeStaleUnixSocket(listenAddr)) {
+        // ours once bound, ~Acceptor removes it
+        unixPath_ = listenAddr.toIp();
+    }
     acceptSocket_.bindAddress(listenAddr);
     acceptChannel_.setReadCallback(
         std::bind(&Acceptor::handleRead, this));
@@ -30,6 +70,9 @@ Acceptor::~Acceptor()
     acceptChannel_.disableAll();
     acceptChannel_.remove();
     ::close(idleFd_);
+    if (!unixPath_.empty()) {
+        ::unlink(unixPath_.c_str());
+    }
 }
 void Acceptor::listen()
 {
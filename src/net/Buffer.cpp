@@ -3,17 +3,30 @@
 #include <errno.h>
 #include <sys/uio.h>
 
+#include "siren/base/Metrics.h"
 #include "siren/net/SocketsOps.h"
 
 using namespace siren;
 using namespace siren::net;
 
+namespace {
+metrics::Counter& g_bufferReadBytes = metrics::counter(
+    "siren_buffer_read_bytes_total", "Bytes read from sockets into Buffers");
+metrics::Counter& g_bufferSpills = metrics::counter(
+    "siren_buffer_extrabuf_spills_total",
+    "Reads that overflowed into the stack extrabuf and grew a Buffer");
+}  // namespace
+
 const char Buffer::kCRLF[] = "\r\n";
 
 const size_t Buffer::kCheapPrepend;
 const size_t Buffer::kInitialSize;
 
 ssize_t Buffer::readFd(int fd) {
+    return readFd(fd, nullptr);
+}
+
+ssize_t Buffer::readFd(int fd, std::vector<int>* fds) {
     // saved an ioctl()/FIONREAD call to tell how much to read
     char extrabuf[65536];
     struct iovec vec[2];
@@ -23,14 +36,18 @@ ssize_t Buffer::readFd(int fd) {
     vec[1].iov_base = extrabuf;
     vec[1].iov_len = sizeof extrabuf;
     const int iovcnt = (writable < sizeof extrabuf) ? 2 : 1;
-    const ssize_t n = sockets::readv(fd, vec, iovcnt);
+    const ssize_t n = fds ? sockets::readvFds(fd, vec, iovcnt, fds)
+                          : sockets::readv(fd, vec, iovcnt);
     if (n < 0) {
         // *savedErrno = errno;
     } else if (static_cast<size_t>(n) <= writable) {
         writerIndex_ += n;
+        g_bufferReadBytes.inc(n);
     } else {
         writerIndex_ = buffer_.size();
         append(extrabuf, n - writable);
+        g_bufferReadBytes.inc(n);
+        g_bufferSpills.inc();
     }
 
     return n;
@@ -4,6 +4,8 @@
 
 #include <errno.h>
 
+#include <random>
+
 #include "siren/base/Logger.h"
 #include "siren/net/Channel.h"
 #include "siren/net/EventLoop.h"
@@ -14,12 +16,27 @@ using namespace siren::net;
 
 const int Connector::kMaxRetryDelayMs;
 
+namespace {
+
+int randomBetween(int low, int high) {
+    thread_local std::mt19937 engine(std::random_device{}());
+    return std::uniform_int_distribution<int>(low, high)(engine);
+}
+
+}  // namespace
+
 Connector::Connector(EventLoop* loop, const InetAddress& serverAddr)
     : loop_(loop),
       serverAddr_(serverAddr),
       connect_(false),
       state_(kDisconnected),
-      retryDelayMs_(kInitRetryDelayMs) {
+      initRetryDelayMs_(kInitRetryDelayMs),
+      maxRetryDelayMs_(kMaxRetryDelayMs),
+      retryDelayMs_(kInitRetryDelayMs),
+      retryPending_(false),
+      failures_(0),
+      breakerFailures_(0),
+      breakerOpenMs_(0) {
         // LOG_DEBUG("ctor[{}]", this);
 }
 
@@ -28,6 +45,24 @@ Connector::~Connector() {
     assert(!channel_);
 }
 
+void Connector::setRetryDelay(int initMs, int maxMs) {
+    assert(initMs > 0 && initMs <= maxMs);
+    initRetryDelayMs_ = initMs;
+    maxRetryDelayMs_ = maxMs;
+    retryDelayMs_ = initMs;
+}
+
+void Connector::setCircuitBreaker(int failures, int openMs) {
+    assert(failures >= 0 && openMs >= 0);
+    breakerFailures_ = failures;
+    breakerOpenMs_ = openMs;
+}
+
+bool Connector::circuitOpen() const {
+    return breakerFailures_ > 0 && failures_ >= breakerFailures_ &&
+           std::chrono::steady_clock::now() < breakerOpenUntil_;
+}
+
 void Connector::start() {
     connect_ = true;
     loop_->runInLoop(
@@ -38,7 +73,11 @@ void Connector::startInLoop() {
     loop_->assertInLoopThread();
     assert(state_ == kDisconnected);
     if (connect_) {
-        connect();
+        if (circuitOpen()) {
+            failFast();
+        } else {
+            connect();
+        }
     } else {
         LOG_DEBUG("do not connect");
     }
@@ -61,7 +100,7 @@ void Connector::stopInLoop() {
 
 void Connector::connect() {
     int sockfd = sockets::createNonblockingOrDie(serverAddr_.family());
-    int ret = sockets::connect(sockfd, serverAddr_.getSockAddr());
+    int ret = sockets::connect(sockfd, serverAddr_.getSockAddr(), serverAddr_.length());
     int savedErrno = (ret == 0) ? 0 : errno;
     switch (savedErrno) {
         case 0:
@@ -101,7 +140,7 @@ void Connector::connect() {
 void Connector::restart() {
     loop_->assertInLoopThread();
     setState(kDisconnected);
-    retryDelayMs_ = kInitRetryDelayMs;
+    retryDelayMs_ = initRetryDelayMs_;
     connect_ = true;
     startInLoop();
 }
@@ -146,6 +185,7 @@ void Connector::handleWrite() {
             retry(sockfd);
         } else {
             setState(kConnected);
+            failures_ = 0;
             if (connect_) {
                 newConnectionCallback_(sockfd);
             } else {
@@ -172,13 +212,62 @@ void Connector::retry(int sockfd) {
     sockets::close(sockfd);
     setState(kDisconnected);
     if (connect_) {
-        LOG_INFO("Connector::retry - Retry connecting to {} in {} milliseconds",
-                 serverAddr_.toIpPort(), retryDelayMs_);
-
-        loop_->runAfter(retryDelayMs_ / 1000.0,
-                        std::bind(&Connector::startInLoop, shared_from_this()));
-        retryDelayMs_ = std::min(retryDelayMs_ * 2, kMaxRetryDelayMs);
+        // this attempt reached the kernel, report the breaker as it was
+        // before the failure, not the state the failure just moved it to
+        bool wasOpen = circuitOpen();
+        ++failures_;
+        int delayMs;
+        if (breakerFailures_ > 0 && failures_ >= breakerFailures_) {
+            delayMs = breakerOpenMs_;
+            breakerOpenUntil_ =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds(delayMs);
+            LOG_WARN("Connector::retry - circuit to {} open for {} milliseconds after {} failures",
+                     serverAddr_.toIpPort(), delayMs, failures_);
+        } else {
+            delayMs = nextRetryDelayMs();
+            LOG_INFO("Connector::retry - Retry connecting to {} in {} milliseconds",
+                     serverAddr_.toIpPort(), delayMs);
+        }
+        scheduleRetry(delayMs);
+        if (connectFailedCallback_) {
+            connectFailedCallback_(failures_, wasOpen);
+        }
     } else {
         LOG_DEBUG("do not connect");
     }
 }
+
+void Connector::failFast() {
+    LOG_DEBUG("Connector::failFast - circuit to {} is open", serverAddr_.toIpPort());
+    if (!retryPending_) {
+        // someone restarted us while open, probe once the circuit half-opens
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            breakerOpenUntil_ - std::chrono::steady_clock::now());
+        scheduleRetry(static_cast<int>(remaining.count()) + 1);
+    }
+    if (connectFailedCallback_) {
+        connectFailedCallback_(failures_, true);
+    }
+}
+
+void Connector::scheduleRetry(int delayMs) {
+    retryPending_ = true;
+    auto self = shared_from_this();
+    loop_->runAfter(delayMs / 1000.0, [self] {
+        self->retryPending_ = false;
+        self->startInLoop();
+    });
+}
+
+/**
+ * @brief decorrelated jitter: sleep = min(cap, random(base, sleep * 3))
+ *
+ * 与单纯翻倍相比，同一时刻断开的大量客户端在几轮之后就会被打散，
+ * 不会在后端重启时同步重连。
+ */
+int Connector::nextRetryDelayMs() {
+    int high = static_cast<int>(
+        std::min<int64_t>(static_cast<int64_t>(retryDelayMs_) * 3, maxRetryDelayMs_));
+    retryDelayMs_ = randomBetween(initRetryDelayMs_, std::max(initRetryDelayMs_, high));
+    return retryDelayMs_;
+}
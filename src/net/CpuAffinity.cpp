@@ -0,0 +1,118 @@
+#include "siren/net/CpuAffinity.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "siren/base/Logger.h"
+
+namespace {
+
+// "eth0" in "... eth0-TxRx-3" or "... eth0", not in "eth01" or "veth0"
+bool namesInterface(const std::string& rest, const std::string& ifname) {
+    if (ifname.empty()) return false;
+    for (size_t pos = rest.find(ifname); pos != std::string::npos;
+         pos = rest.find(ifname, pos + 1)) {
+        bool startOk = pos == 0 || isspace(static_cast<unsigned char>(rest[pos - 1]));
+        size_t end = pos + ifname.size();
+        bool endOk = end == rest.size() || rest[end] == '-' || rest[end] == ':' ||
+                     isspace(static_cast<unsigned char>(rest[end]));
+        if (startOk && endOk) return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+bool siren::net::affinity::pinCurrentThread(const std::vector<int>& cpus) {
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    int ret = ::pthread_setaffinity_np(::pthread_self(), sizeof set, &set);
+    if (ret != 0) {
+        LOG_ERROR("pthread_setaffinity_np failed, errno = {}", ret);
+        return false;
+    }
+    return true;
+}
+
+void siren::net::affinity::setCurrentThreadName(const std::string& name) {
+    // the kernel limit is 16 bytes including the terminating '\0'
+    std::string truncated = name.substr(0, 15);
+    ::pthread_setname_np(::pthread_self(), truncated.c_str());
+}
+
+int siren::net::affinity::numaNodeOfCpu(int cpu) {
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = ::opendir(path.c_str());
+    if (dir == nullptr) return -1;
+    int node = -1;
+    while (struct dirent* entry = ::readdir(dir)) {
+        // cpuN/nodeM is a symlink to the owning node
+        if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' &&
+            entry->d_name[4] <= '9') {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    ::closedir(dir);
+    return node;
+}
+
+std::vector<int> siren::net::affinity::nicQueueCpus(const std::string& ifname,
+                                                    const std::string& interruptsPath) {
+    std::vector<int> cpus;
+    std::ifstream in(interruptsPath);
+    std::string line;
+    if (!std::getline(in, line)) {
+        LOG_ERROR("can not read {}", interruptsPath);
+        return cpus;
+    }
+
+    // header: "           CPU0       CPU1 ...", offline CPUs are skipped
+    std::vector<int> columns;
+    {
+        std::istringstream header(line);
+        std::string token;
+        while (header >> token) {
+            if (token.compare(0, 3, "CPU") == 0) {
+                columns.push_back(atoi(token.c_str() + 3));
+            }
+        }
+    }
+
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string irq;
+        fields >> irq;
+        if (irq.empty() || irq.back() != ':') continue;
+
+        std::vector<unsigned long long> counts;
+        std::string token;
+        while (counts.size() < columns.size() && fields >> token) {
+            counts.push_back(strtoull(token.c_str(), nullptr, 10));
+        }
+        std::string rest;
+        std::getline(fields, rest);
+        if (counts.size() != columns.size() || !namesInterface(rest, ifname)) {
+            continue;
+        }
+
+        size_t best = std::max_element(counts.begin(), counts.end()) - counts.begin();
+        int cpu = columns[best];
+        if (std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
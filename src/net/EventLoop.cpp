@@ -8,11 +8,23 @@
 #include <sstream>
 #include <string>
 
+#include "siren/base/Metrics.h"
 #include "siren/net/SocketsOps.h"
 #include "fmt/std.h"
 
 using namespace siren::net;
 namespace {
+siren::metrics::Counter& g_loopIterations = siren::metrics::counter(
+    "siren_eventloop_iterations_total", "Number of EventLoop poll iterations");
+siren::metrics::Counter& g_loopFunctors = siren::metrics::counter(
+    "siren_eventloop_functors_total",
+    "Number of pending functors run by EventLoops");
+siren::metrics::Counter& g_loopWakeups = siren::metrics::counter(
+    "siren_eventloop_wakeups_total", "Number of eventfd wakeups written");
+siren::metrics::Histogram& g_loopActiveChannels = siren::metrics::histogram(
+    "siren_eventloop_active_channels", "Active channels returned per poll",
+    {0, 1, 2, 4, 8, 16, 32, 64, 128});
+
 int createEventfd() {
     int evtfd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
     if (evtfd < 0) {
@@ -41,7 +53,13 @@ siren::net::EventLoop::EventLoop()
       timerQueue_(new TimerQueue(this)),
       kPollTimeMs(1000 * 10),
       wakeupFd_(createEventfd()),
-      wakeupChannel_(new Channel(this, wakeupFd_)) {
+      wakeupChannel_(new Channel(this, wakeupFd_)),
+      numConnections_(0),
+      busyNanos_(0),
+      numaNode_(-1),
+      busyPollMicros_(0),
+      spinning_(false),
+      hasPendingFunctors_(false) {
     wakeupChannel_->setReadCallback(std::bind(&EventLoop::handleRead, this));
     // we are always reading the wakeupfd
     wakeupChannel_->enableReading();
@@ -70,7 +88,14 @@ void siren::net::EventLoop::loop() {
     assertInLoopThread();
     while (!quit_) {
         activeChannels_.clear();
-        pollReturnTime_ = poller_->poll(kPollTimeMs, &activeChannels_);
+        if (busyPollMicros_ > 0) {
+            pollReturnTime_ = spinPoll();
+        } else {
+            pollReturnTime_ = poller_->poll(kPollTimeMs, &activeChannels_);
+        }
+        auto busyStart = std::chrono::steady_clock::now();
+        g_loopIterations.inc();
+        g_loopActiveChannels.observe(static_cast<double>(activeChannels_.size()));
 
         // printactivatechannels
         eventHandling_ = true;
@@ -82,11 +107,46 @@ void siren::net::EventLoop::loop() {
         currentActiveChannel_ = nullptr;
         eventHandling_ = false;
         doPendingFunctors();  // 处理runInLoop()部分函数
+        busyNanos_.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - busyStart)
+                .count(),
+            std::memory_order_relaxed);
     }
 
     looping_ = false;
 }
 
+/**
+ * @brief busy-poll 模式下的 poll：先在预算内以 0 超时自旋，再阻塞
+ *
+ * spinning_ 与 hasPendingFunctors_ 都是 seq_cst，构成 Dekker 式的握手：
+ * queueInLoop() 先置 hasPendingFunctors_ 再读 spinning_，这里先清 spinning_
+ * 再读 hasPendingFunctors_，二者至少有一方能看到对方的写入，因此跳过
+ * wakeup() 的任务不会被遗漏到下一次阻塞之后。
+ */
+Timestamp siren::net::EventLoop::spinPoll() {
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(busyPollMicros_);
+    spinning_.store(true);
+    Timestamp now;
+    while (true) {
+        now = poller_->poll(0, &activeChannels_);
+        if (!activeChannels_.empty() || hasPendingFunctors_.load() || quit_) {
+            break;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            spinning_.store(false);
+            if (!hasPendingFunctors_.load() && !quit_) {
+                now = poller_->poll(kPollTimeMs, &activeChannels_);
+            }
+            break;
+        }
+    }
+    spinning_.store(false);
+    return now;
+}
+
 bool siren::net::EventLoop::hasChannel(Channel* channel) {
     assert(channel->ownerLoop() == this);
     assertInLoopThread();
@@ -111,6 +171,7 @@ void siren::net::EventLoop::removeChannel(Channel* channel) {
 void siren::net::EventLoop::wakeup() {
     uint64_t one = 1;
     ssize_t n = sockets::write(wakeupFd_, &one, sizeof one);
+    g_loopWakeups.inc();
     if (n != sizeof one) {
         LOG_ERROR("EventLoop::wakeup() writes {} bytes instead of 8", n);
     }
@@ -139,12 +200,14 @@ void siren::net::EventLoop::doPendingFunctors() {
     {
         std::unique_lock<std::mutex> lock(mutex_);
         functors.swap(pendingFunctors_);
+        hasPendingFunctors_.store(false, std::memory_order_relaxed);
     }
 
     for (const Functor& functor : functors) {
         if(functor)
             functor();
     }
+    g_loopFunctors.inc(static_cast<int64_t>(functors.size()));
     callingPendingFunctors_ = false;
 }
 
@@ -160,12 +223,16 @@ void siren::net::EventLoop::queueInLoop(Functor cb) {
         LOG_ERROR("queueinloop has empty function!");
     }
     {
-        std::unique_lock<std::mutex>(mutex_);
+        std::unique_lock<std::mutex> lock(mutex_);
         pendingFunctors_.push_back(std::move(cb));
+        hasPendingFunctors_.store(true);
     }
 
     if (!isInLoopThread() || callingPendingFunctors_) {
-        wakeup();
+        // a spinning loop checks hasPendingFunctors_ between its polls
+        if (!spinning_.load()) {
+            wakeup();
+        }
     }
 }
 
@@ -220,3 +287,7 @@ TimerId siren::net::EventLoop::runEvery(double interval, TimerCallback cb) {
         now + std::chrono::milliseconds(static_cast<int64_t>(interval * 1000));
     return timerQueue_->addTimer(std::move(cb), time, interval);
 }
+
+void siren::net::EventLoop::cancel(TimerId timerId) {
+    timerQueue_->cancel(timerId);
+}
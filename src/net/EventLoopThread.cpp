@@ -1,7 +1,9 @@
 #include "siren/net/EventLoopThread.h"
+#include "siren/net/CpuAffinity.h"
 #include "siren/net/EventLoop.h"
 #include <assert.h>
 
+#include <mutex>
 #include <utility>
 
 using namespace siren::net;
@@ -13,6 +15,18 @@ siren::net::EventLoopThread::EventLoopThread(ThreadInitCallback  cb)
     , callback_(std::move(cb))
 {
 }
+
+siren::net::EventLoopThread::EventLoopThread(ThreadInitCallback cb, std::string name,
+                                             std::vector<int> cpus)
+    : loop_(nullptr)
+    , exiting_(false)
+    , mutex_()
+    , callback_(std::move(cb))
+    , name_(std::move(name))
+    , cpus_(std::move(cpus))
+{
+}
+
 siren::net::EventLoopThread::~EventLoopThread()
 {
     exiting_ = true;
@@ -24,34 +38,47 @@ siren::net::EventLoopThread::~EventLoopThread()
 }
 
 EventLoop* siren::net::EventLoopThread::startLoop()
+{
+    start();
+    return waitForLoop();
+}
+
+void siren::net::EventLoopThread::start()
 {
     assert(!thread_.joinable() && "thread is running or can't join!");
     thread_ = std::thread([this] { threadFunc(); });
-    EventLoop* loop = nullptr;
+}
 
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        while (loop_ == nullptr) {
-            cond_.wait(lock);
-        }
-        loop = loop_;
-    }
-    return loop;
+EventLoop* siren::net::EventLoopThread::waitForLoop()
+{
+    assert(thread_.joinable());
+    started_.wait();
+    std::lock_guard<FutexMutex> lock(mutex_);
+    return loop_;
 }
 void siren::net::EventLoopThread::threadFunc()
 {
+    if (!name_.empty()) {
+        affinity::setCurrentThreadName(name_);
+    }
+    int numaNode = -1;
+    if (affinity::pinCurrentThread(cpus_)) {
+        numaNode = affinity::numaNodeOfCpu(cpus_.front());
+    }
+
     EventLoop loop;
+    loop.setNumaNode(numaNode);
     if (callback_) { // 先执行用户预设的回调函数
         callback_(&loop);
     }
 
     {
-        std::unique_lock<std::mutex> lock(mutex_); //创建EventLoop并执行loop()
+        std::lock_guard<FutexMutex> lock(mutex_); //创建EventLoop并执行loop()
         loop_ = &loop;
-        cond_.notify_one();
     }
+    started_.set();
 
     loop.loop();
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::lock_guard<FutexMutex> lock(mutex_);
     loop_ = nullptr;
 }
@@ -1,13 +1,50 @@
 #include "siren/net/EventLoopThreadPool.h"
 
+#include <algorithm>
+#include <chrono>
+#include <mutex>
 #include <utility>
+#include "siren/base/Logger.h"
+#include "siren/net/CpuAffinity.h"
 #include "siren/net/EventLoop.h"
 #include "siren/net/EventLoopThread.h"
 
 using namespace siren::net;
 
+namespace {
+// kLeastCpuTime 的采样窗口
+const int64_t kCpuSampleIntervalNanos = 100 * 1000 * 1000;
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
+
+/**
+ * @brief Jump Consistent Hash, John Lamping & Eric Veach
+ *
+ * @param key 任意 64 位 key
+ * @param numBuckets 桶数量
+ * @return [0, numBuckets) 中的桶编号
+ */
+int32_t jumpConsistentHash(uint64_t key, int32_t numBuckets) {
+    int64_t b = -1;
+    int64_t j = 0;
+    while (j < numBuckets) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = static_cast<int64_t>(static_cast<double>(b + 1) *
+                                 (static_cast<double>(1LL << 31) /
+                                  static_cast<double>((key >> 33) + 1)));
+    }
+    return static_cast<int32_t>(b);
+}
+}  // namespace
+
 siren::net::EventLoopThreadPool::EventLoopThreadPool(EventLoop *baseLoop, string nameArg)
-        : baseLoop_(baseLoop), name_(std::move(nameArg)), started_(false), numThreads_(0), next_(0) {
+        : baseLoop_(baseLoop), name_(std::move(nameArg)), started_(false), numThreads_(0), next_(0),
+          strategy_(kRoundRobin), lastSampleNanos_(0) {
 }
 
 siren::net::EventLoopThreadPool::~EventLoopThreadPool()
@@ -17,11 +54,40 @@ void siren::net::EventLoopThreadPool::start(const ThreadInitCallback &cb) {
     assert(!started_);
     baseLoop_->assertInLoopThread();
     started_ = true;
+    ThreadInitCallback init;
+    if (cb) {
+        init = [this, cb](EventLoop *loop) {
+            std::lock_guard<FutexMutex> lock(initMutex_);
+            cb(loop);
+        };
+    }
     for (int i = 0; i < numThreads_; i++) {
-        auto t = new EventLoopThread(cb);
+        string idx = std::to_string(i);
+        // pthread names are limited to 15 characters, keep the index
+        string threadName = name_.substr(0, 15 - std::min<size_t>(idx.size(), 15)) + idx;
+        std::vector<int> cpus;
+        if (!cpuSets_.empty()) {
+            cpus = cpuSets_[i % cpuSets_.size()];
+        }
+        auto t = new EventLoopThread(init, threadName, cpus);
         threads_.emplace_back(t);
-        loops_.push_back(t->startLoop());
+        t->start();
     }
+    // the threads build their loops in parallel, collect them in order
+    for (int i = 0; i < numThreads_; i++) {
+        loops_.push_back(threads_[i]->waitForLoop());
+        for (int cpu : threads_[i]->cpus()) {
+            if (cpu < 0) continue;
+            if (static_cast<size_t>(cpu) >= cpuToLoop_.size()) {
+                cpuToLoop_.resize(cpu + 1, nullptr);
+            }
+            // a CPU shared by several loops maps to the first one
+            if (cpuToLoop_[cpu] == nullptr) cpuToLoop_[cpu] = loops_.back();
+        }
+    }
+    lastBusyNanos_.assign(loops_.size(), 0);
+    recentBusyNanos_.assign(loops_.size(), 0);
+    assignedSinceSample_.assign(loops_.size(), 0);
     if (numThreads_ == 0 && cb) {
         cb(baseLoop_);
     }
@@ -45,11 +111,125 @@ EventLoop *EventLoopThreadPool::getLoopForHash(size_t hashCode) {
     EventLoop *loop = baseLoop_;
 
     if (!loops_.empty()) {
-        loop = loops_[hashCode % loops_.size()];
+        loop = loops_[jumpConsistentHash(hashCode, static_cast<int32_t>(loops_.size()))];
     }
     return loop;
 }
 
+EventLoop *EventLoopThreadPool::getLoop(size_t hashCode) {
+    baseLoop_->assertInLoopThread();
+    if (loops_.empty()) {
+        return baseLoop_;
+    }
+
+    switch (strategy_) {
+        case kLeastConnections:
+            return getLeastConnectionsLoop();
+        case kLeastCpuTime:
+            return getLeastCpuTimeLoop();
+        case kConsistentHash:
+            return getLoopForHash(hashCode);
+        case kCustom:
+            if (selector_) {
+                EventLoop *loop = selector_(loops_, hashCode);
+                if (loop != nullptr) return loop;
+            }
+            return getNextLoop();
+        case kRoundRobin:
+        default:
+            return getNextLoop();
+    }
+}
+
+EventLoop *EventLoopThreadPool::getLeastConnectionsLoop() {
+    // 从 next_ 开始扫描，连接数相同时退化为 round-robin
+    size_t n = loops_.size();
+    size_t best = next_;
+    int bestCount = loops_[best]->connectionCount();
+    for (size_t k = 1; k < n; ++k) {
+        size_t i = (next_ + k) % n;
+        int count = loops_[i]->connectionCount();
+        if (count < bestCount) {
+            best = i;
+            bestCount = count;
+        }
+    }
+    next_ = static_cast<int>((best + 1) % n);
+    return loops_[best];
+}
+
+void EventLoopThreadPool::sampleCpuTime() {
+    int64_t now = nowNanos();
+    if (now - lastSampleNanos_ < kCpuSampleIntervalNanos) {
+        return;
+    }
+    lastSampleNanos_ = now;
+    for (size_t i = 0; i < loops_.size(); ++i) {
+        int64_t busy = loops_[i]->busyNanos();
+        recentBusyNanos_[i] = busy - lastBusyNanos_[i];
+        lastBusyNanos_[i] = busy;
+        assignedSinceSample_[i] = 0;
+    }
+}
+
+EventLoop *EventLoopThreadPool::getLeastCpuTimeLoop() {
+    sampleCpuTime();
+
+    // 同一个采样窗口内的连接会被分配到同一个最空闲的 loop 上，
+    // 所以每分配一次就给该 loop 加上一个平均连接开销的估计值
+    size_t n = loops_.size();
+    int64_t totalBusy = 0;
+    int totalConns = 0;
+    for (size_t i = 0; i < n; ++i) {
+        totalBusy += recentBusyNanos_[i];
+        totalConns += loops_[i]->connectionCount();
+    }
+    int64_t perConn = totalConns > 0 ? totalBusy / totalConns : 0;
+    if (perConn <= 0) perConn = 1;
+
+    size_t best = next_;
+    int64_t bestScore = recentBusyNanos_[best] + assignedSinceSample_[best] * perConn;
+    for (size_t k = 1; k < n; ++k) {
+        size_t i = (next_ + k) % n;
+        int64_t score = recentBusyNanos_[i] + assignedSinceSample_[i] * perConn;
+        if (score < bestScore) {
+            best = i;
+            bestScore = score;
+        }
+    }
+    ++assignedSinceSample_[best];
+    next_ = static_cast<int>((best + 1) % n);
+    return loops_[best];
+}
+
+bool EventLoopThreadPool::setNicQueueCpus(const string &ifname) {
+    assert(!started_);
+    std::vector<int> cpus = affinity::nicQueueCpus(ifname);
+    if (cpus.empty()) {
+        LOG_WARN("EventLoopThreadPool [{}] no interrupt lines found for {}", name_, ifname);
+        return false;
+    }
+    cpuSets_.clear();
+    for (int cpu : cpus) {
+        cpuSets_.push_back({cpu});
+    }
+    LOG_INFO("EventLoopThreadPool [{}] pins loops to the {} queue CPUs of {}", name_,
+             cpus.size(), ifname);
+    return true;
+}
+
+const std::vector<int> &EventLoopThreadPool::cpusOfLoop(size_t index) const {
+    assert(index < threads_.size());
+    return threads_[index]->cpus();
+}
+
+EventLoop *EventLoopThreadPool::getLoopForCpu(int cpu) const {
+    if (cpu < 0 || static_cast<size_t>(cpu) >= cpuToLoop_.size()) {
+        return nullptr;
+    }
+    return cpuToLoop_[cpu];
+}
+
 std::vector<EventLoop *> EventLoopThreadPool::getAllLoops() {
     baseLoop_->assertInLoopThread();
     assert(started_);
@@ -5,8 +5,11 @@
 #include "siren/net/Endian.h"
 #include "siren/net/SocketsOps.h"
 
+#include <algorithm>
+
 #include <netdb.h>
 #include <netinet/in.h>
+#include <sys/socket.h>
 
 using namespace std;
 
@@ -40,8 +43,9 @@ static const in_addr_t kInaddrLoopback = INADDR_LOOPBACK;
 using namespace siren;
 using namespace siren::net;
 
-static_assert(sizeof(InetAddress) == sizeof(struct sockaddr_in6),
-    "InetAddress is same size as sockaddr_in6");
+static_assert(sizeof(InetAddress) >= sizeof(struct sockaddr_un)
+        && sizeof(InetAddress) < sizeof(struct sockaddr_un) + alignof(struct sockaddr_in6),
+    "InetAddress is sockaddr_un plus padding");
 static_assert(offsetof(sockaddr_in, sin_family) == 0, "sin_family offset 0");
 static_assert(offsetof(sockaddr_in6, sin6_family) == 0, "sin6_family offset 0");
 static_assert(offsetof(sockaddr_in, sin_port) == 2, "sin_port offset 2");
@@ -51,6 +55,7 @@ InetAddress::InetAddress(uint16_t portArg, bool loopbackOnly, bool ipv6)
 {
     static_assert(offsetof(InetAddress, addr6_) == 0, "addr6_ offset 0");
     static_assert(offsetof(InetAddress, addr_) == 0, "addr_ offset 0");
+    memset(&addrUnix_, 0, sizeof addrUnix_);
     if (ipv6) {
         memset(&addr6_, 0, sizeof addr6_);
         addr6_.sin6_family = AF_INET6;
@@ -68,6 +73,7 @@ InetAddress::InetAddress(uint16_t portArg, bool loopbackOnly, bool ipv6)
 
 InetAddress::InetAddress(string ip, uint16_t portArg, bool ipv6)
 {
+    memset(&addrUnix_, 0, sizeof addrUnix_);
     if (ipv6 || strchr(ip.c_str(), ':')) {
         memset(&addr6_, 0, sizeof addr6_);
         sockets::fromIpPort(ip.c_str(), portArg, &addr6_);
@@ -77,16 +83,74 @@ InetAddress::InetAddress(string ip, uint16_t portArg, bool ipv6)
     }
 }
 
+InetAddress InetAddress::unixDomain(const string& path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    // keep one byte for the terminator, abstract names never need it
+    size_t len = std::min(path.size(), sizeof addr.sun_path - 1);
+    if (len < path.size()) {
+        LOG_ERROR("InetAddress::unixDomain path too long: {}", path);
+    }
+    memcpy(addr.sun_path, path.data(), len);
+    if (len > 0 && path[0] == '@') {
+        addr.sun_path[0] = '\0';
+    }
+    return InetAddress(addr);
+}
+
+InetAddress InetAddress::localAddressOf(int sockfd)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    socklen_t addrlen = static_cast<socklen_t>(sizeof addr);
+    if (::getsockname(sockfd, reinterpret_cast<struct sockaddr*>(&addr), &addrlen) < 0) {
+        LOG_ERROR("InetAddress::localAddressOf");
+    }
+    return InetAddress(addr);
+}
+
+InetAddress InetAddress::peerAddressOf(int sockfd)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    socklen_t addrlen = static_cast<socklen_t>(sizeof addr);
+    if (::getpeername(sockfd, reinterpret_cast<struct sockaddr*>(&addr), &addrlen) < 0) {
+        LOG_ERROR("InetAddress::peerAddressOf");
+    }
+    return InetAddress(addr);
+}
+
+socklen_t InetAddress::length() const
+{
+    switch (family()) {
+        case AF_INET:
+            return static_cast<socklen_t>(sizeof addr_);
+        case AF_UNIX: {
+            const size_t base = offsetof(struct sockaddr_un, sun_path);
+            const char* path = addrUnix_.sun_path;
+            if (path[0] == '\0') {
+                // abstract, the name is exactly the bytes after the '\0'
+                return static_cast<socklen_t>(base + 1 + strnlen(path + 1, sizeof addrUnix_.sun_path - 1));
+            }
+            return static_cast<socklen_t>(base + strnlen(path, sizeof addrUnix_.sun_path) + 1);
+        }
+        default:
+            return static_cast<socklen_t>(sizeof addr6_);
+    }
+}
+
 string InetAddress::toIpPort() const
 {
-    char buf[64] = "";
+    char buf[128] = "";
     sockets::toIpPort(buf, sizeof buf, getSockAddr());
     return buf;
 }
 
 string InetAddress::toIp() const
 {
-    char buf[64] = "";
+    char buf[128] = "";
     sockets::toIp(buf, sizeof buf, getSockAddr());
     return buf;
 }
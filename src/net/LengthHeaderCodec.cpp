@@ -0,0 +1,109 @@
+#include "siren/net/LengthHeaderCodec.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "siren/base/Logger.h"
+#include "siren/net/Endian.h"
+#include "siren/net/TcpConnection.h"
+
+using namespace siren;
+using namespace siren::net;
+
+const size_t LengthHeaderCodec::kDefaultMaxFrameSize;
+
+siren::net::LengthHeaderCodec::LengthHeaderCodec(FrameCallback cb, size_t headerLen,
+                                                 size_t maxFrameSize)
+    : frameCallback_(std::move(cb)),
+      headerLen_(headerLen),
+      maxFrameSize_(headerLen == 2   ? std::min<size_t>(maxFrameSize, UINT16_MAX)
+                    : headerLen == 4 ? std::min<size_t>(maxFrameSize, UINT32_MAX)
+                                     : maxFrameSize) {
+    assert(headerLen_ == 2 || headerLen_ == 4 || headerLen_ == 8);
+    assert(headerLen_ <= Buffer::kCheapPrepend);
+}
+
+uint64_t siren::net::LengthHeaderCodec::peekLength(const char* data) const {
+    switch (headerLen_) {
+        case 2: {
+            uint16_t be16;
+            memcpy(&be16, data, sizeof be16);
+            return sockets::networkToHost16(be16);
+        }
+        case 4: {
+            uint32_t be32;
+            memcpy(&be32, data, sizeof be32);
+            return sockets::networkToHost32(be32);
+        }
+        default: {
+            uint64_t be64;
+            memcpy(&be64, data, sizeof be64);
+            return sockets::networkToHost64(be64);
+        }
+    }
+}
+
+void siren::net::LengthHeaderCodec::onMessage(const TcpConnectionPtr& conn, Buffer* buf,
+                                              Timestamp receiveTime) {
+    // consume every complete frame first and retrieve once, so that the
+    // buffer is compacted at most once per read
+    const char* data = buf->peek();
+    size_t readable = buf->readableBytes();
+    size_t consumed = 0;
+    while (readable - consumed >= headerLen_) {
+        uint64_t len = peekLength(data + consumed);
+        if (len > maxFrameSize_) {
+            buf->retrieve(static_cast<int>(consumed));
+            if (oversizeCallback_) {
+                oversizeCallback_(conn, len);
+            } else {
+                LOG_ERROR("LengthHeaderCodec - invalid length {} from {}", len,
+                          conn->peerAddress().toIpPort());
+                conn->forceClose();
+            }
+            return;
+        }
+        if (readable - consumed - headerLen_ < len) {
+            break;
+        }
+        frameCallback_(conn, std::string_view(data + consumed + headerLen_, len),
+                       receiveTime);
+        consumed += headerLen_ + len;
+    }
+    buf->retrieve(static_cast<int>(consumed));
+}
+
+void siren::net::LengthHeaderCodec::encode(Buffer* buf) const {
+    uint64_t len = buf->readableBytes();
+    assert(len <= maxFrameSize_);
+    switch (headerLen_) {
+        case 2: {
+            uint16_t be16 = sockets::hostToNetwork16(static_cast<uint16_t>(len));
+            buf->prepend(&be16, sizeof be16);
+            break;
+        }
+        case 4: {
+            uint32_t be32 = sockets::hostToNetwork32(static_cast<uint32_t>(len));
+            buf->prepend(&be32, sizeof be32);
+            break;
+        }
+        default: {
+            uint64_t be64 = sockets::hostToNetwork64(len);
+            buf->prepend(&be64, sizeof be64);
+            break;
+        }
+    }
+}
+
+void siren::net::LengthHeaderCodec::send(const TcpConnectionPtr& conn, Buffer* buf) const {
+    encode(buf);
+    conn->send(buf);
+}
+
+void siren::net::LengthHeaderCodec::send(const TcpConnectionPtr& conn,
+                                         std::string_view frame) const {
+    Buffer buf(frame.size());
+    buf.append(frame.data(), frame.size());
+    send(conn, &buf);
+}
@@ -0,0 +1,91 @@
+#include "siren/net/MetricsServer.h"
+
+#include <string_view>
+
+#include "siren/base/CountDownLatch.h"
+#include "siren/base/Logger.h"
+#include "siren/base/Metrics.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/TcpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+siren::net::MetricsServer::MetricsServer(const InetAddress& listenAddr,
+                                         string nameArg, string path)
+    : listenAddr_(listenAddr),
+      name_(std::move(nameArg)),
+      path_(std::move(path)),
+      loop_(nullptr) {}
+
+siren::net::MetricsServer::~MetricsServer() {
+    if (loop_ != nullptr) {
+        // TcpServer must be destroyed in its own loop
+        CountDownLatch latch(1);
+        loop_->runInLoop([this, &latch] {
+            server_.reset();
+            latch.countDown();
+        });
+        latch.wait();
+    }
+}
+
+void siren::net::MetricsServer::start() {
+    assert(loop_ == nullptr);
+    loop_ = loopThread_.startLoop();
+
+    CountDownLatch latch(1);
+    loop_->runInLoop([this, &latch] {
+        server_.reset(new TcpServer(loop_, listenAddr_, name_));
+        server_->setMessageCallback(
+            std::bind(&MetricsServer::onMessage, this, _1, _2, _3));
+        server_->start();
+        latch.countDown();
+    });
+    latch.wait();
+    LOG_INFO("MetricsServer [{}] serving {} on {}", name_, path_,
+             listenAddr_.toIpPort());
+}
+
+void siren::net::MetricsServer::onMessage(const TcpConnectionPtr& conn,
+                                          Buffer* buf, Timestamp) {
+    std::string_view data(buf->peek(), buf->readableBytes());
+    if (data.find("\r\n\r\n") == std::string_view::npos) {
+        return;  // wait for the whole request header
+    }
+
+    // "GET /metrics HTTP/1.1"
+    std::string_view target;
+    size_t sp1 = data.find(' ');
+    size_t sp2 = sp1 == std::string_view::npos ? sp1 : data.find(' ', sp1 + 1);
+    if (sp2 != std::string_view::npos) {
+        target = data.substr(sp1 + 1, sp2 - sp1 - 1);
+        size_t query = target.find('?');
+        if (query != std::string_view::npos) target = target.substr(0, query);
+    }
+    bool isGet = data.compare(0, 4, "GET ") == 0;
+    buf->retrieveAll();
+
+    string body;
+    string status;
+    string contentType;
+    if (isGet && target == path_) {
+        status = "200 OK";
+        contentType = "text/plain; version=0.0.4; charset=utf-8";
+        body = metrics::MetricsRegistry::instance().render();
+    } else {
+        status = "404 Not Found";
+        contentType = "text/plain";
+        body = "not found\n";
+    }
+
+    string response;
+    response.reserve(body.size() + 128);
+    response += "HTTP/1.1 " + status + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    conn->send(response);
+    conn->shutdown();
+}
@@ -0,0 +1,112 @@
+#include "siren/net/RelayPipe.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "siren/base/Logger.h"
+
+namespace {
+
+    // idle pipes kept per thread, more than this are closed on release
+    constexpr size_t kMaxPooled = 16;
+
+    struct PipePool {
+        std::vector<std::pair<int, int>> pipes;
+
+        ~PipePool() {
+            for (auto& p : pipes) {
+                ::close(p.first);
+                ::close(p.second);
+            }
+        }
+    };
+
+    thread_local PipePool t_pool;
+
+} // namespace
+
+siren::net::RelayPipe::RelayPipe(size_t capacity)
+    : readFd_(-1), writeFd_(-1), capacity_(0), size_(0) {
+    if (!t_pool.pipes.empty()) {
+        readFd_ = t_pool.pipes.back().first;
+        writeFd_ = t_pool.pipes.back().second;
+        t_pool.pipes.pop_back();
+    } else {
+        int fds[2];
+        if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+            LOG_ERROR("RelayPipe pipe2 failed, errno = {}", errno);
+            return;
+        }
+        readFd_ = fds[0];
+        writeFd_ = fds[1];
+    }
+
+    capacity = std::min(std::max<size_t>(capacity, 1), kMaxCapacity);
+    int actual = ::fcntl(writeFd_, F_GETPIPE_SZ);
+    if (actual >= 0 && static_cast<size_t>(actual) < capacity) {
+        // may be refused above fs.pipe-max-size, keep what we have then
+        int grown = ::fcntl(writeFd_, F_SETPIPE_SZ, static_cast<int>(capacity));
+        if (grown > 0) actual = grown;
+    }
+    capacity_ = actual > 0 ? std::min(static_cast<size_t>(actual), capacity) : capacity;
+}
+
+siren::net::RelayPipe::~RelayPipe() {
+    if (!valid()) return;
+    if (size_ == 0 && t_pool.pipes.size() < kMaxPooled) {
+        t_pool.pipes.emplace_back(readFd_, writeFd_);
+    } else {
+        ::close(readFd_);
+        ::close(writeFd_);
+    }
+}
+
+ssize_t siren::net::RelayPipe::fillFrom(int fd) {
+    size_t total = 0;
+    while (size_ < capacity_) {
+        ssize_t n = ::splice(fd, nullptr, writeFd_, nullptr, capacity_ - size_,
+                             SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            size_ += static_cast<size_t>(n);
+            total += static_cast<size_t>(n);
+        } else if (n == 0) {
+            // EOF, reported on the next call if this one moved anything
+            break;
+        } else {
+            // EAGAIN means either the socket is empty or the pipe ran out
+            // of slots, both end this round
+            if (total > 0) break;
+            return -1;
+        }
+    }
+    if (total == 0 && size_ >= capacity_) {
+        errno = EAGAIN;
+        return -1;
+    }
+    return static_cast<ssize_t>(total);
+}
+
+ssize_t siren::net::RelayPipe::drainTo(int fd) {
+    size_t total = 0;
+    while (size_ > 0) {
+        ssize_t n = ::splice(readFd_, nullptr, fd, nullptr, size_,
+                             SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            size_ -= static_cast<size_t>(n);
+            total += static_cast<size_t>(n);
+        } else {
+            if (total > 0 || n == 0) break;
+            return -1;
+        }
+    }
+    return static_cast<ssize_t>(total);
+}
+
+size_t siren::net::RelayPipe::pooled() {
+    return t_pool.pipes.size();
+}
@@ -0,0 +1,31 @@
+#include "siren/net/SharedPayload.h"
+
+#include <unordered_map>
+
+#include "siren/net/EventLoop.h"
+#include "siren/net/TcpConnection.h"
+
+using namespace siren;
+using namespace siren::net;
+
+void siren::net::runPerLoop(const std::vector<TcpConnectionPtr>& conns,
+                            const std::function<void(const std::vector<TcpConnectionPtr>&)>& task) {
+    std::unordered_map<EventLoop*, std::vector<TcpConnectionPtr>> byLoop;
+    for (const TcpConnectionPtr& conn : conns) {
+        byLoop[conn->getLoop()].push_back(conn);
+    }
+    for (auto& entry : byLoop) {
+        entry.first->runInLoop(
+            [task, targets = std::move(entry.second)]() { task(targets); });
+    }
+}
+
+void siren::net::broadcast(const std::vector<TcpConnectionPtr>& conns,
+                           const SharedPayload& payload) {
+    if (payload.empty()) return;
+    runPerLoop(conns, [payload](const std::vector<TcpConnectionPtr>& targets) {
+        for (const TcpConnectionPtr& conn : targets) {
+            conn->send(payload);
+        }
+    });
+}
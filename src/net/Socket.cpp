@@ -4,6 +4,7 @@
 #include "siren/net/InetAddress.h"
 #include "siren/net/SocketsOps.h"
 
+#include <errno.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <stdio.h>  // snprintf
@@ -51,7 +52,7 @@ bool Socket::getTcpInfoString(char* buf, int len) const
 
 void Socket::bindAddress(const InetAddress& addr) const
 {
-  sockets::bindOrDie(sockfd_, addr.getSockAddr());
+  sockets::bindOrDie(sockfd_, addr.getSockAddr(), addr.length());
 }
 
 void Socket::listen() const
@@ -118,3 +119,45 @@ void Socket::setKeepAlive(bool on)
 
 }
 
+// older libc headers lack the Linux 5.11 option
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
+void Socket::setBusyPoll(int usec, bool prefer)
+{
+#ifdef SO_BUSY_POLL
+  int optval = usec;
+  if (::setsockopt(sockfd_, SOL_SOCKET, SO_BUSY_POLL,
+                   &optval, static_cast<socklen_t>(sizeof optval)) < 0)
+  {
+    LOG_WARN("SO_BUSY_POLL failed, fd = {}, errno = {}", sockfd_, errno);
+  }
+  optval = prefer ? 1 : 0;
+  if (::setsockopt(sockfd_, SOL_SOCKET, SO_PREFER_BUSY_POLL,
+                   &optval, static_cast<socklen_t>(sizeof optval)) < 0 && prefer)
+  {
+    LOG_WARN("SO_PREFER_BUSY_POLL failed, fd = {}, errno = {}", sockfd_, errno);
+  }
+#else
+  LOG_WARN("SO_BUSY_POLL is not supported.");
+#endif
+}
+
+bool Socket::setZeroCopy(bool on)
+{
+#ifdef SO_ZEROCOPY
+  int optval = on ? 1 : 0;
+  if (::setsockopt(sockfd_, SOL_SOCKET, SO_ZEROCOPY,
+                   &optval, static_cast<socklen_t>(sizeof optval)) < 0)
+  {
+    LOG_WARN("SO_ZEROCOPY failed, fd = {}, errno = {}", sockfd_, errno);
+    return false;
+  }
+  return true;
+#else
+  LOG_WARN("SO_ZEROCOPY is not supported.");
+  return false;
+#endif
+}
+
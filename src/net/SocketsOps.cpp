@@ -8,9 +8,12 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
 #include <stdio.h> // snprintf
 #include <sys/socket.h>
-#include <sys/uio.h> // readv
+#include <sys/uio.h> // readv, writev
+#include <sys/un.h>
 #include <unistd.h>
 
 using namespace siren;
@@ -59,7 +62,8 @@ int sockets::createNonblockingOrDie(sa_family_t family)
 
     setNonBlockAndCloseOnExec(sockfd);
 #else
-    int sockfd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    int protocol = family == AF_UNIX ? 0 : IPPROTO_TCP;
+    int sockfd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
     if (sockfd < 0) {
         LOG_ERROR("sockets::createNonblockingOrDie");
     }
@@ -67,9 +71,18 @@ int sockets::createNonblockingOrDie(sa_family_t family)
     return sockfd;
 }
 
-void sockets::bindOrDie(int sockfd, const struct sockaddr* addr)
+int sockets::createUdpNonblockingOrDie(sa_family_t family)
 {
-    int ret = ::bind(sockfd, addr, static_cast<socklen_t>(sizeof(struct sockaddr_in6)));
+    int sockfd = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+    if (sockfd < 0) {
+        LOG_ERROR("sockets::createUdpNonblockingOrDie");
+    }
+    return sockfd;
+}
+
+void sockets::bindOrDie(int sockfd, const struct sockaddr* addr, socklen_t addrlen)
+{
+    int ret = ::bind(sockfd, addr, addrlen);
     if (ret < 0) {
         LOG_ERROR("sockets::bindOrDie");
     }
@@ -125,9 +138,9 @@ int sockets::accept(int sockfd, struct sockaddr_in6* addr)
     return connfd;
 }
 
-int sockets::connect(int sockfd, const struct sockaddr* addr)
+int sockets::connect(int sockfd, const struct sockaddr* addr, socklen_t addrlen)
 {
-    return ::connect(sockfd, addr, static_cast<socklen_t>(sizeof(struct sockaddr_in6)));
+    return ::connect(sockfd, addr, addrlen);
 }
 
 ssize_t sockets::read(int sockfd, void* buf, size_t count)
@@ -145,6 +158,89 @@ ssize_t sockets::write(int sockfd, const void* buf, size_t count)
     return ::write(sockfd, buf, count);
 }
 
+ssize_t sockets::writev(int sockfd, const struct iovec* iov, int iovcnt)
+{
+    return ::writev(sockfd, iov, iovcnt);
+}
+
+ssize_t sockets::sendFds(int sockfd, const int* fds, int nfds, const void* buf, size_t count)
+{
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(buf);
+    iov.iov_len = count;
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * static_cast<size_t>(nfds)));
+    struct msghdr msg;
+    memZero(&msg, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(int) * static_cast<size_t>(nfds));
+    memcpy(CMSG_DATA(cm), fds, sizeof(int) * static_cast<size_t>(nfds));
+    return ::sendmsg(sockfd, &msg, 0);
+}
+
+ssize_t sockets::readvFds(int sockfd, const struct iovec* iov, int iovcnt, std::vector<int>* fds)
+{
+    // SCM_MAX_FD is 253 per message
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * 253)];
+    struct msghdr msg;
+    memZero(&msg, sizeof msg);
+    msg.msg_iov = const_cast<struct iovec*>(iov);
+    msg.msg_iovlen = static_cast<size_t>(iovcnt);
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof control;
+    ssize_t n = ::recvmsg(sockfd, &msg, MSG_CMSG_CLOEXEC);
+    if (n < 0) return n;
+    if (msg.msg_flags & MSG_CTRUNC) {
+        LOG_ERROR("sockets::readvFds descriptors truncated, fd = {}", sockfd);
+    }
+    for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+        size_t count = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const unsigned char* data = CMSG_DATA(cm);
+        for (size_t i = 0; i < count; ++i) {
+            int fd;
+            memcpy(&fd, data + i * sizeof(int), sizeof fd);
+            fds->push_back(fd);
+        }
+    }
+    return n;
+}
+
+ssize_t sockets::sendZeroCopy(int sockfd, const void* buf, size_t count)
+{
+    return ::send(sockfd, buf, count, MSG_ZEROCOPY);
+}
+
+bool sockets::readZeroCopyCompletion(int sockfd, uint32_t* lo, uint32_t* hi, bool* copied)
+{
+    for (;;) {
+        char control[128];
+        struct msghdr msg;
+        memZero(&msg, sizeof msg);
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+        if (::recvmsg(sockfd, &msg, MSG_ERRQUEUE) < 0) {
+            return false;
+        }
+        for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+            bool recverr = (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                           (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+            if (!recverr) continue;
+            const auto* err = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(cm));
+            if (err->ee_origin != SO_EE_ORIGIN_ZEROCOPY || err->ee_errno != 0) continue;
+            *lo = err->ee_info;
+            *hi = err->ee_data;
+            *copied = (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+            return true;
+        }
+    }
+}
+
 void sockets::close(int sockfd)
 {
     if (::close(sockfd) < 0) {
@@ -162,6 +258,11 @@ void sockets::shutdownWrite(int sockfd)
 void sockets::toIpPort(char* buf, size_t size,
     const struct sockaddr* addr)
 {
+    if (addr->sa_family == AF_UNIX) {
+        int n = snprintf(buf, size, "unix:");
+        toIp(buf + n, size - static_cast<size_t>(n), addr);
+        return;
+    }
     if (addr->sa_family == AF_INET6) {
         buf[0] = '[';
         toIp(buf + 1, size - 1, addr);
@@ -191,6 +292,14 @@ void sockets::toIp(char* buf, size_t size,
         assert(size >= INET6_ADDRSTRLEN);
         const struct sockaddr_in6* addr6 = sockaddr_in6_cast(addr);
         ::inet_ntop(AF_INET6, &addr6->sin6_addr, buf, static_cast<socklen_t>(size));
+    } else if (addr->sa_family == AF_UNIX) {
+        // "@name" for the abstract namespace, like ss(8) prints it
+        const struct sockaddr_un* un = reinterpret_cast<const struct sockaddr_un*>(addr);
+        if (un->sun_path[0] == '\0' && un->sun_path[1] != '\0') {
+            snprintf(buf, size, "@%.*s", static_cast<int>(sizeof un->sun_path - 1), un->sun_path + 1);
+        } else {
+            snprintf(buf, size, "%.*s", static_cast<int>(sizeof un->sun_path), un->sun_path);
+        }
     }
 }
 
@@ -226,6 +335,20 @@ int sockets::getSocketError(int sockfd)
     }
 }
 
+int sockets::getIncomingCpu(int sockfd)
+{
+#ifdef SO_INCOMING_CPU
+    int cpu = -1;
+    socklen_t optlen = static_cast<socklen_t>(sizeof cpu);
+    if (::getsockopt(sockfd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &optlen) < 0) {
+        return -1;
+    }
+    return cpu;
+#else
+    return -1;
+#endif
+}
+
 struct sockaddr_in6 sockets::getLocalAddr(int sockfd)
 {
     struct sockaddr_in6 localaddr;
@@ -65,6 +65,18 @@ siren::net::TcpClient::~TcpClient() {
     }
 }
 
+void siren::net::TcpClient::setRetryDelay(int initMs, int maxMs) {
+    connector_->setRetryDelay(initMs, maxMs);
+}
+
+void siren::net::TcpClient::setCircuitBreaker(int failures, int openMs) {
+    connector_->setCircuitBreaker(failures, openMs);
+}
+
+void siren::net::TcpClient::setConnectFailedCallback(ConnectFailedCallback cb) {
+    connector_->setConnectFailedCallback(std::move(cb));
+}
+
 void siren::net::TcpClient::connect() {
     LOG_INFO("TcpClient::connect[{}] - connecting to {}", name_,
              connector_->serverAddress().toIpPort());
@@ -90,14 +102,14 @@ void siren::net::TcpClient::stop() {
 
 void siren::net::TcpClient::newConnection(int sockfd) {
     loop_->assertInLoopThread();
-    InetAddress peerAddr(sockets::getPeerAddr(sockfd));
+    InetAddress peerAddr = InetAddress::peerAddressOf(sockfd);
     char buf[32];
     snprintf(buf, sizeof buf, ":%s#%d", peerAddr.toIpPort().c_str(),
              nextConnId_);
     ++nextConnId_;
     string connName = name_ + buf;
 
-    InetAddress localAddr(sockets::getLocalAddr(sockfd));
+    InetAddress localAddr = InetAddress::localAddressOf(sockfd);
 
     TcpConnectionPtr conn(
             new TcpConnection(loop_, connName, sockfd, localAddr, peerAddr));
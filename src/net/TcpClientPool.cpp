@@ -0,0 +1,150 @@
+#include "siren/net/TcpClientPool.h"
+
+#include <limits>
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+
+using namespace siren;
+using namespace siren::net;
+
+siren::net::TcpClientPool::Lease::Lease(std::weak_ptr<Slot> slot, TcpConnectionPtr conn)
+    : slot_(std::move(slot)), conn_(std::move(conn)) {}
+
+siren::net::TcpClientPool::Lease::Lease(Lease&& rhs) noexcept
+    : slot_(std::move(rhs.slot_)), conn_(std::move(rhs.conn_)) {}
+
+TcpClientPool::Lease& siren::net::TcpClientPool::Lease::operator=(Lease&& rhs) noexcept {
+    if (this != &rhs) {
+        release();
+        slot_ = std::move(rhs.slot_);
+        conn_ = std::move(rhs.conn_);
+    }
+    return *this;
+}
+
+void siren::net::TcpClientPool::Lease::release() {
+    if (auto slot = slot_.lock()) {
+        slot->leases.fetch_sub(1, std::memory_order_relaxed);
+    }
+    slot_.reset();
+    conn_.reset();
+}
+
+siren::net::TcpClientPool::TcpClientPool(EventLoopThreadPool* loops,
+                                         const InetAddress& serverAddr,
+                                         const string& nameArg, int numConnections)
+    : name_(nameArg),
+      connectionCallback_(defaultConnectionCallback),
+      messageCallback_(defaultMessageCallback),
+      next_(0),
+      stopped_(false) {
+    init(loops->getAllLoops(), serverAddr, numConnections);
+}
+
+siren::net::TcpClientPool::TcpClientPool(const std::vector<EventLoop*>& loops,
+                                         const InetAddress& serverAddr,
+                                         const string& nameArg, int numConnections)
+    : name_(nameArg),
+      connectionCallback_(defaultConnectionCallback),
+      messageCallback_(defaultMessageCallback),
+      next_(0),
+      stopped_(false) {
+    init(loops, serverAddr, numConnections);
+}
+
+void siren::net::TcpClientPool::init(const std::vector<EventLoop*>& allLoops,
+                                     const InetAddress& serverAddr, int numConnections) {
+    assert(numConnections > 0 && !allLoops.empty());
+    for (int i = 0; i < numConnections; ++i) {
+        auto slot = std::make_shared<Slot>();
+        char buf[32];
+        snprintf(buf, sizeof buf, "#%d", i);
+        slot->client.reset(new TcpClient(allLoops[i % allLoops.size()], serverAddr, name_ + buf));
+        slot->client->enableRetry();
+        slots_.push_back(std::move(slot));
+    }
+}
+
+siren::net::TcpClientPool::~TcpClientPool() {
+    LOG_INFO("TcpClientPool::~TcpClientPool[{}]", name_);
+    stop();
+    for (auto& slot : slots_) {
+        // TcpClient must die in its own loop, outstanding Leases only hold
+        // the TcpConnection. ~TcpClient only force-closes a connection
+        // nobody else holds, so hold it across and close it here; the
+        // pending close keeps it alive until connectDestroyed().
+        EventLoop* loop = slot->client->getLoop();
+        loop->runInLoop([client = std::move(slot->client)]() mutable {
+            TcpConnectionPtr conn = client->connection();
+            client.reset();
+            if (conn) conn->forceClose();
+        });
+    }
+}
+
+void siren::net::TcpClientPool::start() {
+    for (auto& slot : slots_) {
+        // callbacks may run after the pool is gone, only keep a weak reference
+        std::weak_ptr<Slot> weakSlot = slot;
+        ConnectionCallback userCallback = connectionCallback_;
+        slot->client->setConnectionCallback(
+            [weakSlot, userCallback](const TcpConnectionPtr& conn) {
+                if (auto s = weakSlot.lock()) {
+                    s->connected.store(conn->connected());
+                }
+                userCallback(conn);
+            });
+        slot->client->setMessageCallback(messageCallback_);
+        slot->client->connect();
+    }
+}
+
+void siren::net::TcpClientPool::stop() {
+    if (stopped_) return;
+    stopped_ = true;
+    for (auto& slot : slots_) {
+        slot->client->stop();
+        slot->client->disconnect();
+    }
+}
+
+TcpClientPool::Lease siren::net::TcpClientPool::acquire() {
+    const size_t n = slots_.size();
+    // start from a rotating index so that equally loaded slots are used in turn
+    size_t start = next_.fetch_add(1, std::memory_order_relaxed) % n;
+    int bestLeases = std::numeric_limits<int>::max();
+    Slot* best = nullptr;
+    size_t bestIndex = 0;
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = (start + k) % n;
+        Slot* slot = slots_[i].get();
+        if (!slot->connected.load(std::memory_order_relaxed)) continue;
+        int leases = slot->leases.load(std::memory_order_relaxed);
+        if (leases < bestLeases) {
+            best = slot;
+            bestIndex = i;
+            bestLeases = leases;
+            if (leases == 0) break;
+        }
+    }
+    if (best == nullptr) {
+        return Lease();
+    }
+
+    TcpConnectionPtr conn = best->client->connection();
+    if (!conn || !conn->connected()) {
+        return Lease();
+    }
+    best->leases.fetch_add(1, std::memory_order_relaxed);
+    return Lease(slots_[bestIndex], std::move(conn));
+}
+
+int siren::net::TcpClientPool::connectedCount() const {
+    int count = 0;
+    for (const auto& slot : slots_) {
+        if (slot->connected.load(std::memory_order_relaxed)) ++count;
+    }
+    return count;
+}
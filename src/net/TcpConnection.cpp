@@ -1,13 +1,71 @@
 #include "siren/net/TcpConnection.h"
 
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+
 #include "siren/net/Buffer.h"
 #include "siren/net/Channel.h"
 #include "siren/net/EventLoop.h"
+#include "siren/net/RelayPipe.h"
 #include "siren/net/Socket.h"
 #include "siren/net/SocketsOps.h"
 
 using namespace siren::net;
 
+namespace {
+
+// empties the entries of ids lo..hi, then pops the completed front
+void releaseZeroCopy(std::deque<SharedPayload>* inflight, uint32_t* first, uint32_t lo,
+                     uint32_t hi) {
+    for (uint32_t id = lo; id - lo <= hi - lo; ++id) {
+        uint32_t index = id - *first;
+        if (index < inflight->size()) {
+            (*inflight)[index] = SharedPayload();
+        }
+    }
+    while (!inflight->empty() && inflight->front().empty()) {
+        inflight->pop_front();
+        ++*first;
+    }
+}
+
+// MSG_ZEROCOPY sends a torn-down connection left behind. The kernel may
+// still read their pages, so the references and the socket whose error
+// queue reports them stay alive, owned by the loop's timers, until then.
+struct ZeroCopyDrain {
+    std::unique_ptr<Socket> socket;
+    std::deque<SharedPayload> inflight;
+    uint32_t first;
+    int delayMs;
+};
+
+const int kZeroCopyDrainMinDelayMs = 10;
+const int kZeroCopyDrainMaxDelayMs = 1000;
+
+void pollZeroCopyDrain(EventLoop* loop, std::unique_ptr<ZeroCopyDrain> drain) {
+    uint32_t lo, hi;
+    bool copied;
+    while (sockets::readZeroCopyCompletion(drain->socket->fd(), &lo, &hi, &copied)) {
+        releaseZeroCopy(&drain->inflight, &drain->first, lo, hi);
+    }
+    if (drain->inflight.empty()) {
+        LOG_DEBUG("TcpConnection zero-copy drained, fd = {}", drain->socket->fd());
+        return;  // ~Socket closes the fd
+    }
+    // the error queue of a socket without events never wakes epoll, poll it
+    int delayMs = drain->delayMs;
+    drain->delayMs = std::min(delayMs * 2, kZeroCopyDrainMaxDelayMs);
+    loop->runAfter(delayMs / 1000.0, [loop, drain = std::move(drain)]() mutable {
+        pollZeroCopyDrain(loop, std::move(drain));
+    });
+}
+
+}  // namespace
+
 void siren::net::defaultConnectionCallback(const TcpConnectionPtr& conn) {
     LOG_TRACE("{} -> {} is {}", conn->localAddress().toIpPort(),
               conn->peerAddress().toIpPort(),
@@ -33,7 +91,15 @@ siren::net::TcpConnection::TcpConnection(EventLoop* loop, const string& name,
       channel_(new Channel(loop, sockfd)),
       localAddr_(localAddr),
       peerAddr_(peerAddr),
-      highWaterMark_(64 * 1024 * 1024) {
+      highWaterMark_(64 * 1024 * 1024),
+      queuedBufferBytes_(0),
+      payloadBytes_(0),
+      relayEof_(false),
+      relayShutdown_(false),
+      relayedBytes_(0),
+      zeroCopyThreshold_(0),
+      zeroCopyFirst_(0),
+      zeroCopyCopied_(0) {
     channel_->setReadCallback(std::bind(&TcpConnection::handleRead, this, _1));
     channel_->setWriteCallback(std::bind(&TcpConnection::handleWrite, this));
     channel_->setCloseCallback(std::bind(&TcpConnection::handleClose, this));
@@ -44,6 +110,10 @@ siren::net::TcpConnection::TcpConnection(EventLoop* loop, const string& name,
 }
 
 siren::net::TcpConnection::~TcpConnection() {
+    for (const PendingFds& pending : fdQueue_) {
+        for (int fd : pending.fds) ::close(fd);
+    }
+    for (int fd : receivedFds_) ::close(fd);
     LOG_DEBUG("TcpConnection::dtor[{}], fd = {}, state = {}", this->name_,
               this->channel_->fd(), this->stateToString());
 }
@@ -59,16 +129,24 @@ std::string siren::net::TcpConnection::getTcpInfoString() const {
     return buf;
 }
 
+size_t siren::net::TcpConnection::unsentBytes() const {
+    size_t n = pendingBytes();
+    for (const PendingFds& pending : fdQueue_) n += pending.data.size();
+    return n;
+}
+
 void siren::net::TcpConnection::send(const void* message, int len) {
     if (len <= 0) return;
     if (state_ == kConnected) {
         if (loop_->isInLoopThread())
             sendInLoop(message, len);
         else {
-            auto fp = static_cast<void (TcpConnection::*)(const void*, size_t)>(
+            // the caller's bytes may be gone by the time the loop runs
+            auto fp = static_cast<void (TcpConnection::*)(const std::string&)>(
                 &TcpConnection::sendInLoop);
 
-            loop_->runInLoop(std::bind(fp, this, message, len));
+            loop_->runInLoop(std::bind(
+                fp, this, std::string(static_cast<const char*>(message), len)));
         }
     }
 }
@@ -93,6 +171,122 @@ void siren::net::TcpConnection::send(Buffer* buf) {
     }
 }
 
+void siren::net::TcpConnection::send(const SharedPayload& payload) {
+    if (state_ == kConnected && !payload.empty()) {
+        if (loop_->isInLoopThread()) {
+            sendPayloadInLoop(payload);
+        } else {
+            // only the reference crosses threads
+            loop_->runInLoop([self = shared_from_this(), payload]() {
+                self->sendPayloadInLoop(payload);
+            });
+        }
+    }
+}
+
+void siren::net::TcpConnection::sendv(const struct iovec* iov, int iovcnt) {
+    loop_->assertInLoopThread();
+    if (iovcnt <= 0) return;
+    if (state_ == kDisconnected) {
+        LOG_WARN("disconnected, give up writing");
+        return;
+    }
+    if (!fdQueue_.empty()) {
+        for (int i = 0; i < iovcnt; ++i) {
+            fdQueue_.back().data.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+        }
+        return;
+    }
+
+    int first = 0;        // first iovec not fully written
+    size_t offset = 0;    // bytes of iov[first] already written
+    bool faultError = false;
+    if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
+        while (first < iovcnt) {
+            int count = std::min(iovcnt - first, IOV_MAX);
+            size_t expected = 0;
+            for (int i = first; i < first + count; ++i) expected += iov[i].iov_len;
+            ssize_t n = sockets::writev(channel_->fd(), iov + first, count);
+            if (n < 0) {
+                if (errno != EWOULDBLOCK) {
+                    LOG_ERROR("TcpConnection::sendv");
+                    faultError = errno == EPIPE || errno == ECONNRESET;
+                }
+                break;
+            }
+            size_t written = static_cast<size_t>(n);
+            if (written < expected) {
+                // short write, the socket buffer is full
+                while (written >= iov[first].iov_len) written -= iov[first++].iov_len;
+                offset = written;
+                break;
+            }
+            first += count;
+        }
+        if (first == iovcnt && writeCompleteCallback_) {
+            loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+        }
+    }
+    if (faultError || first == iovcnt) return;
+
+    size_t remaining = iov[first].iov_len - offset;
+    for (int i = first + 1; i < iovcnt; ++i) remaining += iov[i].iov_len;
+    size_t oldLen = pendingBytes();
+    if (oldLen + remaining >= highWaterMark_ && oldLen < highWaterMark_ &&
+        highWaterMarkCallback_) {
+        loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(),
+                                     oldLen + remaining));
+    }
+    outputBuffer_.ensureWritableBytes(remaining);
+    outputBuffer_.append(static_cast<const char*>(iov[first].iov_base) + offset,
+                         iov[first].iov_len - offset);
+    for (int i = first + 1; i < iovcnt; ++i) {
+        outputBuffer_.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+    }
+    if (!channel_->isWriting()) {
+        channel_->enableWriting();
+    }
+}
+
+void siren::net::TcpConnection::sendFds(const std::vector<int>& fds, const std::string& message) {
+    if (state_ != kConnected) return;
+    if (message.empty()) {
+        // a stream socket drops ancillary data sent without a byte
+        LOG_ERROR("TcpConnection::sendFds [{}] needs a non-empty message", name_);
+        return;
+    }
+    if (fds.empty()) {
+        send(message);
+        return;
+    }
+    // the queue owns duplicates, the caller's fds may be closed right away
+    std::vector<int> dups;
+    dups.reserve(fds.size());
+    for (int fd : fds) {
+        int dup = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (dup < 0) {
+            LOG_ERROR("TcpConnection::sendFds [{}] dup fd = {}", name_, fd);
+            for (int d : dups) ::close(d);
+            return;
+        }
+        dups.push_back(dup);
+    }
+    if (loop_->isInLoopThread()) {
+        sendFdsInLoop(dups, message);
+    } else {
+        loop_->runInLoop([self = shared_from_this(), dups, message]() mutable {
+            self->sendFdsInLoop(dups, message);
+        });
+    }
+}
+
+std::vector<int> siren::net::TcpConnection::takeReceivedFds() {
+    loop_->assertInLoopThread();
+    std::vector<int> fds;
+    fds.swap(receivedFds_);
+    return fds;
+}
+
 void siren::net::TcpConnection::shutdown() {
     if (state_ == kConnected) {
         setState(kDisconnecting);
@@ -125,6 +319,18 @@ void siren::net::TcpConnection::setTcpNoDelay(bool on) {
     socket_->setTcpNoDelay(on);
 }
 
+void siren::net::TcpConnection::setBusyPoll(int usec, bool prefer) {
+    socket_->setBusyPoll(usec, prefer);
+}
+
+bool siren::net::TcpConnection::enableZeroCopy(size_t threshold) {
+    loop_->assertInLoopThread();
+    if (threshold == 0 || !socket_->setZeroCopy(true)) return false;
+    zeroCopyThreshold_ = threshold;
+    zeroCopyCopied_ = 0;
+    return true;
+}
+
 void siren::net::TcpConnection::startRead() {
     loop_->runInLoop(std::bind(&TcpConnection::startReadInLoop, this));
 }
@@ -133,10 +339,42 @@ void siren::net::TcpConnection::stopRead() {
     loop_->runInLoop(std::bind(&TcpConnection::stopReadInLoop, this));
 }
 
+bool siren::net::TcpConnection::relay(const TcpConnectionPtr& a, const TcpConnectionPtr& b) {
+    assert(a->loop_ == b->loop_);
+    a->loop_->assertInLoopThread();
+    if (!a->connected() || !b->connected() || a->relayPipe_ || b->relayPipe_) {
+        return false;
+    }
+    a->relayPipe_.reset(new RelayPipe(b->highWaterMark_));
+    b->relayPipe_.reset(new RelayPipe(a->highWaterMark_));
+    if (!a->relayPipe_->valid() || !b->relayPipe_->valid()) {
+        a->relayPipe_.reset();
+        b->relayPipe_.reset();
+        return false;
+    }
+    a->relayPeer_ = b;
+    b->relayPeer_ = a;
+    // what the protocol on top read before handing over goes first
+    b->send(&a->inputBuffer_);
+    a->send(&b->inputBuffer_);
+    return true;
+}
+
 void siren::net::TcpConnection::connectEstablished() {
     loop_->assertInLoopThread();
     assert(state_ == kConnecting);
     setState(kConnected);
+    // counted here and in connectDestroyed(), both in the loop while it is
+    // alive; the last TcpConnectionPtr may go anywhere, any time
+    loop_->addConnectionCount(1);
+    if (loop_->numaNode() >= 0) {
+        // The connection was built in the acceptor thread. Reallocate the
+        // still empty buffers here so the first touch happens on the IO
+        // thread's NUMA node.
+        assert(inputBuffer_.readableBytes() == 0 && outputBuffer_.readableBytes() == 0);
+        Buffer().swap(inputBuffer_);
+        Buffer().swap(outputBuffer_);
+    }
     channel_->tie(shared_from_this());
     channel_->enableReading();
 
@@ -152,12 +390,41 @@ void siren::net::TcpConnection::connectDestroyed() {
         connectionCallback_(shared_from_this());
     }
     channel_->remove();
+    loop_->addConnectionCount(-1);
+    if (!zeroCopyInflight_.empty()) {
+        startZeroCopyDrain();
+    }
+}
+
+void siren::net::TcpConnection::startZeroCopyDrain() {
+    loop_->assertInLoopThread();
+    // nothing is sent once disconnected, the in-flight set is final. A dup
+    // keeps the socket and its error queue open after ~TcpConnection
+    // closes our fd, whenever and wherever that happens.
+    int fd = ::fcntl(socket_->fd(), F_DUPFD_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("TcpConnection::startZeroCopyDrain [{}] - dup failed, errno = {}", name_,
+                  errno);
+        return;
+    }
+    // the peer sees the close now, the fd is closed once drained
+    socket_->shutdownWrite();
+    std::unique_ptr<ZeroCopyDrain> drain(new ZeroCopyDrain{
+        std::unique_ptr<Socket>(new Socket(fd)), std::move(zeroCopyInflight_), zeroCopyFirst_,
+        kZeroCopyDrainMinDelayMs});
+    zeroCopyInflight_.clear();
+    pollZeroCopyDrain(loop_, std::move(drain));
 }
 
 void siren::net::TcpConnection::handleRead(Timestamp receiveTime) {
     loop_->assertInLoopThread();
-    int saveErrno = 0;
-    ssize_t n = inputBuffer_.readFd(channel_->fd());
+    if (relayPipe_) {
+        relayRead();
+        return;
+    }
+    ssize_t n = localAddr_.family() == AF_UNIX
+                    ? inputBuffer_.readFd(channel_->fd(), &receivedFds_)
+                    : inputBuffer_.readFd(channel_->fd());
 
     if (n > 0) {
         messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
@@ -170,26 +437,40 @@ void siren::net::TcpConnection::handleRead(Timestamp receiveTime) {
 
 void siren::net::TcpConnection::handleWrite() {
     loop_->assertInLoopThread();
-    if (channel_->isWriting()) {
+    if (!channel_->isWriting()) return;
+    if (!payloadQueue_.empty()) {
+        writeQueued();
+    } else if (outputBuffer_.readableBytes() > 0) {
         ssize_t n = sockets::write(channel_->fd(), outputBuffer_.peek(),
                                    outputBuffer_.readableBytes());
         if (n > 0) {                    // 写了点数据
             outputBuffer_.retrieve(n);  // 将readerIndex 向后移动n
-            if (outputBuffer_.readableBytes() ==
-                0) {  // 本次把所有的数据都写进socket了
-                channel_->disableWriting();
-                if (writeCompleteCallback_) {
-                    loop_->queueInLoop(
-                        std::bind(writeCompleteCallback_, shared_from_this()));
-                }
-                if (state_ == kDisconnecting) {
-                    shutdownInLoop();
-                }
-            }
         } else {
             LOG_ERROR("TcpConnection::handleWrite");
         }
     }
+    if (pendingBytes() > 0) return;
+    if (!fdQueue_.empty()) {
+        writeFdQueue();
+        if (pendingBytes() > 0 || !fdQueue_.empty()) return;
+    }
+
+    if (relayPipe_) {
+        // our own output is out, the peer's pipe drains into us next
+        TcpConnectionPtr peer = relayPeer_.lock();
+        if (peer && peer->relayPipe_) {
+            peer->relayFlush(shared_from_this());
+            if (peer->relayPipe_ && peer->relayPipe_->size() > 0) return;
+        }
+    }
+    // 本次把所有的数据都写进socket了
+    channel_->disableWriting();
+    if (writeCompleteCallback_) {
+        loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+    }
+    if (state_ == kDisconnecting) {
+        shutdownInLoop();
+    }
 }
 
 void siren::net::TcpConnection::handleClose() {
@@ -198,6 +479,11 @@ void siren::net::TcpConnection::handleClose() {
     assert(state_ == kDisconnecting || state_ == kConnected);
     setState(kDisconnected);
     channel_->disableAll();
+    if (relayPipe_) {
+        // bytes still in the pipe have nowhere to go
+        relayPipe_.reset();
+        if (TcpConnectionPtr peer = relayPeer_.lock()) peer->forceClose();
+    }
 
     TcpConnectionPtr guardThis(shared_from_this());
     connectionCallback_(guardThis);
@@ -206,10 +492,17 @@ void siren::net::TcpConnection::handleClose() {
 }
 
 /**
- * @brief handle of error
- * @todo FIXME
+ * @brief handle of error, MSG_ZEROCOPY completions arrive as EPOLLERR too
  */
-void siren::net::TcpConnection::handleError() {}
+void siren::net::TcpConnection::handleError() {
+    if (!zeroCopyInflight_.empty()) {
+        readZeroCopyCompletions();
+    }
+    int err = sockets::getSocketError(channel_->fd());
+    if (err != 0) {
+        LOG_ERROR("TcpConnection::handleError [{}] - SO_ERROR = {}", name_, err);
+    }
+}
 
 void siren::net::TcpConnection::sendInLoop(const std::string& message) {
     sendInLoop(message.data(), message.size());
@@ -224,6 +517,10 @@ void siren::net::TcpConnection::sendInLoop(const void* data, size_t len) {
         LOG_WARN("disconnected, give up writing");
         return;
     }
+    if (!fdQueue_.empty()) {
+        fdQueue_.back().data.append(static_cast<const char*>(data), len);
+        return;
+    }
 
     if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
         nwrote = sockets::write(channel_->fd(), data, len);
@@ -247,7 +544,7 @@ void siren::net::TcpConnection::sendInLoop(const void* data, size_t len) {
         }
     }
     if (!faultError && remaining > 0) {
-        size_t oldLen = outputBuffer_.readableBytes();
+        size_t oldLen = pendingBytes();
         if (oldLen + remaining >= highWaterMark_ && oldLen < highWaterMark_ &&
             highWaterMarkCallback_) {
             loop_->queueInLoop(std::bind(highWaterMarkCallback_,
@@ -262,6 +559,189 @@ void siren::net::TcpConnection::sendInLoop(const void* data, size_t len) {
     }
 }
 
+void siren::net::TcpConnection::sendPayloadInLoop(const SharedPayload& payload) {
+    loop_->assertInLoopThread();
+    if (state_ == kDisconnected) {
+        LOG_WARN("disconnected, give up writing");
+        return;
+    }
+    if (!fdQueue_.empty()) {
+        // rare enough to copy rather than track payloads behind fd messages
+        fdQueue_.back().data.append(payload.data(), payload.size());
+        return;
+    }
+    size_t nwrote = 0;
+    if (!channel_->isWriting() && pendingBytes() == 0) {
+        ssize_t n = useZeroCopy(payload.size())
+                        ? writeZeroCopy(payload, 0)
+                        : sockets::write(channel_->fd(), payload.data(), payload.size());
+        if (n >= 0) {
+            nwrote = static_cast<size_t>(n);
+            if (nwrote == payload.size()) {
+                if (writeCompleteCallback_) {
+                    loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+                }
+                return;
+            }
+        } else if (errno != EWOULDBLOCK) {
+            LOG_ERROR("TcpConnection::sendPayloadInLoop");
+            if (errno == EPIPE || errno == ECONNRESET) return;
+        }
+    }
+
+    size_t remaining = payload.size() - nwrote;
+    size_t oldLen = pendingBytes();
+    if (oldLen + remaining >= highWaterMark_ && oldLen < highWaterMark_ &&
+        highWaterMarkCallback_) {
+        loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(),
+                                     oldLen + remaining));
+    }
+    size_t tail = outputBuffer_.readableBytes() - queuedBufferBytes_;
+    payloadQueue_.push_back(PendingPayload{payload, nwrote, tail});
+    queuedBufferBytes_ += tail;
+    payloadBytes_ += remaining;
+    if (!channel_->isWriting()) {
+        channel_->enableWriting();
+    }
+}
+
+void siren::net::TcpConnection::sendFdsInLoop(std::vector<int>& fds, const std::string& message) {
+    loop_->assertInLoopThread();
+    if (state_ == kDisconnected) {
+        LOG_WARN("disconnected, give up writing");
+        for (int fd : fds) ::close(fd);
+        return;
+    }
+    fdQueue_.push_back(PendingFds{std::move(fds), message});
+    if (!channel_->isWriting() && pendingBytes() == 0) {
+        writeFdQueue();
+    }
+    if ((pendingBytes() > 0 || !fdQueue_.empty()) && !channel_->isWriting()) {
+        channel_->enableWriting();
+    }
+}
+
+void siren::net::TcpConnection::writeFdQueue() {
+    while (!fdQueue_.empty() && pendingBytes() == 0) {
+        PendingFds& front = fdQueue_.front();
+        ssize_t n = sockets::sendFds(channel_->fd(), front.fds.data(),
+                                     static_cast<int>(front.fds.size()), front.data.data(),
+                                     front.data.size());
+        if (n < 0) {
+            if (errno == EWOULDBLOCK) return;
+            LOG_ERROR("TcpConnection::writeFdQueue");
+            n = 0;  // give up on the descriptors, the bytes may still go
+        }
+        // the descriptors went with the first byte, our duplicates are done
+        for (int fd : front.fds) ::close(fd);
+        front.fds.clear();
+        // a short rest is plain bytes, it goes ahead of the next entry
+        outputBuffer_.append(front.data.data() + n, front.data.size() - static_cast<size_t>(n));
+        fdQueue_.pop_front();
+        if (outputBuffer_.readableBytes() > 0) {
+            ssize_t m = sockets::write(channel_->fd(), outputBuffer_.peek(),
+                                       outputBuffer_.readableBytes());
+            if (m > 0) outputBuffer_.retrieve(m);
+        }
+    }
+}
+
+void siren::net::TcpConnection::writeQueued() {
+    PendingPayload& head = payloadQueue_.front();
+    if (head.bufferBefore == 0 && useZeroCopy(head.payload.size() - head.offset)) {
+        ssize_t n = writeZeroCopy(head.payload, head.offset);
+        if (n < 0) {
+            if (errno != EWOULDBLOCK) LOG_ERROR("TcpConnection::writeQueued");
+            return;
+        }
+        head.offset += static_cast<size_t>(n);
+        payloadBytes_ -= static_cast<size_t>(n);
+        if (head.offset == head.payload.size()) payloadQueue_.pop_front();
+        return;
+    }
+
+    struct iovec iov[64];
+    int iovcnt = 0;
+    size_t bufferOffset = 0;
+    size_t entries = 0;
+    for (const PendingPayload& pending : payloadQueue_) {
+        if (iovcnt + 2 > static_cast<int>(sizeof iov / sizeof iov[0])) break;
+        ++entries;
+        if (pending.bufferBefore > 0) {
+            iov[iovcnt].iov_base = const_cast<char*>(outputBuffer_.peek()) + bufferOffset;
+            iov[iovcnt].iov_len = pending.bufferBefore;
+            ++iovcnt;
+            bufferOffset += pending.bufferBefore;
+        }
+        iov[iovcnt].iov_base = const_cast<char*>(pending.payload.data()) + pending.offset;
+        iov[iovcnt].iov_len = pending.payload.size() - pending.offset;
+        ++iovcnt;
+    }
+    // the tail goes behind the last entry
+    if (entries == payloadQueue_.size() && iovcnt < static_cast<int>(sizeof iov / sizeof iov[0]) &&
+        outputBuffer_.readableBytes() > bufferOffset) {
+        iov[iovcnt].iov_base = const_cast<char*>(outputBuffer_.peek()) + bufferOffset;
+        iov[iovcnt].iov_len = outputBuffer_.readableBytes() - bufferOffset;
+        ++iovcnt;
+    }
+
+    ssize_t n = sockets::writev(channel_->fd(), iov, iovcnt);
+    if (n < 0) {
+        if (errno != EWOULDBLOCK) LOG_ERROR("TcpConnection::writeQueued");
+        return;
+    }
+
+    // consume in the order the iovecs were laid out
+    size_t left = static_cast<size_t>(n);
+    while (left > 0 && !payloadQueue_.empty()) {
+        PendingPayload& front = payloadQueue_.front();
+        size_t fromBuffer = std::min(left, front.bufferBefore);
+        outputBuffer_.retrieve(static_cast<int>(fromBuffer));
+        front.bufferBefore -= fromBuffer;
+        queuedBufferBytes_ -= fromBuffer;
+        left -= fromBuffer;
+        if (front.bufferBefore > 0) break;
+
+        size_t fromPayload = std::min(left, front.payload.size() - front.offset);
+        front.offset += fromPayload;
+        payloadBytes_ -= fromPayload;
+        left -= fromPayload;
+        if (front.offset < front.payload.size()) break;
+        payloadQueue_.pop_front();
+    }
+    if (left > 0) {
+        assert(payloadQueue_.empty());
+        outputBuffer_.retrieve(static_cast<int>(left));
+    }
+}
+
+ssize_t siren::net::TcpConnection::writeZeroCopy(const SharedPayload& payload, size_t offset) {
+    ssize_t n = sockets::sendZeroCopy(channel_->fd(), payload.data() + offset,
+                                      payload.size() - offset);
+    if (n > 0) {
+        // the kernel numbers every MSG_ZEROCOPY send that took bytes
+        zeroCopyInflight_.push_back(payload);
+    } else if (n < 0 && errno == ENOBUFS) {
+        // over the optmem limit for pinned pages, copy this one
+        n = sockets::write(channel_->fd(), payload.data() + offset, payload.size() - offset);
+    }
+    return n;
+}
+
+void siren::net::TcpConnection::readZeroCopyCompletions() {
+    uint32_t lo, hi;
+    bool copied;
+    while (sockets::readZeroCopyCompletion(channel_->fd(), &lo, &hi, &copied)) {
+        releaseZeroCopy(&zeroCopyInflight_, &zeroCopyFirst_, lo, hi);
+        zeroCopyCopied_ = copied ? zeroCopyCopied_ + 1 : 0;
+        if (zeroCopyCopied_ >= kZeroCopyMaxCopied && zeroCopyThreshold_ > 0) {
+            // pinning pages and reading notifications only cost extra now
+            LOG_DEBUG("TcpConnection[{}] kernel keeps copying, zero-copy off", name_);
+            zeroCopyThreshold_ = 0;
+        }
+    }
+}
+
 void siren::net::TcpConnection::shutdownInLoop() {
     loop_->assertInLoopThread();
     if (!channel_->isWriting()) {
@@ -304,6 +784,59 @@ void TcpConnection::stopReadInLoop() {
     loop_->assertInLoopThread();
     if (reading_ || channel_->isReading()) {
         channel_->disableReading();
-        reading_ = true;
+        reading_ = false;
+    }
+}
+
+void TcpConnection::relayRead() {
+    TcpConnectionPtr peer = relayPeer_.lock();
+    if (!peer || peer->disconnected()) {
+        handleClose();
+        return;
     }
-}
\ No newline at end of file
+    ssize_t n = relayPipe_->fillFrom(channel_->fd());
+    if (n == 0) {
+        relayEof_ = true;
+        channel_->disableReading();
+    } else if (n < 0 && errno != EAGAIN) {
+        LOG_ERROR("TcpConnection::relayRead");
+        handleClose();
+        return;
+    }
+    relayFlush(peer);
+}
+
+void TcpConnection::relayFlush(const TcpConnectionPtr& peer) {
+    loop_->assertInLoopThread();
+    if (peer->disconnected()) return;
+    // bytes the peer queued itself go out before the pipe
+    if (relayPipe_->size() > 0 && peer->pendingBytes() == 0) {
+        ssize_t n = relayPipe_->drainTo(peer->channel_->fd());
+        if (n > 0) {
+            relayedBytes_ += static_cast<uint64_t>(n);
+        } else if (n < 0 && errno != EAGAIN) {
+            LOG_ERROR("TcpConnection::relayFlush");
+            peer->forceClose();
+            return;
+        }
+    }
+    if (relayPipe_->size() > 0 || peer->pendingBytes() > 0) {
+        // backpressure, read again once the peer's handleWrite drained us
+        if (channel_->isReading()) channel_->disableReading();
+        if (!peer->channel_->isWriting()) peer->channel_->enableWriting();
+        return;
+    }
+
+    if (relayEof_) {
+        if (!relayShutdown_) {
+            relayShutdown_ = true;
+            peer->shutdown();  // half-close, the other direction keeps going
+        }
+        if (peer->relayShutdown_) {
+            forceClose();
+            peer->forceClose();
+        }
+    } else if (reading_ && !channel_->isReading()) {
+        channel_->enableReading();
+    }
+}
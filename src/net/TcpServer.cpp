@@ -1,14 +1,51 @@
 #include "siren/net/TcpServer.h"
 
+#include <stddef.h>
+#include <sys/un.h>
+
 #include <atomic>
+#include <string_view>
 
 #include "siren/base/Logger.h"
+#include "siren/base/Metrics.h"
 #include "siren/net/Acceptor.h"
 #include "siren/net/EventLoop.h"
 #include "siren/net/EventLoopThreadPool.h"
 #include "siren/net/SocketsOps.h"
 using namespace siren::net;
 
+namespace {
+// the peer's IP only (the path for AF_UNIX): the ephemeral port changes on
+// every reconnect and would scatter one client over all loops
+size_t hashPeerAddress(const InetAddress& addr) {
+    const struct sockaddr* sa = addr.getSockAddr();
+    std::string_view key;
+    switch (sa->sa_family) {
+        case AF_INET: {
+            const auto* in = reinterpret_cast<const struct sockaddr_in*>(sa);
+            key = std::string_view(reinterpret_cast<const char*>(&in->sin_addr),
+                                   sizeof in->sin_addr);
+            break;
+        }
+        case AF_INET6: {
+            const auto* in6 = reinterpret_cast<const struct sockaddr_in6*>(sa);
+            key = std::string_view(reinterpret_cast<const char*>(&in6->sin6_addr),
+                                   sizeof in6->sin6_addr);
+            break;
+        }
+        case AF_UNIX: {
+            const auto* un = reinterpret_cast<const struct sockaddr_un*>(sa);
+            const size_t base = offsetof(struct sockaddr_un, sun_path);
+            key = std::string_view(un->sun_path, addr.length() - base);
+            break;
+        }
+        default:
+            break;
+    }
+    return std::hash<std::string_view>()(key);
+}
+}  // namespace
+
 siren::net::TcpServer::TcpServer(EventLoop* loop, const InetAddress& listenAddr,
                                  const string& nameArg, Option option)
     : loop_(loop),
@@ -18,7 +55,17 @@ siren::net::TcpServer::TcpServer(EventLoop* loop, const InetAddress& listenAddr,
       threadPool_(new EventLoopThreadPool(loop, name_)),
       connectionCallback_(defaultConnectionCallback),
       messageCallback_(defaultMessageCallback),
-      nextConnId_(1) {
+      started_(0),
+      nextConnId_(1),
+      incomingCpuSteering_(false),
+      busyPollUsec_(0),
+      acceptedCounter_(&metrics::counter(
+          "siren_tcp_connections_accepted_total",
+          "Number of connections accepted by a TcpServer",
+          "server=\"" + name_ + "\"")),
+      activeGauge_(&metrics::gauge("siren_tcp_connections_active",
+                                   "Number of open TcpServer connections",
+                                   "server=\"" + name_ + "\"")) {
     acceptor_->setNewConnectionCallback(
         std::bind(&TcpServer::newConnection, this, _1, _2));
 }
@@ -40,6 +87,14 @@ void TcpServer::setThreadNum(int numThreads) {
     threadPool_->setThreadNum(numThreads);
 }
 
+void TcpServer::setLoopStrategy(EventLoopThreadPool::Strategy strategy) {
+    threadPool_->setStrategy(strategy);
+}
+
+void TcpServer::setLoopSelector(EventLoopThreadPool::LoopSelector selector) {
+    threadPool_->setLoopSelector(std::move(selector));
+}
+
 void TcpServer::start() {
     if (started_.fetch_add(1) == 0) {
         threadPool_->start(threadInitCallback_);
@@ -51,7 +106,17 @@ void TcpServer::start() {
 
 void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr) {
     loop_->assertInLoopThread();
-    EventLoop* ioLoop = threadPool_->getNextLoop();
+    EventLoop* ioLoop = nullptr;
+    if (incomingCpuSteering_) {
+        int cpu = sockets::getIncomingCpu(sockfd);
+        ioLoop = threadPool_->getLoopForCpu(cpu);
+        if (ioLoop == nullptr) {
+            LOG_DEBUG("TcpServer::newConnection [{}] - no loop on cpu {}", name_, cpu);
+            ioLoop = threadPool_->getNextLoop();
+        }
+    } else {
+        ioLoop = threadPool_->getLoop(hashPeerAddress(peerAddr));
+    }
     char buf[64];
     snprintf(buf, sizeof buf, "-%s#%d", ipPort_.c_str(), nextConnId_);
     ++nextConnId_;
@@ -59,14 +124,19 @@ void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr) {
     LOG_INFO("TcpServer::newConnection [{}] - new connection [{}] from {}",
              name_, connName, peerAddr.toIpPort());
 
-    InetAddress localAddr(sockets::getLocalAddr(sockfd));
+    InetAddress localAddr = InetAddress::localAddressOf(sockfd);
     
     TcpConnectionPtr conn(
         new TcpConnection(ioLoop, connName, sockfd, localAddr, peerAddr));
     connections_[connName] = conn;
+    acceptedCounter_->inc();
+    activeGauge_->inc();
     conn->setConnectionCallback(connectionCallback_);
     conn->setMessageCallback(messageCallback_);
     conn->setWriteCompleteCallback(writeCompleteCallback_);
+    if (busyPollUsec_ > 0) {
+        conn->setBusyPoll(busyPollUsec_);
+    }
     conn->setCloseCallback(
         std::bind(&TcpServer::removeConnection, this, _1));  
     ioLoop->runInLoop(std::bind(&TcpConnection::connectEstablished, conn));
@@ -83,6 +153,7 @@ void TcpServer::removeConnectionInLoop(const TcpConnectionPtr& conn) {
              conn->name());
     size_t n = connections_.erase(conn->name());
     assert(n == 1);
+    activeGauge_->dec();
     EventLoop* ioLoop = conn->getLoop();
     ioLoop->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
 }
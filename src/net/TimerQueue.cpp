@@ -3,10 +3,17 @@
 #include <sys/timerfd.h>
 #include <unistd.h>
 
+#include "siren/base/Metrics.h"
+
 namespace siren {
 namespace net {
 namespace detail {
 
+metrics::Counter& g_timersFired = metrics::counter(
+    "siren_timers_fired_total", "Number of timer callbacks run");
+metrics::Gauge& g_timersActive = metrics::gauge(
+    "siren_timers_active", "Number of timers waiting in TimerQueues");
+
 int createTimerfd() {
     int timerfd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
     if (timerfd < 0) {
@@ -61,7 +68,8 @@ using namespace siren::net;
 using namespace siren::net::detail;
 
 siren::net::TimerQueue::TimerQueue(EventLoop* loop)
-    : loop_(loop),
+    : callingExpiredTimers_(false),
+      loop_(loop),
       timerfd_(createTimerfd()),
       timerfdChannel_(loop, timerfd_),
       timers_() {
@@ -78,17 +86,21 @@ siren::net::TimerQueue::~TimerQueue() {
     for(const auto &k: timers_){
         delete k;
     }
+    g_timersActive.dec(static_cast<int64_t>(timers_.size()));
 }
 
 TimerId siren::net::TimerQueue::addTimer(TimerCallback cb, Timestamp when,
-                                         int64_t interval) {
+                                         double interval) {
     auto timer = new Timer(std::move(cb), when, interval);
+    g_timersActive.inc();
     loop_->runInLoop(std::bind(&TimerQueue::addTimerInLoop, this, timer));
 
     return TimerId(timer, timer->sequence());
 }
 
-void siren::net::TimerQueue::cancel(TimerId timerId) {}
+void siren::net::TimerQueue::cancel(TimerId timerId) {
+    loop_->runInLoop(std::bind(&TimerQueue::cancelInLoop, this, timerId));
+}
 
 void siren::net::TimerQueue::addTimerInLoop(Timer* timer) {
     loop_->assertInLoopThread();
@@ -97,6 +109,25 @@ void siren::net::TimerQueue::addTimerInLoop(Timer* timer) {
     if (earliestChanged) resetTimerfd(timerfd_, timer->expiration());
 }
 
+void siren::net::TimerQueue::cancelInLoop(TimerId timerId) {
+    loop_->assertInLoopThread();
+    assert(timers_.size() == activeTimers_.size());
+    ActiveTimer timer(timerId.timer_, timerId.sequence_);
+    auto it = activeTimers_.find(timer);
+    if (it != activeTimers_.end()) {
+        size_t n = timers_.erase(it->first);
+        assert(n == 1);
+        (void)n;
+        delete it->first;
+        activeTimers_.erase(it);
+        g_timersActive.dec();
+    } else if (callingExpiredTimers_) {
+        // the timer is running right now, reset() must not re-arm it
+        cancelingTimers_.insert(timer);
+    }
+    assert(timers_.size() == activeTimers_.size());
+}
+
 void siren::net::TimerQueue::handleRead() {
     loop_->assertInLoopThread();
     Timestamp now = std::chrono::system_clock::now();
@@ -105,10 +136,12 @@ void siren::net::TimerQueue::handleRead() {
     std::vector<Timer*> expired = getExpired(now);
 
     callingExpiredTimers_ = true;
+    cancelingTimers_.clear();
     // safe to callback outside critical section
     for (auto iter : expired) {
         iter->run();
     }
+    g_timersFired.inc(static_cast<int64_t>(expired.size()));
     callingExpiredTimers_ = false;
 
     reset(expired, now);
@@ -117,11 +150,12 @@ void siren::net::TimerQueue::reset(const std::vector<Timer*>& expired,
                                    Timestamp now) {
     Timestamp nextExpire;
     for (auto iter : expired) {
-        if (iter->repeat()) {
+        ActiveTimer timer(iter, iter->sequence());
+        if (iter->repeat() && cancelingTimers_.find(timer) == cancelingTimers_.end()) {
             iter->restart(now);
             insert(iter);
         } else {
-          
+            g_timersActive.dec();
             delete iter;  // no delete?$
         }
     }
@@ -143,6 +177,11 @@ std::vector<Timer*> siren::net::TimerQueue::getExpired(Timestamp now) {
 
     std::copy(timers_.begin(), end, back_inserter(expired));
     timers_.erase(timers_.begin(), end);
+    for (Timer* timer : expired) {
+        size_t n = activeTimers_.erase(ActiveTimer(timer, timer->sequence()));
+        assert(n == 1);
+        (void)n;
+    }
     return expired;
 }
 
@@ -155,6 +194,9 @@ bool siren::net::TimerQueue::insert(Timer* timer) {
     if (iter == timers_.end() || when < (*iter)->expiration())
         earliestChanged = true;
     auto result = timers_.insert(timer);
+    assert(result.second);
+    (void)result;
+    activeTimers_.insert(ActiveTimer(timer, timer->sequence()));
 
     return earliestChanged;
 }
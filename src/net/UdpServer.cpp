@@ -0,0 +1,60 @@
+#include "siren/net/UdpServer.h"
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/EventLoopThreadPool.h"
+
+using namespace siren;
+using namespace siren::net;
+
+siren::net::UdpServer::UdpServer(EventLoop* loop, const InetAddress& listenAddr,
+                                 const string& nameArg)
+    : loop_(loop),
+      listenAddr_(listenAddr),
+      name_(nameArg),
+      threadPool_(new EventLoopThreadPool(loop, name_)),
+      batch_(UdpSocket::kDefaultBatch),
+      maxDatagram_(UdpSocket::kDefaultMaxDatagram),
+      gro_(false),
+      gso_(false),
+      started_(0) {}
+
+siren::net::UdpServer::~UdpServer() {
+    loop_->assertInLoopThread();
+    LOG_TRACE("UdpServer::~UdpServer [{}] destructing", name_);
+    // each socket is torn down by the loop that owns its channel
+    for (auto& socket : sockets_) {
+        EventLoop* ioLoop = socket->getLoop();
+        ioLoop->runInLoop([socket]() mutable { socket.reset(); });
+    }
+    sockets_.clear();
+}
+
+void siren::net::UdpServer::setThreadNum(int numThreads) {
+    assert(0 <= numThreads);
+    threadPool_->setThreadNum(numThreads);
+}
+
+void siren::net::UdpServer::start() {
+    if (started_.fetch_add(1) != 0) return;
+    threadPool_->start(threadInitCallback_);
+
+    std::vector<EventLoop*> loops = threadPool_->getAllLoops();
+    InetAddress addr = listenAddr_;
+    for (size_t i = 0; i < loops.size(); ++i) {
+        char buf[32];
+        snprintf(buf, sizeof buf, "#%zu", i);
+        auto socket = std::make_shared<UdpSocket>(loops[i], addr, name_ + buf, true);
+        // a wildcard port is fixed by the first bind, the others share it
+        addr = socket->localAddress();
+        socket->setBatchSize(batch_);
+        socket->setMaxDatagramSize(maxDatagram_);
+        if (gro_) socket->enableGro(true);
+        socket->enableGso(gso_);
+        socket->setMessageCallback(messageCallback_);
+        socket->start();
+        sockets_.push_back(std::move(socket));
+    }
+    LOG_INFO("UdpServer [{}] listening on {} with {} sockets", name_, addr.toIpPort(),
+             sockets_.size());
+}
@@ -0,0 +1,306 @@
+#include "siren/net/UdpSocket.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <netinet/udp.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+
+#include "siren/base/Logger.h"
+#include "siren/net/Channel.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/Socket.h"
+#include "siren/net/SocketsOps.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+    // recvmmsg() rounds per wakeup, so one busy socket cannot starve the loop
+    constexpr int kMaxReadRounds = 8;
+    constexpr size_t kGroSlotSize = 65536;
+} // namespace
+
+siren::net::UdpSocket::UdpSocket(EventLoop* loop, const InetAddress& bindAddr,
+                                 const string& name, bool reusePort)
+    : loop_(loop),
+      name_(name),
+      socket_(new Socket(sockets::createUdpNonblockingOrDie(bindAddr.family()))),
+      channel_(new Channel(loop, socket_->fd())),
+      localAddr_(bindAddr),
+      batch_(kDefaultBatch),
+      maxDatagram_(kDefaultMaxDatagram),
+      gro_(false),
+      gso_(false),
+      flushQueued_(false),
+      slotSize_(0),
+      received_(0),
+      truncated_(0),
+      dropped_(0),
+      self_(std::make_shared<UdpSocket*>(this)) {
+    socket_->setReuseAddr(true);
+    socket_->setReusePort(reusePort);
+    socket_->bindAddress(bindAddr);
+    localAddr_ = InetAddress(sockets::getLocalAddr(socket_->fd()));
+    channel_->setReadCallback(std::bind(&UdpSocket::handleRead, this, _1));
+    channel_->setWriteCallback(std::bind(&UdpSocket::handleWrite, this));
+}
+
+siren::net::UdpSocket::~UdpSocket() {
+    loop_->assertInLoopThread();
+    self_.reset();
+    channel_->disableAll();
+    channel_->remove();
+}
+
+int siren::net::UdpSocket::fd() const {
+    return socket_->fd();
+}
+
+void siren::net::UdpSocket::setBatchSize(int batch) {
+    batch_ = std::clamp(batch, 1, UIO_MAXIOV);
+}
+
+void siren::net::UdpSocket::setMaxDatagramSize(size_t size) {
+    maxDatagram_ = std::clamp<size_t>(size, 1, 65535);
+}
+
+bool siren::net::UdpSocket::enableGro(bool on) {
+#ifdef UDP_GRO
+    int optval = on ? 1 : 0;
+    if (::setsockopt(socket_->fd(), SOL_UDP, UDP_GRO, &optval,
+                     static_cast<socklen_t>(sizeof optval)) < 0) {
+        LOG_WARN("UDP_GRO failed, fd = {}, errno = {}", socket_->fd(), errno);
+        return false;
+    }
+    gro_ = on;
+    return true;
+#else
+    LOG_WARN("UDP_GRO is not supported.");
+    return false;
+#endif
+}
+
+void siren::net::UdpSocket::start() {
+    loop_->runInLoop([weak = std::weak_ptr<UdpSocket*>(self_)]() {
+        if (auto self = weak.lock()) (*self)->startInLoop();
+    });
+}
+
+void siren::net::UdpSocket::startInLoop() {
+    loop_->assertInLoopThread();
+    if (channel_->isReading()) return;
+    allocateSlots();
+    channel_->enableReading();
+}
+
+void siren::net::UdpSocket::allocateSlots() {
+    const size_t batch = static_cast<size_t>(batch_);
+    slotSize_ = gro_ ? kGroSlotSize : maxDatagram_;
+    const size_t controlSize = gro_ ? CMSG_SPACE(sizeof(int)) : 0;
+    slots_.assign(batch * slotSize_, 0);
+    recvMsgs_.assign(batch, mmsghdr());
+    recvIovs_.resize(batch);
+    recvAddrs_.resize(batch);
+    recvControl_.assign(batch * controlSize, 0);
+    for (size_t i = 0; i < batch; ++i) {
+        recvIovs_[i].iov_base = &slots_[i * slotSize_];
+        recvIovs_[i].iov_len = slotSize_;
+        struct msghdr& hdr = recvMsgs_[i].msg_hdr;
+        hdr.msg_name = &recvAddrs_[i];
+        hdr.msg_iov = &recvIovs_[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = controlSize > 0 ? &recvControl_[i * controlSize] : nullptr;
+    }
+
+    sendMsgs_.resize(batch);
+    sendSegments_.resize(batch);
+    sendIovs_.resize(batch * (gso_ ? kGsoMaxSegments : 1));
+    sendControl_.assign(gso_ ? batch * CMSG_SPACE(sizeof(uint16_t)) : 0, 0);
+}
+
+void siren::net::UdpSocket::handleRead(Timestamp receiveTime) {
+    loop_->assertInLoopThread();
+    const size_t controlSize = gro_ ? CMSG_SPACE(sizeof(int)) : 0;
+    for (int round = 0; round < kMaxReadRounds; ++round) {
+        for (int i = 0; i < batch_; ++i) {
+            struct msghdr& hdr = recvMsgs_[i].msg_hdr;
+            hdr.msg_namelen = static_cast<socklen_t>(sizeof(struct sockaddr_in6));
+            hdr.msg_controllen = controlSize;
+            hdr.msg_flags = 0;
+        }
+        int n = ::recvmmsg(socket_->fd(), recvMsgs_.data(), static_cast<unsigned>(batch_),
+                           MSG_DONTWAIT, nullptr);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("UdpSocket::handleRead [{}], errno = {}", name_, errno);
+            }
+            return;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            struct msghdr& hdr = recvMsgs_[i].msg_hdr;
+            const size_t len = std::min<size_t>(recvMsgs_[i].msg_len, slotSize_);
+            if (hdr.msg_flags & MSG_TRUNC) ++truncated_;
+            // with GRO one slot may carry a train of equal-sized datagrams
+            size_t segment = len;
+            if (gro_) {
+                for (struct cmsghdr* cm = CMSG_FIRSTHDR(&hdr); cm != nullptr;
+                     cm = CMSG_NXTHDR(&hdr, cm)) {
+                    if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+                        int size;
+                        memcpy(&size, CMSG_DATA(cm), sizeof size);
+                        if (size > 0) segment = static_cast<size_t>(size);
+                    }
+                }
+            }
+            const InetAddress peer(recvAddrs_[i]);
+            const char* data = &slots_[static_cast<size_t>(i) * slotSize_];
+            size_t offset = 0;
+            do {
+                size_t piece = std::min(segment, len - offset);
+                ++received_;
+                if (messageCallback_) {
+                    messageCallback_(this, data + offset, piece, peer, receiveTime);
+                }
+                offset += piece;
+            } while (offset < len);
+        }
+        if (n < batch_) return;
+    }
+}
+
+void siren::net::UdpSocket::handleWrite() {
+    loop_->assertInLoopThread();
+    flush();
+}
+
+void siren::net::UdpSocket::send(const InetAddress& peer, const void* data, size_t len) {
+    struct sockaddr_in6 addr;
+    memcpy(&addr, peer.getSockAddr(), sizeof addr);
+    if (loop_->isInLoopThread()) {
+        sendInLoop(addr, data, len);
+    } else {
+        // the caller's bytes may be gone by the time the loop runs
+        loop_->runInLoop([weak = std::weak_ptr<UdpSocket*>(self_), addr,
+                          copy = std::string(static_cast<const char*>(data), len)]() {
+            if (auto self = weak.lock()) (*self)->sendInLoop(addr, copy.data(), copy.size());
+        });
+    }
+}
+
+void siren::net::UdpSocket::sendInLoop(const struct sockaddr_in6& peer, const void* data,
+                                       size_t len) {
+    loop_->assertInLoopThread();
+    if (sendQueue_.size() >= kMaxQueued) {
+        ++dropped_;
+        return;
+    }
+    const size_t offset = sendArena_.size();
+    sendArena_.insert(sendArena_.end(), static_cast<const char*>(data),
+                      static_cast<const char*>(data) + len);
+    sendQueue_.push_back(Outgoing{offset, len, peer});
+    // one sendmmsg() per loop iteration, or when the socket is writable again
+    if (!flushQueued_ && !channel_->isWriting()) {
+        flushQueued_ = true;
+        loop_->queueInLoop([weak = std::weak_ptr<UdpSocket*>(self_)]() {
+            if (auto self = weak.lock()) {
+                (*self)->flushQueued_ = false;
+                (*self)->flush();
+            }
+        });
+    }
+}
+
+void siren::net::UdpSocket::flush() {
+    loop_->assertInLoopThread();
+    if (sendMsgs_.empty()) allocateSlots();
+    size_t sent = 0;
+    while (sent < sendQueue_.size()) {
+        size_t n = sendBatch(sent, sendQueue_.size());
+        if (n == 0) break;
+        sent += n;
+    }
+    if (sent == sendQueue_.size()) {
+        sendQueue_.clear();
+        sendArena_.clear();
+        if (channel_->isWriting()) channel_->disableWriting();
+    } else {
+        sendQueue_.erase(sendQueue_.begin(), sendQueue_.begin() + static_cast<long>(sent));
+        // drop the sent bytes too, kMaxQueued only bounds the arena if it
+        // holds nothing but queued datagrams; they sit in queue order
+        const size_t base = sendQueue_.front().offset;
+        if (base > 0) {
+            sendArena_.erase(sendArena_.begin(), sendArena_.begin() + static_cast<long>(base));
+            for (Outgoing& out : sendQueue_) out.offset -= base;
+        }
+        if (!channel_->isWriting()) channel_->enableWriting();
+    }
+}
+
+size_t siren::net::UdpSocket::sendBatch(size_t first, size_t last) {
+    const size_t maxMsgs = sendMsgs_.size();
+    const size_t maxSegments = gso_ ? kGsoMaxSegments : 1;
+    const size_t controlSize = CMSG_SPACE(sizeof(uint16_t));
+    size_t msgs = 0;
+    size_t i = first;
+    while (i < last && msgs < maxMsgs) {
+        const Outgoing& head = sendQueue_[i];
+        size_t segments = 1;
+        size_t total = head.len;
+        // a GSO train: same peer, same size, only the last may be shorter
+        while (i + segments < last && segments < maxSegments && head.len > 0) {
+            const Outgoing& next = sendQueue_[i + segments];
+            if (next.len > head.len || next.len == 0 || total + next.len > kGsoMaxBytes ||
+                memcmp(&next.peer, &head.peer, sizeof head.peer) != 0) {
+                break;
+            }
+            total += next.len;
+            ++segments;
+            if (next.len < head.len) break;
+        }
+
+        struct iovec* iov = &sendIovs_[msgs * maxSegments];
+        for (size_t k = 0; k < segments; ++k) {
+            const Outgoing& out = sendQueue_[i + k];
+            iov[k].iov_base = &sendArena_[out.offset];
+            iov[k].iov_len = out.len;
+        }
+        struct mmsghdr& msg = sendMsgs_[msgs];
+        memZero(&msg, sizeof msg);
+        msg.msg_hdr.msg_name = const_cast<struct sockaddr_in6*>(&head.peer);
+        msg.msg_hdr.msg_namelen = static_cast<socklen_t>(sizeof head.peer);
+        msg.msg_hdr.msg_iov = iov;
+        msg.msg_hdr.msg_iovlen = segments;
+        if (segments > 1) {
+            char* control = &sendControl_[msgs * controlSize];
+            memZero(control, controlSize);
+            msg.msg_hdr.msg_control = control;
+            msg.msg_hdr.msg_controllen = controlSize;
+            struct cmsghdr* cm = CMSG_FIRSTHDR(&msg.msg_hdr);
+            cm->cmsg_level = SOL_UDP;
+            cm->cmsg_type = UDP_SEGMENT;
+            cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t size = static_cast<uint16_t>(head.len);
+            memcpy(CMSG_DATA(cm), &size, sizeof size);
+        }
+        sendSegments_[msgs] = segments;
+        ++msgs;
+        i += segments;
+    }
+
+    int n = ::sendmmsg(socket_->fd(), sendMsgs_.data(), static_cast<unsigned>(msgs),
+                       MSG_DONTWAIT);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        // the first message failed, drop it and carry on with the rest
+        LOG_ERROR("UdpSocket::sendBatch [{}], errno = {}", name_, errno);
+        dropped_ += sendSegments_[0];
+        return sendSegments_[0];
+    }
+    size_t consumed = 0;
+    for (int k = 0; k < n; ++k) consumed += sendSegments_[k];
+    return consumed;
+}
@@ -0,0 +1,177 @@
+#include "siren/net/http/HttpParser.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <charconv>
+
+#include "siren/net/Buffer.h"
+
+using namespace siren::net;
+
+const size_t HttpParser::kDefaultMaxHeaderBytes;
+const size_t HttpParser::kDefaultMaxBodyBytes;
+
+namespace {
+
+const char kCRLF[] = "\r\n";
+
+HttpRequest::Method toMethod(std::string_view m) {
+    switch (m.size()) {
+        case 3:
+            if (m == "GET") return HttpRequest::kGet;
+            if (m == "PUT") return HttpRequest::kPut;
+            break;
+        case 4:
+            if (m == "POST") return HttpRequest::kPost;
+            if (m == "HEAD") return HttpRequest::kHead;
+            break;
+        case 5:
+            if (m == "PATCH") return HttpRequest::kPatch;
+            break;
+        case 6:
+            if (m == "DELETE") return HttpRequest::kDelete;
+            break;
+        case 7:
+            if (m == "OPTIONS") return HttpRequest::kOptions;
+            break;
+        default:
+            break;
+    }
+    return HttpRequest::kInvalid;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+}  // namespace
+
+HttpParser::Result siren::net::HttpParser::parse(const Buffer* buf, HttpRequest* request) {
+    const char* data = buf->peek();
+    size_t readable = buf->readableBytes();
+
+    bool headParsed = false;
+    if (headerBytes_ == 0) {
+        // resume the search where the previous read stopped, minus a
+        // possibly split terminator
+        size_t from = scanned_ > 3 ? scanned_ - 3 : 0;
+        const void* found = ::memmem(data + from, readable - from, "\r\n\r\n", 4);
+        if (found == nullptr) {
+            scanned_ = readable;
+            return readable > maxHeaderBytes_ ? fail(431) : kNeedMore;
+        }
+        headerBytes_ = static_cast<size_t>(static_cast<const char*>(found) - data) + 4;
+        if (headerBytes_ > maxHeaderBytes_) {
+            return fail(431);
+        }
+        if (!parseHead(data, data + headerBytes_, request)) {
+            return kError;
+        }
+        headParsed = true;
+    }
+
+    if (readable - headerBytes_ < bodyBytes_) {
+        return kNeedMore;
+    }
+    if (!headParsed) {
+        // the buffer may have moved since the header was first parsed
+        parseHead(data, data + headerBytes_, request);
+    }
+    request->body_ = std::string_view(data + headerBytes_, bodyBytes_);
+    return kComplete;
+}
+
+bool siren::net::HttpParser::parseHead(const char* begin, const char* end,
+                                       HttpRequest* request) {
+    // request line: METHOD SP target SP HTTP/1.x CRLF
+    const char* eol = std::search(begin, end, kCRLF, kCRLF + 2);
+    std::string_view line(begin, static_cast<size_t>(eol - begin));
+    size_t sp1 = line.find(' ');
+    size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos || sp2 == sp1 + 1) {
+        fail(400);
+        return false;
+    }
+
+    request->methodString_ = line.substr(0, sp1);
+    request->method_ = toMethod(request->methodString_);
+    if (request->method_ == HttpRequest::kInvalid) {
+        fail(501);
+        return false;
+    }
+
+    std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    size_t question = target.find('?');
+    if (question == std::string_view::npos) {
+        request->path_ = target;
+        request->query_ = std::string_view();
+    } else {
+        request->path_ = target.substr(0, question);
+        request->query_ = target.substr(question + 1);
+    }
+
+    std::string_view version = line.substr(sp2 + 1);
+    if (version == "HTTP/1.1") {
+        request->version_ = HttpRequest::kHttp11;
+    } else if (version == "HTTP/1.0") {
+        request->version_ = HttpRequest::kHttp10;
+    } else {
+        fail(400);
+        return false;
+    }
+
+    // header fields, up to the empty line
+    request->numHeaders_ = 0;
+    bodyBytes_ = 0;
+    bool sawLength = false;
+    const char* p = eol + 2;
+    while (p < end) {
+        eol = std::search(p, end, kCRLF, kCRLF + 2);
+        if (eol == p) break;
+        std::string_view field(p, static_cast<size_t>(eol - p));
+        p = eol + 2;
+
+        size_t colon = field.find(':');
+        if (colon == 0 || colon == std::string_view::npos ||
+            field.substr(0, colon).find_first_of(" \t") != std::string_view::npos) {
+            fail(400);
+            return false;
+        }
+        if (request->numHeaders_ == HttpRequest::kMaxHeaders) {
+            fail(431);
+            return false;
+        }
+        std::string_view name = field.substr(0, colon);
+        std::string_view value = trim(field.substr(colon + 1));
+        request->headers_[request->numHeaders_++] = {name, value};
+
+        if (detail::equalsIgnoreCase(name, "Content-Length")) {
+            size_t length = 0;
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), length);
+            if (ec != std::errc() || ptr != value.data() + value.size()) {
+                fail(400);
+                return false;
+            }
+            // a repeat must agree (RFC 9110 8.6), or a proxy in front may
+            // frame the body differently from us: request smuggling
+            if (sawLength && length != bodyBytes_) {
+                fail(400);
+                return false;
+            }
+            if (length > maxBodyBytes_) {
+                fail(413);
+                return false;
+            }
+            sawLength = true;
+            bodyBytes_ = length;
+        } else if (detail::equalsIgnoreCase(name, "Transfer-Encoding")) {
+            // chunked request bodies are not supported
+            fail(501);
+            return false;
+        }
+    }
+    return true;
+}
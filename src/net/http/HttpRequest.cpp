@@ -0,0 +1,24 @@
+#include "siren/net/http/HttpRequest.h"
+
+#include <strings.h>
+
+bool siren::net::detail::equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && ::strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+std::string_view siren::net::HttpRequest::getHeader(std::string_view field) const {
+    for (int i = 0; i < numHeaders_; ++i) {
+        if (detail::equalsIgnoreCase(headers_[i].first, field)) {
+            return headers_[i].second;
+        }
+    }
+    return {};
+}
+
+bool siren::net::HttpRequest::keepAlive() const {
+    std::string_view connection = getHeader("Connection");
+    if (version_ == kHttp11) {
+        return !detail::equalsIgnoreCase(connection, "close");
+    }
+    return detail::equalsIgnoreCase(connection, "keep-alive");
+}
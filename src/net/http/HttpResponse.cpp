@@ -0,0 +1,99 @@
+#include "siren/net/http/HttpResponse.h"
+
+#include <charconv>
+
+#include "siren/net/Buffer.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+void appendView(Buffer* output, std::string_view s) {
+    output->append(s.data(), s.size());
+}
+
+}  // namespace
+
+std::string_view siren::net::HttpResponse::reasonPhrase(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 301: return "Moved Permanently";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 413: return "Payload Too Large";
+        case 426: return "Upgrade Required";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        default: return "Unknown";
+    }
+}
+
+void siren::net::HttpResponse::reset(bool close) {
+    statusCode_ = kUnknown;
+    statusMessage_.clear();
+    closeConnection_ = close;
+    contentType_.clear();
+    numHeaders_ = 0;
+    body_.clear();
+}
+
+void siren::net::HttpResponse::setStatusCode(int code) {
+    statusCode_ = code;
+    statusMessage_.assign(reasonPhrase(code));
+}
+
+void siren::net::HttpResponse::addHeader(std::string_view key, std::string_view value) {
+    if (numHeaders_ < headers_.size()) {
+        headers_[numHeaders_].first.assign(key);
+        headers_[numHeaders_].second.assign(value);
+    } else {
+        headers_.emplace_back(string(key), string(value));
+    }
+    ++numHeaders_;
+}
+
+void siren::net::HttpResponse::appendToBuffer(Buffer* output, std::string_view date,
+                                              bool withBody) const {
+    char number[24];
+
+    appendView(output, "HTTP/1.1 ");
+    auto res = std::to_chars(number, number + sizeof number, statusCode_);
+    output->append(number, static_cast<size_t>(res.ptr - number));
+    output->append(" ", 1);
+    appendView(output, statusMessage_);
+    appendView(output, "\r\n");
+
+    if (closeConnection_) {
+        appendView(output, "Connection: close\r\n");
+    } else {
+        appendView(output, "Connection: Keep-Alive\r\n");
+    }
+
+    appendView(output, "Content-Length: ");
+    res = std::to_chars(number, number + sizeof number, body_.size());
+    output->append(number, static_cast<size_t>(res.ptr - number));
+    appendView(output, "\r\n");
+
+    if (!contentType_.empty()) {
+        appendView(output, "Content-Type: ");
+        appendView(output, contentType_);
+        appendView(output, "\r\n");
+    }
+
+    for (size_t i = 0; i < numHeaders_; ++i) {
+        appendView(output, headers_[i].first);
+        appendView(output, ": ");
+        appendView(output, headers_[i].second);
+        appendView(output, "\r\n");
+    }
+
+    appendView(output, date);
+    appendView(output, "\r\n");
+    if (withBody) {
+        appendView(output, body_);
+    }
+}
@@ -0,0 +1,124 @@
+#include "siren/net/http/HttpServer.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/http/HttpParser.h"
+#include "siren/net/http/HttpRequest.h"
+#include "siren/net/http/HttpResponse.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+struct HttpContext {
+    HttpParser parser;
+    HttpRequest request;
+    HttpResponse response;
+    Buffer output;  // responses of one read, sent with one write
+};
+
+// one copy per loop thread, refreshed by that loop's timer
+thread_local char t_dateHeader[64];
+thread_local size_t t_dateHeaderLen = 0;
+
+void refreshDateHeader() {
+    time_t now = ::time(nullptr);
+    struct tm tm;
+    ::gmtime_r(&now, &tm);
+    t_dateHeaderLen =
+        ::strftime(t_dateHeader, sizeof t_dateHeader, "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &tm);
+}
+
+void defaultHttpCallback(const HttpRequest&, HttpResponse* resp) {
+    resp->setStatusCode(HttpResponse::k404NotFound);
+    resp->setCloseConnection(true);
+}
+
+}  // namespace
+
+siren::net::HttpServer::HttpServer(EventLoop* loop, const InetAddress& listenAddr,
+                                   const string& name, TcpServer::Option option)
+    : server_(loop, listenAddr, name, option),
+      httpCallback_(defaultHttpCallback),
+      maxHeaderBytes_(HttpParser::kDefaultMaxHeaderBytes),
+      maxBodyBytes_(HttpParser::kDefaultMaxBodyBytes) {
+    server_.setConnectionCallback(std::bind(&HttpServer::onConnection, this, _1));
+    server_.setMessageCallback(std::bind(&HttpServer::onMessage, this, _1, _2, _3));
+    server_.setThreadInitCallback(&HttpServer::initLoop);
+}
+
+void siren::net::HttpServer::start() {
+    LOG_INFO("HttpServer[{}] starts listening", server_.name());
+    server_.start();
+}
+
+void siren::net::HttpServer::initLoop(EventLoop* loop) {
+    refreshDateHeader();
+    loop->runEvery(1.0, refreshDateHeader);
+}
+
+std::string_view siren::net::HttpServer::cachedDateHeader() {
+    if (t_dateHeaderLen == 0) {
+        refreshDateHeader();
+    }
+    return std::string_view(t_dateHeader, t_dateHeaderLen);
+}
+
+void siren::net::HttpServer::onConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        HttpContext context;
+        context.parser = HttpParser(maxHeaderBytes_, maxBodyBytes_);
+        conn->setContext(context);
+    }
+}
+
+void siren::net::HttpServer::onMessage(const TcpConnectionPtr& conn, Buffer* buf,
+                                       Timestamp) {
+    if (!conn->connected()) {
+        // already answered with Connection: close
+        buf->retrieveAll();
+        return;
+    }
+    auto* context = std::any_cast<HttpContext>(conn->getMutableContext());
+    HttpParser& parser = context->parser;
+    HttpRequest& request = context->request;
+    HttpResponse& response = context->response;
+    std::string_view date = cachedDateHeader();
+
+    bool close = false;
+    while (!close) {
+        HttpParser::Result result = parser.parse(buf, &request);
+        if (result == HttpParser::kNeedMore) {
+            break;
+        }
+        if (result == HttpParser::kError) {
+            response.reset(true);
+            response.setStatusCode(parser.errorStatus());
+            response.appendToBuffer(&context->output, date);
+            buf->retrieveAll();
+            close = true;
+            break;
+        }
+
+        response.reset(!request.keepAlive());
+        httpCallback_(request, &response);
+        response.appendToBuffer(&context->output, date,
+                                request.method() != HttpRequest::kHead);
+        close = response.closeConnection();
+        // the request points into buf, consume it only now
+        buf->retrieve(static_cast<int>(parser.requestBytes()));
+        parser.reset();
+    }
+
+    if (context->output.readableBytes() > 0) {
+        conn->send(&context->output);
+    }
+    if (close) {
+        buf->retrieveAll();
+        conn->shutdown();
+    }
+}
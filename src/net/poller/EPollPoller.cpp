@@ -72,6 +72,11 @@ void siren::net::EPollPoller::updateChannel(Channel* channel) {
             assert(channels_.find(fd)->second == channel);
         }
 
+        // nothing to watch, epoll would still report EPOLLHUP/EPOLLERR
+        if (channel->isNoneEvent()) {
+            channel->set_index(kDeleted);
+            return;
+        }
         channel->set_index(kAdded);
         update(EPOLL_CTL_ADD, channel);
     } else {
@@ -0,0 +1,221 @@
+#include "siren/net/resp/RespParser.h"
+
+#include <string.h>
+#include <strings.h>
+
+#include <charconv>
+
+#include "siren/net/Buffer.h"
+
+using namespace siren::net;
+
+const size_t RespParser::kMaxLineBytes;
+
+namespace {
+
+bool isTypeByte(char c) {
+    return strchr("+-:$*_#,(!=%~|>", c) != nullptr && c != '\0';
+}
+
+// @return the '\r' of the first "\r\n" in [p, end), or nullptr
+const char* findCRLF(const char* p, const char* end) {
+    while (p < end) {
+        const char* cr = static_cast<const char*>(memchr(p, '\r', static_cast<size_t>(end - p)));
+        if (cr == nullptr || cr + 1 >= end) return nullptr;
+        if (cr[1] == '\n') return cr;
+        p = cr + 1;
+    }
+    return nullptr;
+}
+
+bool toInt64(std::string_view s, int64_t* value) {
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), *value);
+    return ec == std::errc() && ptr == s.data() + s.size() && !s.empty();
+}
+
+}  // namespace
+
+bool siren::net::RespValue::isAggregate() const {
+    switch (type) {
+        case kArray:
+        case kMap:
+        case kSet:
+        case kAttribute:
+        case kPush:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool siren::net::RespValue::isString() const {
+    switch (type) {
+        case kSimpleString:
+        case kError:
+        case kBulkString:
+        case kDouble:
+        case kBigNumber:
+        case kBlobError:
+        case kVerbatim:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool siren::net::RespCommand::is(std::string_view command) const {
+    std::string_view n = name();
+    return n.size() == command.size() &&
+           ::strncasecmp(n.data(), command.data(), n.size()) == 0;
+}
+
+RespParser::Result siren::net::RespParser::parse(const Buffer* buf) {
+    return parse(buf->peek(), buf->readableBytes());
+}
+
+RespParser::Result siren::net::RespParser::parse(const char* data, size_t len) {
+    if (pos_ == 0 && len > 0 && acceptInline_ && !isTypeByte(data[0])) {
+        return parseInline(data, len);
+    }
+
+    const char* end = data + len;
+    while (pos_ < len) {
+        const char* p = data + pos_;
+        const char* eol = findCRLF(p, end);
+        if (eol == nullptr) {
+            return len - pos_ > kMaxLineBytes ? fail("line too long") : kNeedMore;
+        }
+
+        RespValue value;
+        value.type = static_cast<RespValue::Type>(*p);
+        std::string_view line(p + 1, static_cast<size_t>(eol - p - 1));
+        size_t next = static_cast<size_t>(eol - data) + 2;
+        size_t children = 0;
+
+        switch (*p) {
+            case RespValue::kSimpleString:
+            case RespValue::kError:
+            case RespValue::kDouble:
+            case RespValue::kBigNumber:
+                value.offset = pos_ + 1;
+                value.length = line.size();
+                break;
+            case RespValue::kInteger:
+                if (!toInt64(line, &value.integer)) return fail("invalid integer");
+                break;
+            case RespValue::kBoolean:
+                if (line != "t" && line != "f") return fail("invalid boolean");
+                value.integer = line == "t";
+                break;
+            case RespValue::kNull:
+                value.null = true;
+                break;
+            case RespValue::kBulkString:
+            case RespValue::kBlobError:
+            case RespValue::kVerbatim: {
+                int64_t n;
+                if (!toInt64(line, &n)) return fail("invalid bulk length");
+                if (n == -1 && *p == RespValue::kBulkString) {
+                    value.null = true;
+                    break;
+                }
+                if (n < 0 || static_cast<size_t>(n) > maxBulkBytes_) {
+                    return fail("invalid bulk length");
+                }
+                // wait for the whole payload without re-reading the header
+                if (len - next < static_cast<size_t>(n) + 2) return kNeedMore;
+                if (data[next + n] != '\r' || data[next + n + 1] != '\n') {
+                    return fail("bulk string not terminated by CRLF");
+                }
+                value.offset = next;
+                value.length = static_cast<size_t>(n);
+                next += static_cast<size_t>(n) + 2;
+                break;
+            }
+            case RespValue::kArray:
+            case RespValue::kSet:
+            case RespValue::kPush:
+            case RespValue::kMap:
+            case RespValue::kAttribute: {
+                int64_t n;
+                if (!toInt64(line, &n)) return fail("invalid multibulk length");
+                if (n == -1 && *p == RespValue::kArray) {
+                    value.null = true;
+                    break;
+                }
+                if (n < 0 || static_cast<size_t>(n) > maxElements_) {
+                    return fail("invalid multibulk length");
+                }
+                children = static_cast<size_t>(n);
+                if (*p == RespValue::kMap || *p == RespValue::kAttribute) children *= 2;
+                if (*p == RespValue::kAttribute) children += 1;
+                value.count = children;
+                break;
+            }
+            default:
+                return fail("unknown type byte");
+        }
+
+        pos_ = next;
+        if (values_.size() >= maxElements_) {
+            return fail("too many elements");
+        }
+        values_.push_back(value);
+        if (children > 0) {
+            stack_.push_back({values_.size() - 1, children});
+            continue;
+        }
+
+        // a value is complete, close every aggregate it completes
+        while (!stack_.empty()) {
+            Frame& top = stack_.back();
+            if (--top.remaining > 0) break;
+            values_[top.index].span = values_.size() - top.index;
+            stack_.pop_back();
+        }
+        if (stack_.empty()) {
+            return complete(data);
+        }
+    }
+    return kNeedMore;
+}
+
+RespParser::Result siren::net::RespParser::complete(const char* data) {
+    for (RespValue& value : values_) {
+        if (value.isString()) {
+            value.str = std::string_view(data + value.offset, value.length);
+        }
+    }
+    return kComplete;
+}
+
+RespParser::Result siren::net::RespParser::parseInline(const char* data, size_t len) {
+    const char* nl = static_cast<const char*>(memchr(data, '\n', len));
+    if (nl == nullptr) {
+        return len > kMaxLineBytes ? fail("inline command too long") : kNeedMore;
+    }
+    size_t lineLen = static_cast<size_t>(nl - data);
+    if (lineLen > 0 && data[lineLen - 1] == '\r') --lineLen;
+
+    values_.clear();
+    RespValue array;
+    array.type = RespValue::kArray;
+    values_.push_back(array);
+    size_t i = 0;
+    while (i < lineLen) {
+        while (i < lineLen && (data[i] == ' ' || data[i] == '\t')) ++i;
+        size_t start = i;
+        while (i < lineLen && data[i] != ' ' && data[i] != '\t') ++i;
+        if (i > start) {
+            RespValue arg;
+            arg.type = RespValue::kBulkString;
+            arg.offset = start;
+            arg.length = i - start;
+            values_.push_back(arg);
+        }
+    }
+    values_[0].count = values_.size() - 1;
+    values_[0].span = values_.size();
+    pos_ = static_cast<size_t>(nl - data) + 1;
+    return complete(data);
+}
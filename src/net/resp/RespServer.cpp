@@ -0,0 +1,114 @@
+#include "siren/net/resp/RespServer.h"
+
+#include "siren/base/Logger.h"
+#include "siren/net/resp/RespParser.h"
+#include "siren/net/resp/RespWriter.h"
+
+using namespace siren;
+using namespace siren::net;
+
+namespace {
+
+struct RespContext {
+    RespParser parser{true};
+    Buffer output;  // replies of one read, sent with one write
+    int protocol = 2;
+};
+
+void defaultCommandCallback(const TcpConnectionPtr&, const RespCommand& command,
+                            RespWriter* writer) {
+    string message = "ERR unknown command '";
+    message.append(command.name());
+    message += "'";
+    writer->error(message);
+}
+
+// an array whose elements are all plain strings
+bool isCommand(const std::vector<RespValue>& values) {
+    const RespValue& root = values.front();
+    if (root.type != RespValue::kArray || root.null || root.span != root.count + 1) {
+        return false;
+    }
+    for (size_t i = 1; i < values.size(); ++i) {
+        if (values[i].type != RespValue::kBulkString &&
+            values[i].type != RespValue::kSimpleString) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+siren::net::RespServer::RespServer(EventLoop* loop, const InetAddress& listenAddr,
+                                   const string& name, TcpServer::Option option)
+    : server_(loop, listenAddr, name, option), commandCallback_(defaultCommandCallback) {
+    server_.setConnectionCallback(std::bind(&RespServer::onConnection, this, _1));
+    server_.setMessageCallback(std::bind(&RespServer::onMessage, this, _1, _2, _3));
+}
+
+void siren::net::RespServer::start() {
+    LOG_INFO("RespServer[{}] starts listening", server_.name());
+    server_.start();
+}
+
+void siren::net::RespServer::onConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        conn->setContext(RespContext());
+    }
+}
+
+void siren::net::RespServer::onMessage(const TcpConnectionPtr& conn, Buffer* buf,
+                                       Timestamp) {
+    if (!conn->connected()) {
+        buf->retrieveAll();
+        return;
+    }
+    auto* context = std::any_cast<RespContext>(conn->getMutableContext());
+    RespParser& parser = context->parser;
+    RespWriter writer(&context->output, context->protocol);
+
+    bool close = false;
+    while (!close) {
+        RespParser::Result result = parser.parse(buf);
+        if (result == RespParser::kNeedMore) {
+            break;
+        }
+        if (result == RespParser::kError) {
+            string message = "ERR Protocol error: ";
+            message += parser.errorMessage();
+            writer.error(message);
+            close = true;
+            break;
+        }
+
+        const std::vector<RespValue>& values = parser.values();
+        if (!isCommand(values)) {
+            writer.error("ERR Protocol error: expected an array of bulk strings");
+            close = true;
+            break;
+        }
+        if (values.front().count > 0) {
+            RespCommand command(&values[1], values.front().count);
+            if (command.is("QUIT")) {
+                writer.ok();
+                close = true;
+            } else {
+                commandCallback_(conn, command, &writer);
+            }
+        }
+        // the command points into buf, consume it only now
+        buf->retrieve(static_cast<int>(parser.consumedBytes()));
+        parser.reset();
+    }
+    context->protocol = writer.protocol();
+
+    if (context->output.readableBytes() > 0) {
+        conn->send(&context->output);
+    }
+    if (close) {
+        buf->retrieveAll();
+        parser.reset();
+        conn->shutdown();
+    }
+}
@@ -0,0 +1,93 @@
+#include "siren/net/resp/RespWriter.h"
+
+#include <stdio.h>
+
+#include <charconv>
+
+#include "siren/net/Buffer.h"
+
+void siren::net::RespWriter::append(std::string_view s) {
+    output_->append(s.data(), s.size());
+}
+
+void siren::net::RespWriter::header(char type, int64_t n) {
+    // type, at most 20 digits, CRLF
+    char buf[24];
+    buf[0] = type;
+    auto res = std::to_chars(buf + 1, buf + sizeof buf - 2, n);
+    res.ptr[0] = '\r';
+    res.ptr[1] = '\n';
+    output_->append(buf, static_cast<size_t>(res.ptr + 2 - buf));
+}
+
+void siren::net::RespWriter::simpleString(std::string_view s) {
+    output_->ensureWritableBytes(s.size() + 3);
+    append("+");
+    append(s);
+    append("\r\n");
+}
+
+void siren::net::RespWriter::error(std::string_view message) {
+    output_->ensureWritableBytes(message.size() + 3);
+    append("-");
+    append(message);
+    append("\r\n");
+}
+
+void siren::net::RespWriter::integer(int64_t value) { header(':', value); }
+
+void siren::net::RespWriter::bulkString(std::string_view s) {
+    output_->ensureWritableBytes(s.size() + 24 + 2);
+    header('$', static_cast<int64_t>(s.size()));
+    append(s);
+    append("\r\n");
+}
+
+void siren::net::RespWriter::null() {
+    append(protocol_ >= 3 ? std::string_view("_\r\n") : std::string_view("$-1\r\n"));
+}
+
+void siren::net::RespWriter::boolean(bool value) {
+    if (protocol_ >= 3) {
+        append(value ? "#t\r\n" : "#f\r\n");
+    } else {
+        integer(value ? 1 : 0);
+    }
+}
+
+void siren::net::RespWriter::doubleValue(double value) {
+    char buf[32];
+    int n = snprintf(buf, sizeof buf, "%.17g", value);
+    std::string_view text(buf, static_cast<size_t>(n));
+    if (protocol_ >= 3) {
+        append(",");
+        append(text);
+        append("\r\n");
+    } else {
+        bulkString(text);
+    }
+}
+
+void siren::net::RespWriter::arrayHeader(size_t n) { header('*', static_cast<int64_t>(n)); }
+
+void siren::net::RespWriter::mapHeader(size_t n) {
+    if (protocol_ >= 3) {
+        header('%', static_cast<int64_t>(n));
+    } else {
+        header('*', static_cast<int64_t>(n * 2));
+    }
+}
+
+void siren::net::RespWriter::setHeader(size_t n) {
+    header(protocol_ >= 3 ? '~' : '*', static_cast<int64_t>(n));
+}
+
+void siren::net::RespWriter::command(std::initializer_list<std::string_view> args) {
+    size_t total = 24;
+    for (std::string_view arg : args) total += arg.size() + 26;
+    output_->ensureWritableBytes(total);
+    arrayHeader(args.size());
+    for (std::string_view arg : args) {
+        bulkString(arg);
+    }
+}
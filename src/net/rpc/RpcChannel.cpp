@@ -0,0 +1,214 @@
+#include "siren/net/rpc/RpcChannel.h"
+
+#include <sys/uio.h>
+
+#include "siren/base/Logger.h"
+#include "siren/net/Buffer.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/TcpConnection.h"
+
+using namespace siren;
+using namespace siren::net;
+
+void siren::net::RpcResponder::reply(std::string response) const {
+    if (expired()) {
+        LOG_DEBUG("RpcResponder: call {} expired, reply dropped", callId_);
+        return;
+    }
+    if (auto channel = channel_.lock()) {
+        channel->reply(callId_, RpcStatus::kOk, std::move(response));
+    }
+}
+
+void siren::net::RpcResponder::fail(RpcStatus status) const {
+    if (expired()) return;
+    if (auto channel = channel_.lock()) {
+        channel->reply(callId_, status, string());
+    }
+}
+
+bool siren::net::RpcResponder::expired() const {
+    return deadline_ != Deadline::max() && std::chrono::steady_clock::now() > deadline_;
+}
+
+siren::net::RpcChannel::RpcChannel(const TcpConnectionPtr& conn, const RpcMethodMap* methods)
+    : loop_(conn->getLoop()),
+      conn_(conn),
+      methods_(methods),
+      nextCallId_(1),
+      flushQueued_(false) {}
+
+void siren::net::RpcChannel::call(uint32_t methodId, std::string request, RpcCallback done,
+                                  int timeoutMs) {
+    Frame frame;
+    RpcHeader header;
+    header.type = RpcHeader::kRequest;
+    header.length = static_cast<uint32_t>(request.size());
+    header.callId = nextCallId_.fetch_add(1, std::memory_order_relaxed);
+    header.methodId = methodId;
+    header.timeoutMs = static_cast<uint32_t>(std::max(timeoutMs, 0));
+    header.encode(frame.header);
+    frame.payload = std::move(request);
+    frame.done = std::move(done);
+    frame.callId = header.callId;
+    frame.timeoutMs = timeoutMs;
+    enqueue(std::move(frame));
+}
+
+void siren::net::RpcChannel::reply(uint64_t callId, RpcStatus status, std::string response) {
+    Frame frame;
+    RpcHeader header;
+    header.type = RpcHeader::kResponse;
+    header.status = status;
+    header.length = static_cast<uint32_t>(response.size());
+    header.callId = callId;
+    header.encode(frame.header);
+    frame.payload = std::move(response);
+    frame.callId = callId;
+    frame.timeoutMs = 0;
+    enqueue(std::move(frame));
+}
+
+void siren::net::RpcChannel::enqueue(Frame&& frame) {
+    bool needFlush = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(std::move(frame));
+        needFlush = !flushQueued_;
+        flushQueued_ = true;
+    }
+    // queued, not run: a flush in the loop thread goes after the rest of
+    // this iteration's reads, picking up every frame they produce
+    if (needFlush) {
+        loop_->queueInLoop([self = shared_from_this()]() { self->flush(); });
+    }
+}
+
+void siren::net::RpcChannel::flush() {
+    loop_->assertInLoopThread();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sending_.swap(pending_);
+        flushQueued_ = false;
+    }
+
+    TcpConnectionPtr conn = conn_.lock();
+    if (!conn || conn->disconnected()) {
+        for (Frame& frame : sending_) {
+            if (frame.done) frame.done(RpcStatus::kConnectionLost, std::string_view());
+        }
+        sending_.clear();
+        return;
+    }
+
+    size_t copied = 0;
+    for (Frame& frame : sending_) {
+        copied += RpcHeader::kSize;
+        if (frame.payload.size() < kCopyThreshold) copied += frame.payload.size();
+
+        if (frame.done) {
+            Outstanding& call = outstanding_[frame.callId];
+            call.done = std::move(frame.done);
+            call.hasTimer = frame.timeoutMs > 0;
+            if (call.hasTimer) {
+                std::weak_ptr<RpcChannel> weakSelf = shared_from_this();
+                uint64_t callId = frame.callId;
+                call.timer = loop_->runAfter(frame.timeoutMs / 1000.0, [weakSelf, callId]() {
+                    if (auto self = weakSelf.lock()) self->onTimeout(callId);
+                });
+            }
+        }
+    }
+
+    // reserved up front, the iovecs below point into scratch_
+    thread_local std::vector<struct iovec> iov;
+    iov.clear();
+    scratch_.clear();
+    scratch_.reserve(copied);
+    size_t runStart = 0;
+    auto closeRun = [&]() {
+        if (scratch_.size() > runStart) {
+            iov.push_back({scratch_.data() + runStart, scratch_.size() - runStart});
+        }
+        runStart = scratch_.size();
+    };
+    for (Frame& frame : sending_) {
+        scratch_.append(frame.header, RpcHeader::kSize);
+        if (frame.payload.size() < kCopyThreshold) {
+            scratch_.append(frame.payload);
+        } else {
+            closeRun();
+            iov.push_back({frame.payload.data(), frame.payload.size()});
+        }
+    }
+    closeRun();
+
+    conn->sendv(iov.data(), static_cast<int>(iov.size()));
+    sending_.clear();
+}
+
+void siren::net::RpcChannel::onMessage(const TcpConnectionPtr& conn, Buffer* buf) {
+    loop_->assertInLoopThread();
+    while (buf->readableBytes() >= RpcHeader::kSize) {
+        RpcHeader header;
+        if (!header.decode(buf->peek()) || header.length > kMaxPayload) {
+            LOG_ERROR("RpcChannel: bad frame from {}, closing", conn->peerAddress().toIpPort());
+            buf->retrieveAll();
+            conn->forceClose();
+            return;
+        }
+        size_t frameLen = RpcHeader::kSize + header.length;
+        if (buf->readableBytes() < frameLen) {
+            break;
+        }
+
+        std::string_view payload(buf->peek() + RpcHeader::kSize, header.length);
+        if (header.type == RpcHeader::kRequest) {
+            dispatch(header, payload);
+        } else {
+            auto it = outstanding_.find(header.callId);
+            if (it == outstanding_.end()) {
+                LOG_DEBUG("RpcChannel: response to unknown or timed out call {}", header.callId);
+            } else {
+                Outstanding call = std::move(it->second);
+                outstanding_.erase(it);
+                if (call.hasTimer) loop_->cancel(call.timer);
+                call.done(header.status,
+                          header.status == RpcStatus::kOk ? payload : std::string_view());
+            }
+        }
+        // the payload view points into buf, consume it only now
+        buf->retrieve(static_cast<int>(frameLen));
+    }
+}
+
+void siren::net::RpcChannel::dispatch(const RpcHeader& header, std::string_view payload) {
+    RpcMethodMap::const_iterator it;
+    if (methods_ == nullptr || (it = methods_->find(header.methodId)) == methods_->end()) {
+        reply(header.callId, RpcStatus::kNoSuchMethod, string());
+        return;
+    }
+    RpcResponder::Deadline deadline = RpcResponder::Deadline::max();
+    if (header.timeoutMs > 0) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(header.timeoutMs);
+    }
+    it->second(payload, RpcResponder(weak_from_this(), header.callId, deadline));
+}
+
+void siren::net::RpcChannel::onTimeout(uint64_t callId) {
+    auto it = outstanding_.find(callId);
+    if (it == outstanding_.end()) return;
+    RpcCallback done = std::move(it->second.done);
+    outstanding_.erase(it);
+    done(RpcStatus::kTimeout, std::string_view());
+}
+
+void siren::net::RpcChannel::onDisconnected() {
+    loop_->assertInLoopThread();
+    std::unordered_map<uint64_t, Outstanding> calls;
+    calls.swap(outstanding_);
+    for (auto& entry : calls) {
+        if (entry.second.hasTimer) loop_->cancel(entry.second.timer);
+        entry.second.done(RpcStatus::kConnectionLost, std::string_view());
+    }
+}
@@ -0,0 +1,58 @@
+#include "siren/net/rpc/RpcClient.h"
+
+using namespace siren;
+using namespace siren::net;
+
+siren::net::RpcClient::RpcClient(EventLoop* loop, const InetAddress& serverAddr,
+                                 const string& name)
+    : client_(loop, serverAddr, name), connectionCallback_(defaultConnectionCallback) {
+    client_.setConnectionCallback(std::bind(&RpcClient::onConnection, this, _1));
+    client_.setMessageCallback(std::bind(&RpcClient::onMessage, this, _1, _2, _3));
+}
+
+void siren::net::RpcClient::call(uint32_t methodId, std::string request, RpcCallback done,
+                                 int timeoutMs) {
+    RpcChannelPtr channel;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        channel = channel_;
+    }
+    if (!channel) {
+        done(RpcStatus::kConnectionLost, std::string_view());
+        return;
+    }
+    channel->call(methodId, std::move(request), std::move(done), timeoutMs);
+}
+
+bool siren::net::RpcClient::connected() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<bool>(channel_);
+}
+
+void siren::net::RpcClient::onConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        conn->setTcpNoDelay(true);
+        auto channel = std::make_shared<RpcChannel>(conn, nullptr);
+        conn->setContext(channel);
+        std::lock_guard<std::mutex> lock(mutex_);
+        channel_ = std::move(channel);
+    } else {
+        RpcChannelPtr channel;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            channel.swap(channel_);
+        }
+        if (channel) channel->onDisconnected();
+        conn->setContext(std::any());
+    }
+    connectionCallback_(conn);
+}
+
+void siren::net::RpcClient::onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    auto* channel = std::any_cast<RpcChannelPtr>(conn->getMutableContext());
+    if (channel == nullptr) {
+        buf->retrieveAll();
+        return;
+    }
+    (*channel)->onMessage(conn, buf);
+}
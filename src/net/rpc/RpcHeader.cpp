@@ -0,0 +1,64 @@
+#include "siren/net/rpc/RpcHeader.h"
+
+#include <string.h>
+
+#include "siren/net/Endian.h"
+
+using namespace siren;
+using namespace siren::net;
+
+const char* siren::net::rpcStatusToString(RpcStatus status) {
+    switch (status) {
+        case RpcStatus::kOk:
+            return "ok";
+        case RpcStatus::kNoSuchMethod:
+            return "no such method";
+        case RpcStatus::kHandlerError:
+            return "handler error";
+        case RpcStatus::kTimeout:
+            return "timeout";
+        case RpcStatus::kConnectionLost:
+            return "connection lost";
+        default:
+            return "unknown status";
+    }
+}
+
+void siren::net::RpcHeader::encode(char* out) const {
+    uint16_t magic = sockets::hostToNetwork16(kMagic);
+    uint32_t length32 = sockets::hostToNetwork32(length);
+    uint64_t callId64 = sockets::hostToNetwork64(callId);
+    uint32_t methodId32 = sockets::hostToNetwork32(methodId);
+    uint32_t timeout32 = sockets::hostToNetwork32(timeoutMs);
+    memcpy(out, &magic, 2);
+    out[2] = static_cast<char>(type);
+    out[3] = static_cast<char>(status);
+    memcpy(out + 4, &length32, 4);
+    memcpy(out + 8, &callId64, 8);
+    memcpy(out + 16, &methodId32, 4);
+    memcpy(out + 20, &timeout32, 4);
+}
+
+bool siren::net::RpcHeader::decode(const char* in) {
+    uint16_t magic;
+    memcpy(&magic, in, 2);
+    if (sockets::networkToHost16(magic) != kMagic) return false;
+    uint8_t t = static_cast<uint8_t>(in[2]);
+    if (t != kRequest && t != kResponse) return false;
+    type = static_cast<Type>(t);
+    status = static_cast<RpcStatus>(static_cast<uint8_t>(in[3]));
+
+    uint32_t length32;
+    uint64_t callId64;
+    uint32_t methodId32;
+    uint32_t timeout32;
+    memcpy(&length32, in + 4, 4);
+    memcpy(&callId64, in + 8, 8);
+    memcpy(&methodId32, in + 16, 4);
+    memcpy(&timeout32, in + 20, 4);
+    length = sockets::networkToHost32(length32);
+    callId = sockets::networkToHost64(callId64);
+    methodId = sockets::networkToHost32(methodId32);
+    timeoutMs = sockets::networkToHost32(timeout32);
+    return true;
+}
@@ -0,0 +1,47 @@
+#include "siren/net/rpc/RpcServer.h"
+
+#include "siren/base/Logger.h"
+
+using namespace siren;
+using namespace siren::net;
+
+siren::net::RpcServer::RpcServer(EventLoop* loop, const InetAddress& listenAddr,
+                                 const string& name, TcpServer::Option option)
+    : server_(loop, listenAddr, name, option) {
+    server_.setConnectionCallback(std::bind(&RpcServer::onConnection, this, _1));
+    server_.setMessageCallback(std::bind(&RpcServer::onMessage, this, _1, _2, _3));
+}
+
+void siren::net::RpcServer::registerMethod(const string& method, RpcHandler handler) {
+    uint32_t id = rpcMethodId(method);
+    bool inserted = methods_.emplace(id, std::move(handler)).second;
+    if (!inserted) {
+        LOG_ERROR("RpcServer[{}]: method {} collides with a registered one, ignored",
+                  server_.name(), method);
+    }
+}
+
+void siren::net::RpcServer::start() {
+    LOG_INFO("RpcServer[{}] starts listening, {} methods", server_.name(), methods_.size());
+    server_.start();
+}
+
+void siren::net::RpcServer::onConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        conn->setTcpNoDelay(true);
+        conn->setContext(std::make_shared<RpcChannel>(conn, &methods_));
+    } else if (auto* channel = std::any_cast<RpcChannelPtr>(conn->getMutableContext())) {
+        (*channel)->onDisconnected();
+        // responders still held by workers find the channel gone
+        conn->setContext(std::any());
+    }
+}
+
+void siren::net::RpcServer::onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    auto* channel = std::any_cast<RpcChannelPtr>(conn->getMutableContext());
+    if (channel == nullptr) {
+        buf->retrieveAll();
+        return;
+    }
+    (*channel)->onMessage(conn, buf);
+}
@@ -0,0 +1,218 @@
+#include "siren/net/websocket/WebSocketFrame.h"
+
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "siren/net/Buffer.h"
+#include "siren/net/Endian.h"
+
+using namespace siren;
+using namespace siren::net;
+
+void siren::net::websocket::unmask(char* data, size_t len, const uint8_t key[4],
+                                   size_t offset) {
+    // rotate the key so that k[0] applies to data[0]
+    uint8_t k[8];
+    for (int i = 0; i < 8; ++i) k[i] = key[(offset + i) & 3];
+    uint32_t k32;
+    uint64_t k64;
+    memcpy(&k32, k, 4);
+    memcpy(&k64, k, 8);
+
+    // every step is a multiple of 4 bytes, the key stays aligned with i
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i k256 = _mm256_set1_epi32(static_cast<int>(k32));
+    for (; i + 32 <= len; i += 32) {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), k256));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i k128 = _mm_set1_epi32(static_cast<int>(k32));
+    for (; i + 16 <= len; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), k128));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t k128 = vreinterpretq_u8_u32(vdupq_n_u32(k32));
+    for (; i + 16 <= len; i += 16) {
+        uint8_t* p = reinterpret_cast<uint8_t*>(data + i);
+        vst1q_u8(p, veorq_u8(vld1q_u8(p), k128));
+    }
+#endif
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        word ^= k64;
+        memcpy(data + i, &word, 8);
+    }
+    for (; i < len; ++i) {
+        data[i] = static_cast<char>(data[i] ^ k[i & 3]);
+    }
+}
+
+size_t siren::net::websocket::encodeHeader(char* out, Opcode opcode, uint64_t payloadLen,
+                                           bool fin, bool compressed, const uint8_t* mask) {
+    out[0] = static_cast<char>((fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | opcode);
+    const uint8_t maskBit = mask ? 0x80 : 0;
+    size_t n;
+    if (payloadLen < 126) {
+        out[1] = static_cast<char>(maskBit | payloadLen);
+        n = 2;
+    } else if (payloadLen <= 0xFFFF) {
+        out[1] = static_cast<char>(maskBit | 126);
+        uint16_t be16 = sockets::hostToNetwork16(static_cast<uint16_t>(payloadLen));
+        memcpy(out + 2, &be16, 2);
+        n = 4;
+    } else {
+        out[1] = static_cast<char>(maskBit | 127);
+        uint64_t be64 = sockets::hostToNetwork64(payloadLen);
+        memcpy(out + 2, &be64, 8);
+        n = 10;
+    }
+    if (mask) {
+        memcpy(out + n, mask, 4);
+        n += 4;
+    }
+    return n;
+}
+
+void siren::net::websocket::appendFrame(Buffer* output, Opcode opcode,
+                                        std::string_view payload, bool compressed) {
+    char header[kMaxHeaderSize];
+    size_t n = encodeHeader(header, opcode, payload.size(), true, compressed);
+    output->ensureWritableBytes(n + payload.size());
+    output->append(header, n);
+    output->append(payload.data(), payload.size());
+}
+
+void siren::net::websocket::appendMaskedFrame(Buffer* output, Opcode opcode,
+                                              std::string_view payload, const uint8_t mask[4]) {
+    char header[kMaxHeaderSize];
+    size_t n = encodeHeader(header, opcode, payload.size(), true, false, mask);
+    output->ensureWritableBytes(n + payload.size());
+    output->append(header, n);
+    output->append(payload.data(), payload.size());
+    unmask(output->beginWrite() - payload.size(), payload.size(), mask);
+}
+
+void siren::net::websocket::appendCloseFrame(Buffer* output, uint16_t code,
+                                             std::string_view reason) {
+    char payload[125];
+    uint16_t be16 = sockets::hostToNetwork16(code);
+    memcpy(payload, &be16, 2);
+    size_t reasonLen = std::min(reason.size(), sizeof payload - 2);
+    memcpy(payload + 2, reason.data(), reasonLen);
+    appendFrame(output, kClose, std::string_view(payload, 2 + reasonLen));
+}
+
+WebSocketParser::Result siren::net::WebSocketParser::parse(Buffer* buf) {
+    using namespace websocket;
+    char* base = buf->mutablePeek();
+    const size_t avail = buf->readableBytes();
+    while (true) {
+        if (avail < scanned_ + 2) return kNeedMore;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(base + scanned_);
+        const size_t left = avail - scanned_;
+
+        const bool fin = p[0] & 0x80;
+        const bool rsv1 = p[0] & 0x40;
+        const auto opcode = static_cast<Opcode>(p[0] & 0x0F);
+        const bool masked = p[1] & 0x80;
+        if ((p[0] & 0x30) != 0 || masked != server_) return fail(kProtocolError);
+
+        uint64_t len = p[1] & 0x7F;
+        size_t headerLen = 2;
+        if (len == 126) {
+            if (left < 4) return kNeedMore;
+            uint16_t be16;
+            memcpy(&be16, p + 2, 2);
+            len = sockets::networkToHost16(be16);
+            headerLen = 4;
+        } else if (len == 127) {
+            if (left < 10) return kNeedMore;
+            uint64_t be64;
+            memcpy(&be64, p + 2, 8);
+            len = sockets::networkToHost64(be64);
+            headerLen = 10;
+        }
+        if (masked) headerLen += 4;
+
+        const bool control = opcode & 0x8;
+        if (control) {
+            if (opcode != kClose && opcode != kPing && opcode != kPong) {
+                return fail(kProtocolError);
+            }
+            if (!fin || rsv1 || len > 125) return fail(kProtocolError);
+        } else {
+            if (opcode == kContinuation) {
+                if (!inMessage_ || rsv1) return fail(kProtocolError);
+            } else if (opcode == kText || opcode == kBinary) {
+                if (inMessage_ || (rsv1 && !rsv1Allowed_)) return fail(kProtocolError);
+            } else {
+                return fail(kProtocolError);
+            }
+            // refuse before buffering the payload
+            if (len > maxMessageSize_ - assembled_) return fail(kMessageTooBig);
+        }
+        if (left < headerLen || left - headerLen < len) return kNeedMore;
+
+        char* payload = base + scanned_ + headerLen;
+        const size_t frameLen = headerLen + static_cast<size_t>(len);
+        if (masked) {
+            unmask(payload, static_cast<size_t>(len), p + headerLen - 4);
+        }
+
+        if (control) {
+            opcode_ = opcode;
+            message_ = std::string_view(payload, static_cast<size_t>(len));
+            lastWasControl_ = true;
+            // inside a fragmented message nothing can be retrieved yet
+            consumed_ = inMessage_ ? 0 : scanned_ + frameLen;
+            controlEnd_ = scanned_ + frameLen;
+            return kControl;
+        }
+
+        if (!inMessage_) {
+            opcode_ = opcode;
+            messageOpcode_ = opcode;
+            compressed_ = rsv1;
+            if (fin) {
+                message_ = std::string_view(payload, static_cast<size_t>(len));
+                consumed_ = scanned_ + frameLen;
+                return kMessage;
+            }
+            inMessage_ = true;
+        }
+        // close the gap left by the headers seen so far
+        memmove(base + assembled_, payload, static_cast<size_t>(len));
+        assembled_ += static_cast<size_t>(len);
+        scanned_ += frameLen;
+        if (fin) {
+            inMessage_ = false;
+            // a control frame in between has overwritten opcode_
+            opcode_ = messageOpcode_;
+            message_ = std::string_view(base, assembled_);
+            consumed_ = scanned_;
+            return kMessage;
+        }
+    }
+}
+
+void siren::net::WebSocketParser::next() {
+    if (lastWasControl_ && inMessage_) {
+        scanned_ = controlEnd_;
+    } else {
+        assembled_ = 0;
+        scanned_ = 0;
+    }
+    lastWasControl_ = false;
+    message_ = std::string_view();
+    consumed_ = 0;
+}
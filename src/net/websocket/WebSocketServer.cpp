@@ -0,0 +1,556 @@
+#include "siren/net/websocket/WebSocketServer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory>
+#include <mutex>
+
+#ifdef SIREN_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "siren/base/Logger.h"
+#include "siren/net/EventLoop.h"
+#include "siren/net/http/HttpParser.h"
+#include "siren/net/http/HttpRequest.h"
+#include "siren/net/http/HttpResponse.h"
+#include "siren/net/http/HttpServer.h"
+
+using namespace siren;
+using namespace siren::net;
+using namespace siren::net::websocket;
+
+namespace {
+
+// messages shorter than this are not worth a deflate pass
+const size_t kMinDeflateSize = 128;
+
+struct Handshake {
+    HttpParser parser;
+    HttpRequest request;
+};
+
+struct WebSocketContext {
+    explicit WebSocketContext(size_t maxMessageSize)
+        : handshake(std::make_shared<Handshake>()), frames(true, maxMessageSize) {}
+
+    std::shared_ptr<Handshake> handshake;  // dropped after the upgrade
+    WebSocketParser frames;
+    bool upgraded = false;
+    bool deflate = false;  // permessage-deflate negotiated
+    bool closing = false;  // our close frame is out
+};
+
+// replies made while a connection's frames are being handled are
+// gathered here and sent with one write afterwards
+thread_local TcpConnection* t_batchConn = nullptr;
+thread_local Buffer t_batch;
+thread_local Buffer t_scratch;
+
+WebSocketContext* upgradedContext(const TcpConnectionPtr& conn) {
+    auto* context = std::any_cast<WebSocketContext>(conn->getMutableContext());
+    if (context == nullptr || !context->upgraded || context->closing) return nullptr;
+    return context;
+}
+
+// ---- SHA-1 and base64, only for Sec-WebSocket-Accept ----
+
+uint32_t rotl(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+void sha1(const unsigned char* data, size_t len, unsigned char digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    // the key plus the GUID is 60 bytes, two blocks are always enough
+    unsigned char msg[128] = {0};
+    assert(len <= sizeof msg - 9);
+    memcpy(msg, data, len);
+    msg[len] = 0x80;
+    size_t total = len + 9 <= 64 ? 64 : 128;
+    uint64_t bits = static_cast<uint64_t>(len) * 8;
+    for (int i = 0; i < 8; ++i) msg[total - 1 - i] = static_cast<unsigned char>(bits >> (8 * i));
+
+    for (size_t block = 0; block < total; block += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const unsigned char* p = msg + block + 4 * i;
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    for (int i = 0; i < 5; ++i) {
+        digest[4 * i] = static_cast<unsigned char>(h[i] >> 24);
+        digest[4 * i + 1] = static_cast<unsigned char>(h[i] >> 16);
+        digest[4 * i + 2] = static_cast<unsigned char>(h[i] >> 8);
+        digest[4 * i + 3] = static_cast<unsigned char>(h[i]);
+    }
+}
+
+string base64(const unsigned char* data, size_t len) {
+    static const char kTable[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    string out;
+    out.reserve((len + 2) / 3 * 4);
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t n = uint32_t(data[i]) << 16;
+        if (i + 1 < len) n |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < len) n |= data[i + 2];
+        out += kTable[(n >> 18) & 63];
+        out += kTable[(n >> 12) & 63];
+        out += i + 1 < len ? kTable[(n >> 6) & 63] : '=';
+        out += i + 2 < len ? kTable[n & 63] : '=';
+    }
+    return out;
+}
+
+string acceptKey(std::string_view key) {
+    static const char kGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    unsigned char input[96];
+    size_t len = std::min(key.size(), sizeof input - (sizeof kGuid - 1));
+    memcpy(input, key.data(), len);
+    memcpy(input + len, kGuid, sizeof kGuid - 1);
+    unsigned char digest[20];
+    sha1(input, len + sizeof kGuid - 1, digest);
+    return base64(digest, sizeof digest);
+}
+
+// true if the comma separated header value has @c token
+bool hasToken(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        std::string_view item = value.substr(0, comma);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if (detail::equalsIgnoreCase(item, token)) return true;
+        if (comma == std::string_view::npos) break;
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// An offer of permessage-deflate we can take: any parameters but a
+// server window below 15 bits, our per-loop deflater always uses 15.
+bool acceptsDeflate(std::string_view extensions) {
+    while (!extensions.empty()) {
+        size_t comma = extensions.find(',');
+        std::string_view offer = extensions.substr(0, comma);
+        size_t pos = offer.find("permessage-deflate");
+        if (pos != std::string_view::npos) {
+            size_t bits = offer.find("server_max_window_bits");
+            if (bits == std::string_view::npos) return true;
+            size_t eq = offer.find('=', bits);
+            if (eq != std::string_view::npos && atoi(string(offer.substr(eq + 1)).c_str()) >= 15) {
+                return true;
+            }
+        }
+        if (comma == std::string_view::npos) break;
+        extensions.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+#ifdef SIREN_HAVE_ZLIB
+
+// Raw deflate streams, reset per message since context takeover is off
+// both ways. One of each per loop thread.
+class Deflater : noncopyable {
+public:
+    Deflater() {
+        memset(&zs_, 0, sizeof zs_);
+        ::deflateInit2(&zs_, Z_BEST_SPEED, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    }
+    ~Deflater() { ::deflateEnd(&zs_); }
+
+    void compress(std::string_view in, string* out) {
+        ::deflateReset(&zs_);
+        out->resize(::deflateBound(&zs_, in.size()) + 16);
+        zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        zs_.avail_in = static_cast<uInt>(in.size());
+        zs_.next_out = reinterpret_cast<Bytef*>(&(*out)[0]);
+        zs_.avail_out = static_cast<uInt>(out->size());
+        ::deflate(&zs_, Z_SYNC_FLUSH);
+        assert(zs_.avail_in == 0 && zs_.avail_out > 0);
+        out->resize(out->size() - zs_.avail_out);
+        // drop the 00 00 ff ff tail of the sync flush (RFC 7692 7.2.1)
+        if (out->size() >= 4) out->resize(out->size() - 4);
+    }
+
+private:
+    z_stream zs_;
+};
+
+class Inflater : noncopyable {
+public:
+    Inflater() {
+        memset(&zs_, 0, sizeof zs_);
+        ::inflateInit2(&zs_, -15);
+    }
+    ~Inflater() { ::inflateEnd(&zs_); }
+
+    enum Result { kOk, kTooBig, kCorrupt };
+
+    Result decompress(std::string_view in, size_t maxSize, string* out) {
+        static const unsigned char kTail[4] = {0x00, 0x00, 0xff, 0xff};
+        ::inflateReset(&zs_);
+        out->clear();
+        size_t produced = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            zs_.next_in = pass == 0 ? reinterpret_cast<Bytef*>(const_cast<char*>(in.data()))
+                                    : const_cast<Bytef*>(kTail);
+            zs_.avail_in = static_cast<uInt>(pass == 0 ? in.size() : sizeof kTail);
+            while (zs_.avail_in > 0) {
+                if (out->size() - produced < 4096) {
+                    out->resize(std::max<size_t>(out->size() * 2, in.size() * 4 + 4096));
+                }
+                zs_.next_out = reinterpret_cast<Bytef*>(&(*out)[produced]);
+                zs_.avail_out = static_cast<uInt>(out->size() - produced);
+                int ret = ::inflate(&zs_, Z_SYNC_FLUSH);
+                produced = out->size() - zs_.avail_out;
+                if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END) return kCorrupt;
+                if (produced > maxSize) return kTooBig;
+                if (ret == Z_BUF_ERROR && zs_.avail_out > 0) break;
+            }
+        }
+        out->resize(produced);
+        return kOk;
+    }
+
+private:
+    z_stream zs_;
+};
+
+Deflater& loopDeflater() {
+    thread_local Deflater deflater;
+    return deflater;
+}
+
+Inflater& loopInflater() {
+    thread_local Inflater inflater;
+    return inflater;
+}
+
+#endif  // SIREN_HAVE_ZLIB
+
+// header and payload, deflated when negotiated and worth it
+void appendMessage(Buffer* out, std::string_view message, Opcode opcode, bool deflate) {
+#ifdef SIREN_HAVE_ZLIB
+    if (deflate && message.size() >= kMinDeflateSize) {
+        thread_local string compressed;
+        loopDeflater().compress(message, &compressed);
+        appendFrame(out, opcode, compressed, true);
+        return;
+    }
+#else
+    (void)deflate;
+#endif
+    appendFrame(out, opcode, message);
+}
+
+bool sendHandshake(const TcpConnectionPtr& conn, const HttpRequest& request, bool deflate) {
+    std::string_view key = request.getHeader("Sec-WebSocket-Key");
+    if (key.empty() || key.size() > 64) return false;
+    static const char kHead[] =
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: ";
+    Buffer out;
+    out.append(kHead, sizeof kHead - 1);
+    string accept = acceptKey(key);
+    out.append(accept.data(), accept.size());
+    out.append("\r\n", 2);
+    if (deflate) {
+        static const char kExtension[] =
+            "Sec-WebSocket-Extensions: permessage-deflate; "
+            "server_no_context_takeover; client_no_context_takeover\r\n";
+        out.append(kExtension, sizeof kExtension - 1);
+    }
+    out.append("\r\n", 2);
+    conn->send(&out);
+    return true;
+}
+
+void refuse(const TcpConnectionPtr& conn, int status) {
+    HttpResponse response(true);
+    response.setStatusCode(status);
+    if (status == HttpResponse::k426UpgradeRequired) {
+        response.addHeader("Sec-WebSocket-Version", "13");
+    }
+    Buffer out;
+    response.appendToBuffer(&out, HttpServer::cachedDateHeader());
+    conn->send(&out);
+    conn->shutdown();
+}
+
+// the frame of a broadcast, compressed at most once by whichever loop
+// needs it first
+struct SharedFrame {
+    SharedPayload plain;
+    size_t headerLen = 0;
+    Opcode opcode = kText;
+    std::once_flag deflateOnce;
+    SharedPayload deflated;
+};
+
+}  // namespace
+
+siren::net::WebSocketServer::WebSocketServer(EventLoop* loop, const InetAddress& listenAddr,
+                                             const string& name, TcpServer::Option option)
+    : server_(loop, listenAddr, name, option),
+      maxMessageSize_(WebSocketParser::kDefaultMaxMessageSize),
+      deflate_(false) {
+    server_.setConnectionCallback(std::bind(&WebSocketServer::onConnection, this, _1));
+    server_.setMessageCallback(std::bind(&WebSocketServer::onMessage, this, _1, _2, _3));
+}
+
+void siren::net::WebSocketServer::start() {
+#ifndef SIREN_HAVE_ZLIB
+    if (deflate_) {
+        LOG_WARN("WebSocketServer[{}]: built without zlib, permessage-deflate is off",
+                 server_.name());
+        deflate_ = false;
+    }
+#endif
+    LOG_INFO("WebSocketServer[{}] starts listening", server_.name());
+    server_.start();
+}
+
+void siren::net::WebSocketServer::onConnection(const TcpConnectionPtr& conn) {
+    if (conn->connected()) {
+        conn->setContext(WebSocketContext(maxMessageSize_));
+        return;
+    }
+    auto* context = std::any_cast<WebSocketContext>(conn->getMutableContext());
+    if (context != nullptr && context->upgraded && connectionCallback_) {
+        connectionCallback_(conn);
+    }
+    conn->setContext(std::any());
+}
+
+void siren::net::WebSocketServer::onMessage(const TcpConnectionPtr& conn, Buffer* buf,
+                                            Timestamp) {
+    auto* context = std::any_cast<WebSocketContext>(conn->getMutableContext());
+    if (context == nullptr || !conn->connected() || context->closing) {
+        buf->retrieveAll();
+        return;
+    }
+    if (!context->upgraded) {
+        onHandshake(conn, buf);
+        context = std::any_cast<WebSocketContext>(conn->getMutableContext());
+        if (context == nullptr || !context->upgraded || buf->readableBytes() == 0) return;
+    }
+    onFrames(conn, buf);
+}
+
+void siren::net::WebSocketServer::onHandshake(const TcpConnectionPtr& conn, Buffer* buf) {
+    auto* context = std::any_cast<WebSocketContext>(conn->getMutableContext());
+    Handshake& handshake = *context->handshake;
+    HttpParser::Result result = handshake.parser.parse(buf, &handshake.request);
+    if (result == HttpParser::kNeedMore) {
+        return;
+    }
+    if (result == HttpParser::kError) {
+        buf->retrieveAll();
+        refuse(conn, handshake.parser.errorStatus());
+        return;
+    }
+
+    const HttpRequest& request = handshake.request;
+    int status = 0;
+    if (request.method() != HttpRequest::kGet || request.version() != HttpRequest::kHttp11 ||
+        !hasToken(request.getHeader("Upgrade"), "websocket") ||
+        !hasToken(request.getHeader("Connection"), "Upgrade")) {
+        status = HttpResponse::k400BadRequest;
+    } else if (request.getHeader("Sec-WebSocket-Version") != "13") {
+        status = HttpResponse::k426UpgradeRequired;
+    } else if (upgradeCallback_ && !upgradeCallback_(conn, request)) {
+        status = HttpResponse::k403Forbidden;
+    }
+
+    bool deflate = deflate_ && acceptsDeflate(request.getHeader("Sec-WebSocket-Extensions"));
+    if (status == 0 && !sendHandshake(conn, request, deflate)) {
+        status = HttpResponse::k400BadRequest;
+    }
+    if (status != 0) {
+        buf->retrieveAll();
+        refuse(conn, status);
+        return;
+    }
+
+    // frames sent right behind the request stay in buf
+    buf->retrieve(static_cast<int>(handshake.parser.requestBytes()));
+    context->handshake.reset();
+    context->upgraded = true;
+    context->deflate = deflate;
+    context->frames.setRsv1Allowed(deflate);
+    if (connectionCallback_) connectionCallback_(conn);
+}
+
+void siren::net::WebSocketServer::onFrames(const TcpConnectionPtr& conn, Buffer* buf) {
+    auto* context = std::any_cast<WebSocketContext>(conn->getMutableContext());
+    WebSocketParser& frames = context->frames;
+    t_batchConn = conn.get();
+
+    bool close = false;
+    while (!close) {
+        WebSocketParser::Result result = frames.parse(buf);
+        if (result == WebSocketParser::kNeedMore) {
+            break;
+        }
+        if (result == WebSocketParser::kError) {
+            appendCloseFrame(&t_batch, frames.closeCode());
+            close = true;
+            break;
+        }
+
+        if (result == WebSocketParser::kControl) {
+            if (frames.opcode() == kPing) {
+                appendFrame(&t_batch, kPong, frames.message());
+            } else if (frames.opcode() == kClose) {
+                // echo the status code, as RFC 6455 5.5.1 asks
+                std::string_view payload = frames.message().substr(0, 2);
+                appendFrame(&t_batch, kClose, payload);
+                close = true;
+                break;
+            }
+        } else if (!frames.compressed()) {
+            messageCallback_(conn, frames.message(), frames.opcode());
+        } else {
+#ifdef SIREN_HAVE_ZLIB
+            thread_local string inflated;
+            Inflater::Result inflateResult =
+                loopInflater().decompress(frames.message(), maxMessageSize_, &inflated);
+            if (inflateResult != Inflater::kOk) {
+                appendCloseFrame(&t_batch, inflateResult == Inflater::kTooBig ? kMessageTooBig
+                                                                              : kInvalidPayload);
+                close = true;
+                break;
+            }
+            messageCallback_(conn, inflated, frames.opcode());
+#else
+            assert(false);
+#endif
+        }
+        // the message points into buf, consume it only now
+        buf->retrieve(static_cast<int>(frames.consumedBytes()));
+        frames.next();
+        // the callback may have closed the connection
+        context = std::any_cast<WebSocketContext>(conn->getMutableContext());
+        if (context == nullptr || context->closing) break;
+    }
+    t_batchConn = nullptr;
+
+    if (t_batch.readableBytes() > 0) {
+        conn->send(&t_batch);
+    }
+    // close() from the callback only marks the context
+    if (close || (context != nullptr && context->closing)) {
+        if (context != nullptr) context->closing = true;
+        buf->retrieveAll();
+        conn->shutdown();
+    }
+}
+
+void siren::net::WebSocketServer::send(const TcpConnectionPtr& conn, std::string_view message,
+                                       Opcode opcode) {
+    EventLoop* loop = conn->getLoop();
+    if (!loop->isInLoopThread()) {
+        loop->runInLoop([conn, copy = string(message), opcode]() { send(conn, copy, opcode); });
+        return;
+    }
+    WebSocketContext* context = upgradedContext(conn);
+    if (context == nullptr) return;
+    if (conn.get() == t_batchConn) {
+        appendMessage(&t_batch, message, opcode, context->deflate);
+        return;
+    }
+    appendMessage(&t_scratch, message, opcode, context->deflate);
+    conn->send(&t_scratch);
+}
+
+void siren::net::WebSocketServer::close(const TcpConnectionPtr& conn, uint16_t code,
+                                        std::string_view reason) {
+    EventLoop* loop = conn->getLoop();
+    if (!loop->isInLoopThread()) {
+        loop->runInLoop([conn, code, copy = string(reason)]() { close(conn, code, copy); });
+        return;
+    }
+    WebSocketContext* context = upgradedContext(conn);
+    if (context == nullptr) return;
+    context->closing = true;
+    if (conn.get() == t_batchConn) {
+        // onFrames() sends the batch, then shuts down when it sees closing
+        appendCloseFrame(&t_batch, code, reason);
+        return;
+    }
+    appendCloseFrame(&t_scratch, code, reason);
+    conn->send(&t_scratch);
+    conn->shutdown();
+}
+
+void siren::net::WebSocketServer::broadcast(const std::vector<TcpConnectionPtr>& conns,
+                                            std::string_view message, Opcode opcode) {
+    auto frame = std::make_shared<SharedFrame>();
+    char header[kMaxHeaderSize];
+    frame->headerLen = encodeHeader(header, opcode, message.size());
+    string plain;
+    plain.reserve(frame->headerLen + message.size());
+    plain.append(header, frame->headerLen);
+    plain.append(message.data(), message.size());
+    frame->plain = SharedPayload(std::move(plain));
+    frame->opcode = opcode;
+
+    runPerLoop(conns, [frame](const std::vector<TcpConnectionPtr>& targets) {
+        for (const TcpConnectionPtr& conn : targets) {
+            WebSocketContext* context = upgradedContext(conn);
+            if (context == nullptr) continue;
+            const SharedPayload* bytes = &frame->plain;
+#ifdef SIREN_HAVE_ZLIB
+            if (context->deflate && frame->plain.size() - frame->headerLen >= kMinDeflateSize) {
+                std::call_once(frame->deflateOnce, [&frame]() {
+                    string compressed;
+                    loopDeflater().compress(frame->plain.view().substr(frame->headerLen),
+                                            &compressed);
+                    Buffer out;
+                    appendFrame(&out, frame->opcode, compressed, true);
+                    frame->deflated = SharedPayload(out.retrieveAllAsString());
+                });
+                bytes = &frame->deflated;
+            }
+#endif
+            if (conn.get() == t_batchConn) {
+                // keep order with replies batched for this connection
+                t_batch.append(bytes->data(), bytes->size());
+                continue;
+            }
+            conn->send(*bytes);
+        }
+    });
+}